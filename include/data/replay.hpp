@@ -56,11 +56,61 @@ struct ReplayData {
     void key_down(uint32_t key);
     void key_up(uint32_t key);
 };
+
+// read_from() and write_to() use the original format: a 32-bit count of items, then each item as
+// a type byte and a 32-bit wait or 8-bit key.
 void read_from(sfz::ReadSource in, ReplayData& replay);
 void read_from(sfz::ReadSource in, ReplayData::Item& replay);
 void write_to(sfz::WriteTarget out, const ReplayData& replay);
 void write_to(sfz::WriteTarget out, const ReplayData::Item& replay);
 
+// Writes `replay` in the compact format.  Each item is a single varint, holding the wait or key
+// shifted left past the item's type; in practice, nearly all take one byte.  Before the items is
+// an index of keyframes, one per kReplayKeyframeInterval items, giving the offset of the item,
+// the ticks elapsed before it, and the keys held down at that point, so that a reader can start
+// from the middle of the replay.
+void write_compact(sfz::WriteTarget out, const ReplayData& replay);
+
+const size_t kReplayKeyframeInterval = 256;
+
+// Reads the items of a replay one at a time, straight out of its encoded form, in either the
+// original or the compact format.  The data must outlive the reader.
+class ReplayReader {
+  public:
+    explicit ReplayReader(sfz::BytesSlice data);
+
+    int32_t chapter_id() const { return _chapter_id; }
+    int32_t global_seed() const { return _global_seed; }
+
+    // @param [out] item    set to the next item, if there is one.
+    // @returns             true if there was another item.
+    bool next(ReplayData::Item* item);
+
+    // The offset of the next item, which can be saved and later passed back to set_position().
+    size_t position() const { return _items.size() - _rest.size(); }
+    void set_position(size_t position);
+
+    // Moves to the last item boundary at or before `ticks` ticks into the replay, starting from
+    // the nearest keyframe if there is an index.
+    // @param [out] keys_down   set to a mask of the keys held down at that point.
+    // @returns             the number of ticks elapsed at that point.
+    uint32_t seek(uint32_t ticks, uint64_t* keys_down);
+
+  private:
+    struct Keyframe {
+        uint32_t ticks;
+        size_t offset;
+        uint64_t keys_down;
+    };
+
+    bool _compact;
+    int32_t _chapter_id;
+    int32_t _global_seed;
+    std::vector<Keyframe> _index;
+    sfz::BytesSlice _items;     // all of the items.
+    sfz::BytesSlice _rest;      // the items not yet read.
+};
+
 }  // namespace antares
 
 #endif  // ANTARES_DATA_REPLAY_HPP_
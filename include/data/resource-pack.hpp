@@ -0,0 +1,72 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_DATA_RESOURCE_PACK_HPP_
+#define ANTARES_DATA_RESOURCE_PACK_HPP_
+
+#include <stdint.h>
+#include <sfz/sfz.hpp>
+
+namespace antares {
+
+// The name of the pack in each scenario's directory.
+extern const char kResourcePackName[];
+
+// All of a scenario's resources in a single file, so that they can be found with one open() and
+// mmap() rather than a stat() and open() for each.  Paths are looked up ignoring the case of ASCII
+// letters, as they were on HFS+.
+//
+// The file starts with a header: the magic number "ARPK", the format version, and the number of
+// resources.  Then comes the index, with one entry per resource, sorted by path: the offset and
+// length of its path in the string table, and the offset and size of its data.  Then the string
+// table, holding each path as UTF-8, with ASCII letters in lower case.  Each resource's data starts on a page boundary, so it can be
+// used straight from the mapping.  All numbers are big-endian uint32_ts.
+class ResourcePack {
+  public:
+    explicit ResourcePack(const sfz::StringSlice& path);
+
+    // @returns             true if `path` holds a pack in the format this version writes.  Packs
+    //                      written by older versions sit alongside the loose files they hold.
+    static bool is_current(const sfz::StringSlice& path);
+
+    // Looks up a resource by its path, relative to the scenario's directory.
+    // @param [out] data    set to the resource's data, if found.
+    // @returns             true if the pack has the resource.
+    bool find(const sfz::StringSlice& resource_path, sfz::BytesSlice* data) const;
+
+    // @returns             the number of resources in the pack.
+    size_t size() const { return _count; }
+
+  private:
+    sfz::MappedFile _file;
+    uint32_t _count;
+    const uint8_t* _index;
+    sfz::BytesSlice _strings;
+
+    DISALLOW_COPY_AND_ASSIGN(ResourcePack);
+};
+
+// Packs every file under `dir` into a ResourcePack at `dir/kResourcePackName`, replacing any pack
+// that is already there, and then removes the files it packed.  The `replays` and `scenario-info`
+// directories are left as they are, since their files are found by globbing the directory.
+void write_resource_pack(const sfz::StringSlice& dir);
+
+}  // namespace antares
+
+#endif  // ANTARES_DATA_RESOURCE_PACK_HPP_
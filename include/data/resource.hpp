@@ -36,7 +36,8 @@ class Resource {
   private:
     void init(const sfz::StringSlice& resource_path);
 
-    sfz::scoped_ptr<sfz::MappedFile> _file;
+    sfz::scoped_ptr<sfz::MappedFile> _file;  // set if the resource is a loose file.
+    sfz::BytesSlice _data;
 };
 
 }  // namespace antares
@@ -22,11 +22,11 @@
 
 #include <stdint.h>
 
+#include "drawing/pix-map.hpp"
+
 namespace antares {
 
 class ColorTable;
-class PixMap;
-class Rect;
 
 // these defs are here for historic reason:
 const int32_t kLeftPanelWidth       = 128;
@@ -35,7 +35,9 @@ const int32_t kPanelHeight          = 480;
 
 const int32_t kSmallScreenWidth     = 640;
 
-extern PixMap* gRealWorld;
+// The instrument panels, and anything else drawn in software.  Only the parts which have changed
+// since the last frame need to be sent to the video driver again.
+extern TrackedPixMap* gRealWorld;
 extern PixMap* gOffWorld;
 
 void CreateOffscreenWorld();
@@ -20,6 +20,7 @@
 #ifndef ANTARES_DRAWING_PIX_MAP_HPP_
 #define ANTARES_DRAWING_PIX_MAP_HPP_
 
+#include <vector>
 #include <sfz/sfz.hpp>
 
 #include "drawing/color.hpp"
@@ -85,6 +86,14 @@ class PixMap {
     // @returns             a mutable pointer to the first pixel in row `y`.
     virtual RgbColor* mutable_row(int y);
 
+    // Like `mutable_bytes()`, for callers which only change the pixels within `bounds`.  PixMaps
+    // which keep track of changes, such as TrackedPixMap, need only consider those pixels changed.
+    //
+    // @param [in] bounds   the region to be changed.  Must be enclosed by
+    // `Rect(Point(0, 0), this->size())`.
+    // @returns             a mutable pointer to the pixel at the top-left corner of `bounds`.
+    virtual RgbColor* mutable_region(const Rect& bounds);
+
     // @param [in] x        a column.  Must be in the range [0, size().width).
     // @param [in] y        a row.  Must be in the range [0, size().height).
     // @returns             the pixel at location (x, y).
@@ -95,6 +104,14 @@ class PixMap {
     // @param [in] color    the color to set the pixel at location (x, y) to.
     virtual void set(int x, int y, const RgbColor& color);
 
+    // Sets several pixels to a single color.  The region which they span is only looked up once,
+    // so this is cheaper than calling `set()` for each.
+    //
+    // @param [in] points   the pixels to set.  Each must be within `size()`.
+    // @param [in] count    the number of pixels in `points`.
+    // @param [in] color    the color to set the pixels to.
+    void set_points(const Point* points, size_t count, const RgbColor& color);
+
     // Fills the entirety of the PixMap with a single color.
     //
     // Note the absence of a `Rect` parameter as part of `fill()`: this is intentional.  If you
@@ -139,6 +156,10 @@ class PixMap {
 // Serializes a PixMap to a WriteTarget.
 void write_to(sfz::WriteTarget out, const PixMap& image);
 
+// Encodes `size.width * size.height` contiguous pixels, each four bytes in R, G, B, A order, as a
+// PNG.  The result is the same as write_to() gives for a PixMap of the same pixels.
+void write_rgba_png(sfz::WriteTarget out, const Size& size, const uint8_t* rgba);
+
 // PixMap subclass which provides its own storage.
 //
 // Implements the PixMap interface in terms of an array of pixel data stored in memory.  In
@@ -192,6 +213,35 @@ void read_from(sfz::ReadSource out, ArrayPixMap& image);
 
 inline void swap(ArrayPixMap& x, ArrayPixMap& y) { x.swap(y); }
 
+// ArrayPixMap subclass which keeps track of which of its pixels have changed.
+//
+// The PixMap is divided into square tiles, and a tile is marked as changed when any pixel within
+// it might have been.  Writes through `mutable_region()`, `set()`, and views mark only the tiles
+// they cover; anything which takes `mutable_bytes()` or `mutable_row()` could write anywhere, so
+// it marks the whole PixMap.
+class TrackedPixMap : public ArrayPixMap {
+  public:
+    // Creates a new TrackedPixMap, with all of its pixels marked as changed.
+    TrackedPixMap(int32_t width, int32_t height);
+
+    virtual RgbColor* mutable_bytes();
+    virtual RgbColor* mutable_region(const Rect& bounds);
+
+    // Appends to `changes` a set of rects covering every pixel which has changed since the last
+    // call, and then marks all pixels as unchanged.
+    void take_changes(std::vector<Rect>* changes);
+
+  private:
+    // Marks the tiles covering `bounds` as changed.
+    void mark(const Rect& bounds);
+
+    // The number of tiles in each row and column.
+    const Size _tiles;
+    sfz::scoped_array<bool> _changed;
+
+    DISALLOW_COPY_AND_ASSIGN(TrackedPixMap);
+};
+
 // A clipped view of another PixMap.
 //
 // This class is lightweight, since it does not store any of its own pixel or color data.  It is
@@ -213,7 +263,10 @@ class PixMap::View : public PixMap {
 
     virtual RgbColor* mutable_bytes();
 
-    // Uses default implementations of all utility PixMap methods.
+    // Passes `bounds` on to the parent, so that it knows which of its pixels may change.
+    virtual RgbColor* mutable_region(const Rect& bounds);
+
+    // Uses default implementations of all other utility PixMap methods.
 
   private:
     // The PixMap that this is a view of.
@@ -29,17 +29,65 @@ namespace antares {
 
 class Sprite;
 
+// The frames of an SMIV resource, decoded once and shared by every coloring of it.  Each pixel is
+// an index into the color table, as in the resource.
+class IndexedPixTable {
+  public:
+    struct Frame {
+        uint16_t width;
+        uint16_t height;
+        int16_t h_offset;
+        int16_t v_offset;
+        size_t offset;          // of the first pixel in `pixels()`.
+
+        // When colorized, only pixels with some bit of `color_mask` set are recolored.  Sprites
+        // which are mostly in the 'white' band of the color table (0x01..0x0F) are recolored
+        // entirely; others keep their white pixels.
+        uint8_t color_mask;
+    };
+
+    explicit IndexedPixTable(int id);
+    ~IndexedPixTable();
+
+    int id() const { return _id; }
+    const Frame& at(size_t index) const { return _frames[index]; }
+    size_t size() const { return _frames.size(); }
+    const uint8_t* pixels(const Frame& frame) const { return _pixels.data() + frame.offset; }
+
+  private:
+    const int _id;
+    std::vector<Frame> _frames;
+    sfz::Bytes _pixels;
+
+    DISALLOW_COPY_AND_ASSIGN(IndexedPixTable);
+};
+
 class NatePixTable {
   public:
     class Frame;
 
+    // Reads, colors, and makes sprites for the SMIV `id`.
     NatePixTable(int id, uint8_t color);
+
+    // Makes a table from frames already decoded for another coloring of the same SMIV.  The
+    // table is empty until build() and create_sprites() are called.  build() touches nothing but
+    // the table itself, so tables can be built on several threads at once; create_sprites() calls
+    // the video driver, so must be called on the main thread.
+    NatePixTable(const sfz::linked_ptr<const IndexedPixTable>& indexed, uint8_t color);
+
     ~NatePixTable();
 
+    void build();
+    void create_sprites();
+
     const Frame& at(size_t index) const;
     size_t size() const;
 
+    const sfz::linked_ptr<const IndexedPixTable>& indexed() const { return _indexed; }
+
   private:
+    sfz::linked_ptr<const IndexedPixTable> _indexed;
+    const uint8_t _color;
     size_t _size;
     sfz::scoped_array<Frame> _entries;
 
@@ -57,12 +105,10 @@ class NatePixTable::Frame {
     const PixMap& pix_map() const;
     const Sprite& sprite() const;
 
-    void build(sfz::BytesSlice in, int32_t id, int32_t frame_number, uint8_t color);
+    void build(const IndexedPixTable& indexed, int32_t frame_number, const RgbColor* palette);
+    void create_sprite(int32_t id, int32_t frame_number);
 
   private:
-    void fill_pix_map(sfz::BytesSlice bytes);
-    void colorize_pix_map(sfz::BytesSlice bytes, uint8_t color);
-
     uint16_t _width;
     uint16_t _height;
     int16_t _h_offset;
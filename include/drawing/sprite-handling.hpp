@@ -20,6 +20,8 @@
 #ifndef ANTARES_DRAWING_SPRITE_HANDLING_HPP_
 #define ANTARES_DRAWING_SPRITE_HANDLING_HPP_
 
+#include <vector>
+
 #include "drawing/color.hpp"
 #include "drawing/pix-table.hpp"
 #include "drawing/shapes.hpp"
@@ -97,6 +99,10 @@ int32_t evil_scale_by(int32_t value, int32_t scale);
 
 void SpriteHandlingInit();
 void ResetAllSprites();
+
+// Save and restore the sprite table as part of a Snapshot.
+void SaveSprites(sfz::Bytes* out);
+void RestoreSprites(sfz::BytesSlice* in);
 void scale_pix_map(const PixMap& source, PixMap* dest);
 void OptScaleSpritePixInPixMap(
         const NatePixTable::Frame& frame, Point where, int32_t scale, Rect *draw_rect,
@@ -113,11 +119,17 @@ void SetAllPixTablesNoKeep();
 void KeepPixTable(int16_t resource_id);
 void RemoveAllUnusedPixTables();
 NatePixTable* AddPixTable(int16_t resource_id);
+// Adds each of the tables in `resource_ids`, as AddPixTable() does, but decodes them on several
+// threads at once.
+void AddPixTables(const std::vector<int16_t>& resource_ids);
 NatePixTable* GetPixTable(int16_t resource_id);
 spriteType *AddSprite(
         Point where, NatePixTable* table, short resID, short whichShape, int32_t scale, long size,
         short layer, const RgbColor& color, long *whichSprite);
 void RemoveSprite(spriteType *);
+// Moves `sprite` to `layer`.  Use this rather than setting `whichLayer` directly, so that
+// draw_sprites() knows where to find it.
+void SetSpriteLayer(spriteType* sprite, short layer);
 void draw_sprites();
 void CullSprites();
 
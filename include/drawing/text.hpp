@@ -42,13 +42,12 @@ class directTextType {
     ~directTextType();
 
     uint8_t char_width(sfz::Rune mchar) const;
+    uint8_t mac_roman_width(uint8_t ch) const { return _widths[ch]; }
 
     void draw(
             Point origin, sfz::StringSlice string, RgbColor color, PixMap* pix,
             const Rect& clip) const;
 
-    void draw_sprite(Point origin, sfz::StringSlice string, RgbColor color) const;
-
     int16_t resID;
     int32_t logicalWidth;
     int32_t physicalWidth;
@@ -56,8 +55,12 @@ class directTextType {
     int32_t ascent;
 
   private:
+    void draw_glyphs(
+            Point origin, const uint8_t* text, size_t size, RgbColor color, PixMap* pix,
+            const Rect& clip) const;
+
     sfz::Bytes charSet;
-    sfz::scoped_array<sfz::scoped_ptr<Sprite> > _sprites;
+    uint8_t _widths[256];
 
     DISALLOW_COPY_AND_ASSIGN(directTextType);
 };
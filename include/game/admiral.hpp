@@ -126,6 +126,10 @@ void AdmiralCleanup();
 void ResetAllAdmirals();
 void ResetAllDestObjectData();
 
+// Save and restore the admirals and destinations as part of a Snapshot.
+void SaveAdmirals(sfz::Bytes* out);
+void RestoreAdmirals(sfz::BytesSlice* in);
+
 destBalanceType* mGetDestObjectBalancePtr(long whichObject);
 admiralType* mGetAdmiralPtr(long mwhichAdmiral);
 
@@ -21,6 +21,7 @@
 #define ANTARES_GAME_BEAM_HPP_
 
 #include <stdint.h>
+#include <sfz/sfz.hpp>
 
 #include "drawing/shapes.hpp"
 #include "math/geometry.hpp"
@@ -72,6 +73,10 @@ struct beamType {
 
 void InitBeams();
 void ResetBeams();
+
+// Save and restore the beam table as part of a Snapshot.
+void SaveBeams(sfz::Bytes* out);
+void RestoreBeams(sfz::BytesSlice* in);
 beamType* AddBeam(
         coordPointType* location, uint8_t color, beamKindType kind, int32_t accuracy,
         int32_t beam_range, int32_t* whichBeam);
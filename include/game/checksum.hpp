@@ -0,0 +1,117 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_GAME_CHECKSUM_HPP_
+#define ANTARES_GAME_CHECKSUM_HPP_
+
+#include <stdint.h>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+namespace antares {
+
+// The parts of the state of the simulation which are checksummed separately, so that when two
+// runs diverge, it's clear where to start looking.
+enum ChecksumField {
+    CHECKSUM_LOCATION,          // location, direction, and identity of each space object
+    CHECKSUM_VELOCITY,          // velocity, thrust, and turning of each space object
+    CHECKSUM_HEALTH,            // health, energy, and battery of each space object
+    CHECKSUM_RANDOM,            // gRandomSeed, and each space object's seed
+    CHECKSUM_ACTIONS,           // pending delayed actions
+
+    CHECKSUM_FIELD_COUNT,
+};
+
+const char* checksum_field_name(ChecksumField field);
+
+// Checksums of the state of the simulation at the end of one decide cycle.
+struct StateChecksum {
+    int64_t game_time;
+    uint32_t fields[CHECKSUM_FIELD_COUNT];
+
+    bool operator==(const StateChecksum& other) const;
+    bool operator!=(const StateChecksum& other) const { return !(*this == other); }
+};
+
+void read_from(sfz::ReadSource in, StateChecksum& checksum);
+void write_to(sfz::WriteTarget out, const StateChecksum& checksum);
+
+// Accumulates a 32-bit FNV-1a hash of a sequence of values.  If given a dump, it also appends one
+// line per value to it, naming the value, so that dumps from two runs can be compared line by line
+// to find the first value which differs.
+class StateHash {
+  public:
+    explicit StateHash(sfz::String* dump = NULL);
+
+    // Adds `value`, which is field `field` of entry `index` of table `table`.
+    void add(const char* table, int32_t index, const char* field, int64_t value);
+
+    uint32_t value() const { return _value; }
+
+  private:
+    uint32_t _value;
+    sfz::String* const _dump;
+
+    DISALLOW_COPY_AND_ASSIGN(StateHash);
+};
+
+// Computes the checksums of the current state of the simulation.  If `dump` is not NULL, each
+// checksummed value is described in it.
+void ComputeChecksum(StateChecksum* checksum, sfz::String* dump = NULL);
+
+// Writes the checksums of the simulation to a file, once per decide cycle.
+//
+// While a log is set with `set_log()`, GamePlay calls `record()` at the end of each decide cycle.
+// The checksums are written as a sequence of StateChecksums; they are buffered, and flushed when
+// the log is destroyed.  If `schedule_dump()` has been called, the values which went into the
+// checksums are also written out in full, as text, at the first decide cycle at or after the
+// requested time.
+class ChecksumLog {
+  public:
+    explicit ChecksumLog(const sfz::StringSlice& path);
+    ~ChecksumLog();
+
+    static ChecksumLog* log();
+    static void set_log(ChecksumLog* log);
+
+    void record();
+
+    // Asks for the state to be dumped to `path` at game time `at`.
+    void schedule_dump(int64_t at, const sfz::StringSlice& path);
+
+  private:
+    void flush();
+
+    static ChecksumLog* _log;
+
+    sfz::ScopedFd _fd;
+    sfz::Bytes _buffer;
+    bool _dump_scheduled;
+    int64_t _dump_at;
+    sfz::String _dump_path;
+
+    DISALLOW_COPY_AND_ASSIGN(ChecksumLog);
+};
+
+// Reads a file written by ChecksumLog.
+void ReadChecksums(sfz::BytesSlice in, std::vector<StateChecksum>* checksums);
+
+}  // namespace antares
+
+#endif  // ANTARES_GAME_CHECKSUM_HPP_
@@ -0,0 +1,68 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_GAME_FREE_SLOTS_HPP_
+#define ANTARES_GAME_FREE_SLOTS_HPP_
+
+#include <stdint.h>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+namespace antares {
+
+// The set of free slots in a fixed-capacity table.
+//
+// Tables such as gSpaceObjectData have always handed out the lowest-numbered free slot, and the
+// slot an object lands in decides where it goes in the object list, so the choice affects play
+// and must not change.  Rather than scanning the table for it, this keeps one bit per slot, plus
+// one bit per 64 slots saying whether any of them is free, so finding the lowest free slot looks
+// at a word or two instead of every entry.
+class FreeSlots {
+  public:
+    FreeSlots();
+
+    // Sets the number of slots to `capacity`, and marks them all free.
+    void reset(int32_t capacity);
+
+    int32_t capacity() const { return _capacity; }
+
+    // @returns             the lowest-numbered free slot, or -1 if there are none.
+    int32_t first() const;
+
+    // Marks `slot` as in use.
+    void acquire(int32_t slot);
+
+    // Marks `slot` as free.
+    void release(int32_t slot);
+
+    // Saves and restores the set as part of a Snapshot.
+    void save(sfz::Bytes* out) const;
+    void restore(sfz::BytesSlice* in);
+
+  private:
+    int32_t _capacity;
+    std::vector<uint64_t> _words;
+    std::vector<uint64_t> _summary;
+
+    DISALLOW_COPY_AND_ASSIGN(FreeSlots);
+};
+
+}  // namespace antares
+
+#endif  // ANTARES_GAME_FREE_SLOTS_HPP_
@@ -80,7 +80,6 @@ struct admiralType;
 struct beamType;
 struct destBalanceType;
 struct longMessageType;
-struct proximityUnitType;
 struct screenLabelType;
 struct scrollStarType;
 class InputSource;
@@ -102,6 +101,7 @@ struct aresGlobalType {
     long            gGameOver;
     sfz::scoped_array<admiralType>       gAdmiralData;
     long            gGameTime;
+    int32_t         gScenarioCheckTime;     // decide cycles since conditions were last checked
     uint64_t        gLastTime;
     long            gClosestObject;
     long            gFarthestObject;
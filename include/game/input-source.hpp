@@ -24,16 +24,20 @@
 #include <sfz/sfz.hpp>
 
 #include "config/keys.hpp"
+#include "data/replay.hpp"
 
 namespace antares {
 
-class ReplayData;
-
 class InputSource {
   public:
     virtual ~InputSource();
 
     virtual bool next(KeyMap& key_map) = 0;
+
+    // Save and restore the position in the input as part of a Snapshot.  Sources which can't be
+    // wound back, like the player, have nothing to save.
+    virtual void save(sfz::Bytes* out) const;
+    virtual void restore(sfz::BytesSlice* in);
 };
 
 class UserInputSource : public InputSource {
@@ -46,17 +50,20 @@ class UserInputSource : public InputSource {
     DISALLOW_COPY_AND_ASSIGN(UserInputSource);
 };
 
+// Plays back a replay, decoding its items as they are needed.
 class ReplayInputSource : public InputSource {
   public:
-    explicit ReplayInputSource(ReplayData* data);
+    explicit ReplayInputSource(const ReplayReader& replay);
 
     virtual bool next(KeyMap& key_map);
 
+    virtual void save(sfz::Bytes* out) const;
+    virtual void restore(sfz::BytesSlice* in);
+
   private:
     bool advance();
 
-    const ReplayData* _data;
-    size_t _data_index;
+    ReplayReader _replay;
     uint32_t _wait_ticks;
     KeyMap _key_map;
 
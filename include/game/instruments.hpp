@@ -28,6 +28,7 @@ namespace antares {
 const int32_t kMiniBuildTimeHeight = 25;
 
 void InstrumentInit();
+void UpdateScale(int32_t);
 void UpdateRadar(int32_t);
 void UpdateMoney();
 void InstrumentCleanup();
@@ -26,6 +26,8 @@
 
 namespace antares {
 
+class Sprite;
+
 const int32_t kNoLabel = -1;
 const int32_t kLabelOffVisibleTime = 60;
 
@@ -51,7 +53,19 @@ struct screenLabelType {
     Point               attachedToWhere;
     int32_t             retroCount;
 
+    // The label as last drawn by draw_labels().  The background's dither depends on whether the
+    // label sits on an odd or even pixel, so there is one sprite for each.  When the text, color
+    // or teletype progress changes, `dirty` is set, and the sprites are redrawn in place.  They
+    // are also redrawn when the background is clipped differently (`backgroundSize`), and are
+    // replaced only when the label's size changes.
+    sfz::scoped_ptr<Sprite> sprites[2];
+    bool                spriteCurrent[2];
+    Size                spriteSize;
+    Size                backgroundSize;
+    bool                dirty;
+
     screenLabelType();
+    ~screenLabelType();
 };
 
 void zero(screenLabelType& label);
@@ -36,9 +36,16 @@ enum GameResult {
 Card* AresInit();
 void Pause();
 
+// Plays `scenario`, storing the outcome in `game_result`.
+//
+// If `simulate_only` is true, the game only does the work needed to advance the simulation: the
+// starfield, radar, labels, sector lines and other purely visual state are never updated, and
+// nothing is copied to gRealWorld.  The zoom scale is still kept up, since new objects' distances
+// from the player depend on it.  This is for running replays headlessly, as fast as possible;
+// replays still stay in sync, but the screen is not meaningful.
 class MainPlay : public Card {
   public:
-    MainPlay(const Scenario* scenario, bool replay, GameResult* game_result);
+    MainPlay(const Scenario* scenario, bool replay, bool simulate_only, GameResult* game_result);
 
     virtual void become_front();
 
@@ -53,6 +60,7 @@ class MainPlay : public Card {
 
     const Scenario* _scenario;
     const bool _replay;
+    const bool _simulate_only;
     bool _cancelled;
     GameResult* _game_result;
 };
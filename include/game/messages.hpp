@@ -111,7 +111,9 @@ void EndLongMessage( void);
 void AdvanceCurrentLongMessage( void);
 void PreviousCurrentLongMessage( void);
 void ReplayLastLongMessage( void);
-void DrawMessageScreen(int32_t by_units);
+// Drops the short message at the front of the queue once it has been shown for long enough.
+void AdvanceMessageQueue(int32_t by_units);
+void DrawMessageScreen();
 void SetStatusString(const sfz::StringSlice& status, unsigned char color);
 long DetermineDirectTextHeightInWidth( retroTextSpecType *, long);
 void DrawRetroTextCharInRect( retroTextSpecType *, long, const Rect&, const Rect&, PixMap *);
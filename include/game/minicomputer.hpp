@@ -58,6 +58,10 @@ struct miniScreenLineType {
 
 void MiniScreenInit( void);
 void MiniScreenCleanup( void);
+
+// Save and restore the minicomputer as part of a Snapshot.
+void SaveMiniComputer(sfz::Bytes* out);
+void RestoreMiniComputer(sfz::BytesSlice* in);
 void SetMiniScreenStatusStrList( short);
 void DisposeMiniScreenStatusStrList( void);
 void ClearMiniScreenLines( void);
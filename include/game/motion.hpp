@@ -24,19 +24,6 @@
 
 namespace antares {
 
-const int32_t kUnitsToCheckNumber = 5;
-
-struct adjacentUnitType {
-    long                    adjacentUnit;           // the normal adjacent unit
-    Point                   superOffset;            // the offset of the super unit (for wrap-around)
-};
-
-struct proximityUnitType {
-    spaceObjectTypePtr      nearObject;                         // for collision checking
-    spaceObjectTypePtr      farObject;                          // for distance checking
-    adjacentUnitType        unitsToCheck[kUnitsToCheckNumber];  // adjacent units to check
-};
-
 extern coordPointType gGlobalCorner;
 
 void InitMotion( void);
@@ -27,6 +27,10 @@ namespace antares {
 class InputSource;
 
 void ResetPlayerShip( long);
+
+// Save and restore the player's controls as part of a Snapshot.
+void SavePlayerShip(sfz::Bytes* out);
+void RestorePlayerShip(sfz::BytesSlice* in);
 bool PlayerShipGetKeys(int32_t timePass, InputSource& input_source, bool *enterMessage);
 void PlayerShipHandleClick( Point);
 void SetPlayerSelectShip( long, bool, long);
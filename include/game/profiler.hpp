@@ -0,0 +1,105 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_GAME_PROFILER_HPP_
+#define ANTARES_GAME_PROFILER_HPP_
+
+#include <stdint.h>
+#include <sfz/sfz.hpp>
+
+namespace antares {
+
+// The phases of GamePlay which are timed by the profiler.
+enum ProfilePhase {
+    PROFILE_STARFIELD,
+    PROFILE_MOVE,
+    PROFILE_NONPLAYER_THINK,
+    PROFILE_ADMIRAL_THINK,
+    PROFILE_ACTION_QUEUE,
+    PROFILE_PLAYER_KEYS,
+    PROFILE_COLLIDE,
+    PROFILE_SCENARIO,
+    PROFILE_UPDATE,             // preparing sprites, labels, radar, etc. after moving
+    PROFILE_DRAW,               // GamePlay::draw()
+
+    PROFILE_PHASE_COUNT,
+};
+
+// Records how long each phase of GamePlay takes, in nanoseconds, for each decide cycle.
+//
+// Profiling is compiled in, but off until `set_enabled(true)`; while it is off, a ProfileScope
+// costs one test of a global.  The most recent `kProfileCycleCount` cycles are kept in a ring
+// buffer, and totals are kept for all cycles since the profiler was last reset.
+//
+// PROFILE_UPDATE and PROFILE_DRAW run once per frame, after the cycles of that frame have ended,
+// so they are charged to the most recently ended cycle.  That cycle is recorded when the next
+// one ends, or when the profile is written.
+class Profiler {
+  public:
+    static const int kProfileCycleCount = 8192;
+
+    static bool enabled() { return _enabled; }
+    static void set_enabled(bool enabled);
+
+    // Forgets all recorded cycles.
+    static void reset();
+
+    // Adds `nsecs` to `phase` in the current cycle, or in the last ended cycle for the
+    // per-frame phases.
+    static void add(ProfilePhase phase, int64_t nsecs);
+
+    // Ends the current cycle, which ended at game time `game_time`.
+    static void end_cycle(int64_t game_time);
+
+    // Writes one CSV row per recorded cycle, with one column per phase.
+    static void write_csv(const sfz::StringSlice& path);
+
+    // Writes the total time in each phase in the "folded stacks" format read by flamegraph.pl.
+    static void write_folded(const sfz::StringSlice& path);
+
+    // @returns             a monotonic time in nanoseconds.
+    static int64_t now_nsecs();
+
+  private:
+    static bool _enabled;
+};
+
+// Adds the time between its construction and destruction to a phase of the profiler.
+class ProfileScope {
+  public:
+    explicit ProfileScope(ProfilePhase phase)
+            : _phase(phase),
+              _start(Profiler::enabled() ? Profiler::now_nsecs() : -1) { }
+
+    ~ProfileScope() {
+        if (_start >= 0) {
+            Profiler::add(_phase, Profiler::now_nsecs() - _start);
+        }
+    }
+
+  private:
+    const ProfilePhase _phase;
+    const int64_t _start;
+
+    DISALLOW_COPY_AND_ASSIGN(ProfileScope);
+};
+
+}  // namespace antares
+
+#endif  // ANTARES_GAME_PROFILER_HPP_
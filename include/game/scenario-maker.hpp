@@ -47,8 +47,15 @@ int32_t mGetRealAdmiralNum(int32_t mplayernum);
 
 void ScenarioMakerInit();
 bool ConstructScenario(const Scenario* scenario);
+
+// @returns             how long the last successful ConstructScenario() took, in nanoseconds.
+int64_t ScenarioLoadNsecs();
 void DeclareWinner(int32_t whichPlayer, int32_t nextLevel, int32_t textID);
 void CheckScenarioConditions(int32_t timePass);
+
+// Save and restore the current scenario's initial objects and conditions as part of a Snapshot.
+void SaveScenarioState(sfz::Bytes* out);
+void RestoreScenarioState(sfz::BytesSlice* in);
 int32_t GetRealAdmiralNumber(int32_t whichAdmiral);
 void UnhideInitialObject(int32_t whichInitial);
 spaceObjectType *GetObjectFromInitialNumber(int32_t initialNumber);
@@ -0,0 +1,167 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_GAME_SNAPSHOT_HPP_
+#define ANTARES_GAME_SNAPSHOT_HPP_
+
+#include <stdint.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+namespace antares {
+
+// The complete state of the simulation, as of the end of a decide cycle.
+//
+// Restoring a snapshot puts the simulation back exactly as it was, so that carrying on from there
+// gives the same results as it did the first time.  Presentation state--labels, messages, sounds,
+// the starfield, the radar--is not included; it catches up within a few frames.
+//
+// A snapshot is a flat image of the simulation's tables, pointers and all, so it is only valid in
+// the process which took it, and only until the scenario is torn down.
+class Snapshot {
+  public:
+    Snapshot();
+
+    // Captures the current state of the simulation.
+    void save();
+
+    // Puts the simulation back into the captured state.
+    void restore() const;
+
+    // @returns             the image of the simulation's state.
+    const sfz::Bytes& data() const { return _data; }
+    sfz::Bytes& data() { return _data; }
+
+  private:
+    sfz::Bytes _data;
+
+    DISALLOW_COPY_AND_ASSIGN(Snapshot);
+};
+
+// A history of snapshots, so that the simulation can be wound back to an earlier time.
+//
+// A snapshot is recorded every `interval` ticks.  One in every `keyframe_interval` is kept whole;
+// the rest are kept as the difference from the one before, XORed and with runs of zeroes
+// compressed, which is a small fraction of the size since most of the state doesn't change from
+// one second to the next.  When more than `capacity` snapshots are kept, the oldest keyframe and
+// the deltas which depend on it are dropped.
+//
+// While a ring is set with `set_ring()`, GamePlay records into it at the end of each decide cycle,
+// and carries out seeks requested with `schedule_seek()`.
+class SnapshotRing {
+  public:
+    SnapshotRing(int32_t interval, int32_t keyframe_interval, size_t capacity);
+
+    static SnapshotRing* ring();
+    static void set_ring(SnapshotRing* ring);
+
+    // Records a snapshot, if at least `interval` ticks have passed since the last one.
+    void record();
+
+    // Restores the latest snapshot taken at or before `game_time`, and discards any later ones.
+    // @returns             true if there was such a snapshot.
+    bool restore(int64_t game_time);
+
+    // Asks for the game to be wound back to `to` once it reaches `at`.
+    void schedule_seek(int64_t at, int64_t to);
+
+    // @param [out] to      set to the time to seek to, if a seek is due.
+    // @returns             true if a seek scheduled with `schedule_seek()` is due.
+    bool take_seek(int64_t* to);
+
+    // @returns             the number of snapshots kept.
+    size_t size() const { return _entries.size(); }
+
+    // @returns             the number of bytes used by the snapshots kept.
+    size_t bytes() const { return _bytes; }
+
+  private:
+    struct Entry {
+        int64_t game_time;
+        bool keyframe;
+        sfz::linked_ptr<sfz::Bytes> data;
+    };
+
+    void drop_oldest();
+
+    static SnapshotRing* _ring;
+
+    const int32_t _interval;
+    const int32_t _keyframe_interval;
+    const size_t _capacity;
+    std::deque<Entry> _entries;
+    size_t _bytes;
+    int32_t _since_keyframe;
+    Snapshot _last;             // the state as of the last entry, which deltas are taken from.
+    Snapshot _scratch;
+
+    bool _seek_scheduled;
+    int64_t _seek_at;
+    int64_t _seek_to;
+
+    DISALLOW_COPY_AND_ASSIGN(SnapshotRing);
+};
+
+// Appends the bytes of `count` objects at `data` to a snapshot image.
+template <typename T>
+void save_raw(sfz::Bytes* out, const T* data, size_t count = 1) {
+    out->push(sfz::BytesSlice(reinterpret_cast<const uint8_t*>(data), sizeof(T) * count));
+}
+
+// Reads back `count` objects saved with save_raw() into `data`.
+template <typename T>
+void restore_raw(sfz::BytesSlice* in, T* data, size_t count = 1) {
+    const size_t size = sizeof(T) * count;
+    if (in->size() < size) {
+        throw sfz::Exception("snapshot is truncated");
+    }
+    memcpy(reinterpret_cast<void*>(data), in->data(), size);
+    in->shift(size);
+}
+
+// Appends the size and contents of `vector` to a snapshot image.
+template <typename T>
+void save_vector(sfz::Bytes* out, const std::vector<T>& vector) {
+    const uint32_t size = vector.size();
+    save_raw(out, &size);
+    if (size > 0) {
+        save_raw(out, &vector[0], size);
+    }
+}
+
+// Reads back a vector saved with save_vector() into `vector`.
+template <typename T>
+void restore_vector(sfz::BytesSlice* in, std::vector<T>* vector) {
+    uint32_t size;
+    restore_raw(in, &size);
+    vector->resize(size);
+    if (size > 0) {
+        restore_raw(in, &(*vector)[0], size);
+    }
+}
+
+// Appends the length and runes of `string` to a snapshot image, and reads them back.
+void save_string(sfz::Bytes* out, const sfz::StringSlice& string);
+void restore_string(sfz::BytesSlice* in, sfz::String* string);
+
+}  // namespace antares
+
+#endif  // ANTARES_GAME_SNAPSHOT_HPP_
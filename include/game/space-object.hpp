@@ -24,9 +24,18 @@
 
 namespace antares {
 
+class StateHash;
+
 const int16_t kBaseObjectResID      = 500;
 const int16_t kObjectActionResID    = 500;
 
+// The largest value gMaxSpaceObject may take.  Some loops over objects count in a short.
+const int32_t kSpaceObjectLimit     = 16384;
+
+// The number of entries in gSpaceObjectData.  Defaults to kMaxSpaceObject; may be raised, up to
+// kSpaceObjectLimit, before SpaceObjectHandlingInit() to allow larger battles, at the cost of sync
+// with replays which ran out of objects.
+extern int32_t gMaxSpaceObject;
 extern spaceObjectType* gRootObject;
 extern long gRootObjectNumber;
 extern sfz::scoped_array<spaceObjectType> gSpaceObjectData;
@@ -37,9 +46,24 @@ void SpaceObjectHandlingInit( void);
 void CleanupSpaceObjectHandling( void);
 void ResetAllSpaceObjects( void);
 void ResetActionQueueData( void);
+
+// The original game had room for only 120 pending delayed actions, and dropped any more.  Replays
+// recorded by it depend on that, so it can be turned back on for them; it is off by default.
+// DroppedActionCount() is the number dropped since the action queue was last reset.
+void SetLegacyActionQueueLimit(bool enabled);
+int64_t DroppedActionCount();
+
+// Save and restore the object table and the action queue as part of a Snapshot.
+void SaveSpaceObjects(sfz::Bytes* out);
+void RestoreSpaceObjects(sfz::BytesSlice* in);
+
+// Adds the pending delayed actions, in the order they will fire, to a checksum of the state.
+void HashActionQueue(StateHash* hash);
+
 int AddSpaceObject( spaceObjectType *);
 //int AddSpaceObject( spaceObjectType *, long *, short, short);
 int AddNumberedSpaceObject( spaceObjectType *, long);
+void ReleaseSpaceObjectSlot( spaceObjectType *);
 void RemoveAllSpaceObjects( void);
 void CorrectAllBaseObjectColor( void);
 void InitSpaceObjectFromBaseObject( spaceObjectType *, long, short, long, fixedPointType *, long,
@@ -0,0 +1,111 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_GAME_SPATIAL_HASH_HPP_
+#define ANTARES_GAME_SPATIAL_HASH_HPP_
+
+#include <stdint.h>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "math/geometry.hpp"
+
+namespace antares {
+
+// A uniform spatial hash of object indices, rebuilt once per cycle.
+//
+// The universe is divided into square cells `1 << unit_shift` units wide.  Cells are hashed into
+// a wrapping grid of `1 << size_shift` by `1 << size_shift` buckets, so that cells which are a
+// multiple of the grid size apart share a bucket; the exact cell of each entry is kept alongside
+// it so that such aliases can be rejected cheaply.
+//
+// Entries are added with `add()`, and then `sort()` counting-sorts them by bucket into a single
+// flat array.  Buckets are visited in row-major order, and entries within a bucket are in the
+// reverse of the order they were added.  With `unit_shift` and `size_shift` as used by
+// CollideSpaceObjects(), this is exactly the order of the linked-list proximity grid it
+// replaced, so pairs are considered in the same order and replays stay in sync.
+class SpatialHash {
+  public:
+    // The number of neighbors considered for each cell, including the cell itself.  Only half of
+    // the surrounding cells are neighbors, so that each pair of adjacent cells is considered once.
+    static const int kNeighborCount = 5;
+
+    struct Entry {
+        Point cell;
+        int32_t index;
+    };
+
+    SpatialHash(int unit_shift, int size_shift);
+
+    // Removes all entries.
+    void clear();
+
+    // Adds `index` in the cell containing (h, v).  Entries are not visible until `sort()`.
+    void add(int32_t index, uint32_t h, uint32_t v);
+
+    // Sorts the entries added since `clear()` into their buckets.
+    void sort();
+
+    int32_t bucket_count() const { return _bucket_count; }
+
+    // @returns             the first entry in bucket `bucket`.
+    const Entry* begin(int32_t bucket) const { return &_sorted[0] + _starts[bucket]; }
+
+    // @returns             one past the last entry in bucket `bucket`.
+    const Entry* end(int32_t bucket) const { return &_sorted[0] + _starts[bucket + 1]; }
+
+    // @param [in] bucket   a bucket.
+    // @param [in] k        a neighbor number, in the range [0, kNeighborCount).
+    // @returns             the bucket which holds neighbor `k` of the cells in `bucket`.
+    int32_t neighbor_bucket(int32_t bucket, int k) const {
+        return _neighbors[(bucket * kNeighborCount) + k];
+    }
+
+    // @param [in] cell     a cell.
+    // @param [in] k        a neighbor number, in the range [0, kNeighborCount).
+    // @returns             neighbor `k` of `cell`.  Neighbor 0 is `cell` itself.
+    static Point neighbor_cell(const Point& cell, int k);
+
+    // @returns             the cell containing (h, v).
+    Point cell(uint32_t h, uint32_t v) const;
+
+    // @returns             the cell, divided by the grid size.  This identifies which of the
+    //                      cells hashed into a given bucket contains a given point.
+    Point super_cell(const Point& cell) const;
+
+  private:
+    int32_t bucket(const Point& cell) const;
+
+    const int _unit_shift;
+    const int _size_shift;
+    const int32_t _mask;
+    const int32_t _bucket_count;
+
+    std::vector<int32_t> _neighbors;
+    std::vector<Entry> _entries;
+    std::vector<int32_t> _buckets;
+    std::vector<Entry> _sorted;
+    std::vector<int32_t> _starts;
+
+    DISALLOW_COPY_AND_ASSIGN(SpatialHash);
+};
+
+}  // namespace antares
+
+#endif  // ANTARES_GAME_SPATIAL_HASH_HPP_
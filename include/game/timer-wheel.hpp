@@ -0,0 +1,96 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_GAME_TIMER_WHEEL_HPP_
+#define ANTARES_GAME_TIMER_WHEEL_HPP_
+
+#include <stdint.h>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+namespace antares {
+
+// A hierarchical timer wheel of indices, keyed on absolute time.
+//
+// Each level has `kSlotCount` slots, and each slot at level `L` covers `kSlotCount` to the `L`th
+// power ticks.  An entry is filed at the level of the highest group of bits in which its due time
+// differs from the current time, so adding is constant-time; as time advances past the start of a
+// slot, the entries in it are re-filed into the levels below.  No entry is touched more than once
+// per level, and nothing is done for idle slots except to check whether they are empty.
+//
+// Entries due at the same tick come out of `advance()` in the reverse of the order they were
+// added.  This is the order of the sorted list which the action queue used to keep, and so it is
+// needed for replays to stay in sync.
+class TimerWheel {
+  public:
+    TimerWheel();
+
+    // Removes all entries and sets the time back to zero.
+    void clear();
+
+    // Removes all entries and sets the time to `now`.
+    void reset(int64_t now);
+
+    // @returns             the current time.
+    int64_t now() const { return _now; }
+
+    // @returns             the number of entries waiting.
+    size_t size() const { return _size; }
+
+    // Adds `index`, to be returned from `advance()` once the time reaches `due`.  If `due` has
+    // already passed, it is returned from the next call to `advance()`.
+    void add(int32_t index, int64_t due);
+
+    // Advances the time to `now`, and appends the entries which have come due to `fired`, in order
+    // of due time.  Entries due at the same time are in the reverse of the order they were added.
+    void advance(int64_t now, std::vector<int32_t>* fired);
+
+    // Appends the waiting entries to `indices`, and their due times to `due`, in the order that
+    // `advance()` would return them.  Adding them back in the reverse of that order, after
+    // `reset()`, leaves the wheel as it was.
+    void list(std::vector<int32_t>* indices, std::vector<int64_t>* due) const;
+
+  private:
+    static const int kSlotBits = 6;
+    static const int kSlotCount = 1 << kSlotBits;
+    static const int kLevelCount = (64 + kSlotBits - 1) / kSlotBits;
+
+    struct Entry {
+        int64_t due;
+        int64_t sequence;
+        int32_t index;
+    };
+    static bool fires_before(const Entry& x, const Entry& y);
+
+    void file(const Entry& entry);
+    void cascade(int level);
+
+    int64_t _now;
+    int64_t _sequence;
+    size_t _size;
+    std::vector<Entry> _slots[kLevelCount][kSlotCount];
+    std::vector<Entry> _late;
+    std::vector<Entry> _due;
+
+    DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+}  // namespace antares
+
+#endif  // ANTARES_GAME_TIMER_WHEEL_HPP_
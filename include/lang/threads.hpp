@@ -0,0 +1,48 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_LANG_THREADS_HPP_
+#define ANTARES_LANG_THREADS_HPP_
+
+#include <pthread.h>
+#include <sfz/sfz.hpp>
+
+namespace antares {
+
+// Holds `mutex` locked for as long as it is in scope.
+class MutexLock {
+  public:
+    explicit MutexLock(pthread_mutex_t* mutex): _mutex(mutex) { pthread_mutex_lock(_mutex); }
+    ~MutexLock() { pthread_mutex_unlock(_mutex); }
+
+  private:
+    pthread_mutex_t* const _mutex;
+
+    DISALLOW_COPY_AND_ASSIGN(MutexLock);
+};
+
+// Calls `fn(arg, i)` for each `i` in [0, count), on up to one thread per processor, and returns
+// once all of the calls have.  If any call throws, the rest are abandoned, and the first exception
+// is thrown again on the calling thread: std::bad_alloc as itself, and anything else as an
+// sfz::Exception with the same message.
+void ParallelFor(size_t count, void (*fn)(void* arg, size_t index), void* arg);
+
+}  // namespace antares
+
+#endif  // ANTARES_LANG_THREADS_HPP_
@@ -74,6 +74,10 @@ inline Fixed mDivideFixed(Fixed m_f1, Fixed m_f2) {
     return (m_f1 << 8) / m_f2;
 }
 
+// Sets `out[i]` to `mMultiplyFixed(a[i], b[i])` for each `i` in [0, count).  Gives exactly the
+// results of the scalar version, overflow included.  `out` may be `a` or `b`.
+void MultiplyFixedBatch(const Fixed* a, const Fixed* b, Fixed* out, size_t count);
+
 struct fixedPointType {
     Fixed               h;
     Fixed               v;
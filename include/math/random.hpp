@@ -29,6 +29,10 @@ extern int32_t gRandomSeed;
 int RandomInit();
 void RandomCleanup();
 
+// The seed behind Random(), for saving and restoring it as part of a Snapshot.
+int32_t GetRandomGlobalSeed();
+void SetRandomGlobalSeed(int32_t seed);
+
 int32_t Random();
 
 int Randomize(int range);
@@ -20,6 +20,7 @@
 #ifndef ANTARES_MATH_ROTATION_HPP_
 #define ANTARES_MATH_ROTATION_HPP_
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace antares {
@@ -67,6 +68,16 @@ void RotationInit();
 void GetRotPoint(int32_t *x, int32_t *y, int32_t rotpos);
 int32_t GetAngleFromVector(int32_t x, int32_t y);
 
+// Batch versions of the above.  Each sets the outputs at `i` to the results of the scalar
+// function for the inputs at `i`, for each `i` in [0, count), and gives exactly the results it
+// would.
+void GetRotPointBatch(const int32_t* rotpos, int32_t* x, int32_t* y, size_t count);
+void GetAngleFromVectorBatch(const int32_t* x, const int32_t* y, int32_t* out, size_t count);
+
+// The table of rotation points read by RotationInit(): the h and v of each of the ROT_POS angles.
+const int kRotTableSize = ROT_POS * 2;
+extern int32_t gRotTable[kRotTableSize];
+
 }  // namespace antares
 
 #endif // ANTARES_MATH_ROTATION_HPP_
@@ -0,0 +1,81 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_MATH_SIMD_HPP_
+#define ANTARES_MATH_SIMD_HPP_
+
+// Helpers for the batch math kernels.  SSE2 is the most that can be assumed of an x86 build, so
+// where SSE2 lacks an operation on 32-bit lanes--multiplication, absolute value, unsigned
+// comparison--it is made up here out of what SSE2 has.  Each matches the scalar operation on
+// int32_t exactly, wrapping on overflow as the scalar code does in practice.
+//
+// ANTARES_SIMD_SSE2 is defined when the helpers are available; otherwise, the batch kernels fall
+// back to calling the scalar ones.
+
+#if defined(__SSE2__)
+#define ANTARES_SIMD_SSE2 1
+#endif
+
+#ifdef ANTARES_SIMD_SSE2
+
+#include <emmintrin.h>
+#include <stdint.h>
+
+namespace antares {
+
+// The low 32 bits of each product, which are the same whether the lanes are signed or not.
+inline __m128i simd_mullo_epi32(__m128i a, __m128i b) {
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(
+            _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// As `if (x < 0) x = -x;`: INT32_MIN is left as it is.
+inline __m128i simd_abs_epi32(__m128i x) {
+    const __m128i sign = _mm_srai_epi32(x, 31);
+    return _mm_sub_epi32(_mm_xor_si128(x, sign), sign);
+}
+
+// `a < b`, comparing the lanes as unsigned.
+inline __m128i simd_cmplt_epu32(__m128i a, __m128i b) {
+    const __m128i bias = _mm_set1_epi32(static_cast<int32_t>(0x80000000u));
+    return _mm_cmplt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+// `mask ? a : b`, where each lane of `mask` is all ones or all zeroes.
+inline __m128i simd_select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Loads or stores four 32-bit lanes, which need not be aligned.
+inline __m128i simd_load(const void* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void simd_store(void* p, __m128i x) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), x);
+}
+
+}  // namespace antares
+
+#endif  // ANTARES_SIMD_SSE2
+
+#endif  // ANTARES_MATH_SIMD_HPP_
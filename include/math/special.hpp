@@ -38,6 +38,14 @@ inline void MyWideMul(int32_t mlong1, int32_t mlong2, T* mwide) {
 
 int32_t AngleFromSlope(Fixed slope);
 
+// Batch versions of the above.  Each sets `out[i]` to the result of the scalar function for the
+// inputs at `i`, for each `i` in [0, count), and gives exactly the results it would.  The one
+// exception is MyFixRatio(-32768, -1), where the scalar version's division overflows and traps;
+// the batch version gives 0x80000000.
+void lsqrt_batch(const uint32_t* n, uint32_t* out, size_t count);
+void MyFixRatioBatch(const int16_t* numer, const int16_t* denom, Fixed* out, size_t count);
+void AngleFromSlopeBatch(const Fixed* slope, int32_t* out, size_t count);
+
 }  // namespace antares
 
 #endif // ANTARES_MATH_SPECIAL_HPP_
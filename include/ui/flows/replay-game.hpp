@@ -47,7 +47,7 @@ class ReplayGame : public Card {
     State _state;
 
     Resource _resource;
-    ReplayData _data;
+    const ReplayReader _replay;
     int32_t _random_seed;
     const Scenario* _scenario;
     GameResult _game_result;
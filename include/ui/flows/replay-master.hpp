@@ -0,0 +1,60 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_UI_FLOWS_REPLAY_MASTER_HPP_
+#define ANTARES_UI_FLOWS_REPLAY_MASTER_HPP_
+
+#include <sfz/sfz.hpp>
+
+#include "data/replay.hpp"
+#include "game/main.hpp"
+#include "ui/card.hpp"
+
+namespace antares {
+
+// Plays a replay from start to finish, outside of the usual Master flow.  Initializes the global
+// game state itself, so it must be the first card on the stack, and there may be only one per
+// process.  The preferences, and the video, sound and ledger drivers, must already be set.  The
+// replay is decoded as it plays, so `data` must outlive the card.
+class ReplayMaster : public Card {
+  public:
+    ReplayMaster(sfz::BytesSlice data, bool simulate_only, GameResult* game_result);
+
+    virtual void become_front();
+
+  private:
+    void init();
+
+    enum State {
+        NEW,
+        REPLAY,
+    };
+    State _state;
+
+    const ReplayReader _replay;
+    const int32_t _random_seed;
+    const bool _simulate_only;
+    GameResult* const _game_result;
+
+    DISALLOW_COPY_AND_ASSIGN(ReplayMaster);
+};
+
+}  // namespace antares
+
+#endif  // ANTARES_UI_FLOWS_REPLAY_MASTER_HPP_
@@ -59,6 +59,12 @@ class VideoDriver {
     virtual int64_t double_click_interval_usecs() = 0;
 
     virtual Sprite* new_sprite(sfz::PrintItem name, const PixMap& content) = 0;
+    // Like new_sprite(), for small images which are drawn often and kept for a long time, such as
+    // the frames of sprite tables.  Drivers may pack these into shared textures.
+    virtual Sprite* new_packed_sprite(sfz::PrintItem name, const PixMap& content) = 0;
+    // Like new_packed_sprite(), for images which are never destroyed.  They are packed apart from
+    // the others, so that they don't keep space from being reused when a level's sprites are freed.
+    virtual Sprite* new_persistent_sprite(sfz::PrintItem name, const PixMap& content) = 0;
     virtual void fill_rect(const Rect& rect, const RgbColor& color) = 0;
     virtual void draw_point(const Point& at, const RgbColor& color) = 0;
     virtual void draw_line(const Point& from, const Point& to, const RgbColor& color) = 0;
@@ -70,6 +76,14 @@ class VideoDriver {
     virtual void apply_stencil() = 0;
     virtual void end_stencil() = 0;
 
+    // Points and lines given to `batch_point()` and `batch_line()` between `begin_batch()` and
+    // `end_batch()` are drawn as by `draw_point()` and `draw_line()`, in order, but drivers may
+    // queue them up and draw them together.  Nothing else may be drawn until the batch ends.
+    virtual void begin_batch() = 0;
+    virtual void batch_point(const Point& at, const RgbColor& color) = 0;
+    virtual void batch_line(const Point& from, const Point& to, const RgbColor& color) = 0;
+    virtual void end_batch() = 0;
+
     // Event loop interface.  Should eventually be its own class.
     virtual void loop(Card* initial) = 0;
 
@@ -91,6 +105,25 @@ class Stencil {
     DISALLOW_COPY_AND_ASSIGN(Stencil);
 };
 
+// Draws a batch of points and lines, which is ended when the PrimitiveBatch is destroyed.
+class PrimitiveBatch {
+  public:
+    PrimitiveBatch(VideoDriver* driver);
+    ~PrimitiveBatch();
+
+    void draw_point(const Point& at, const RgbColor& color) {
+        _driver->batch_point(at, color);
+    }
+    void draw_line(const Point& from, const Point& to, const RgbColor& color) {
+        _driver->batch_line(from, to, color);
+    }
+
+  private:
+    VideoDriver* _driver;
+
+    DISALLOW_COPY_AND_ASSIGN(PrimitiveBatch);
+};
+
 class Sprite {
   public:
     virtual ~Sprite();
@@ -98,6 +131,10 @@ class Sprite {
     virtual void draw(int32_t x, int32_t y) const = 0;
     virtual void draw(const Rect& draw_rect) const = 0;
     virtual const Size& size() const = 0;
+
+    // Replaces the pixels within `bounds` with those of `image`, which must be the same size as
+    // the sprite.  This is cheaper than making a new sprite when only a small part has changed.
+    virtual void update(const PixMap& image, const Rect& bounds) = 0;
 };
 
 }  // namespace antares
@@ -0,0 +1,71 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_VIDEO_FRAME_STREAM_HPP_
+#define ANTARES_VIDEO_FRAME_STREAM_HPP_
+
+#include <stdint.h>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "drawing/pix-map.hpp"
+#include "math/geometry.hpp"
+
+namespace antares {
+
+// Writes frames one after another as a single uncompressed video stream, which an encoder like
+// ffmpeg can read straight from a file or pipe.
+//
+// In Y4M format, the stream starts with a YUV4MPEG2 header giving the size and frame rate, and
+// each frame is converted to 4:2:0 Y'CbCr (BT.601, studio range), which is what encoders
+// generally want as input.  In RGBA format, there is no header: each frame is just its pixels,
+// four bytes each, in R, G, B, A order, so the reader must be told the size and rate itself
+// (e.g. `ffmpeg -f rawvideo -pix_fmt rgba -s 640x480 -r 60 -i -`).
+class FrameStream {
+  public:
+    enum Format {
+        Y4M,
+        RGBA,
+    };
+
+    // @param [in] path     a file to write to, or "-" for standard output.
+    // @param [in] frames_per_second_num, frames_per_second_den
+    //                      the frame rate, as a fraction, for the Y4M header.
+    FrameStream(
+            const sfz::StringSlice& path, Format stream_format, const Size& size,
+            int frames_per_second_num, int frames_per_second_den);
+
+    // Appends `pix` to the stream.  It must have the size given to the constructor.
+    void write(const PixMap& pix);
+
+  private:
+    void write_y4m(const PixMap& pix);
+    void write_rgba(const PixMap& pix);
+
+    sfz::ScopedFd _fd;
+    const Format _format;
+    const Size _size;
+    std::vector<uint8_t> _frame;
+
+    DISALLOW_COPY_AND_ASSIGN(FrameStream);
+};
+
+}  // namespace antares
+
+#endif  // ANTARES_VIDEO_FRAME_STREAM_HPP_
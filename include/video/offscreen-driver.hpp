@@ -29,11 +29,13 @@
 #include "ui/card.hpp"
 #include "ui/event-tracker.hpp"
 #include "ui/event.hpp"
-#include "video/opengl-driver.hpp"
+#include "video/frame-stream.hpp"
+#include "video/png-writer.hpp"
+#include "video/software-driver.hpp"
 
 namespace antares {
 
-class OffscreenVideoDriver : public OpenGlVideoDriver {
+class OffscreenVideoDriver : public SoftwareVideoDriver {
   public:
     OffscreenVideoDriver(Size screen_size, const sfz::Optional<sfz::String>& output_dir);
 
@@ -52,20 +54,23 @@ class OffscreenVideoDriver : public OpenGlVideoDriver {
     virtual void loop(Card* initial);
 
     void schedule_snapshot(int64_t at);
+
+    // Also writes each snapshot to `stream`, which the driver takes ownership of.  This works with
+    // or without an output directory for PNG files.
+    void set_frame_stream(FrameStream* stream);
     void schedule_event(sfz::linked_ptr<Event> event);
     void schedule_key(int32_t key, int64_t down, int64_t up);
     void schedule_mouse(int button, const Point& where, int64_t down, int64_t up);
 
   private:
-    class SnapshotBuffer;
-    friend void write_to(const sfz::WriteTarget& out, const SnapshotBuffer& buffer);
-
-    void advance_tick_count(MainLoop* loop, const SnapshotBuffer& buffer, int64_t ticks);
+    void advance_tick_count(MainLoop* loop, int64_t ticks);
     bool have_snapshots_before(int64_t ticks) const;
 
     int _demo;
     const sfz::Optional<sfz::String> _output_dir;
     int64_t _ticks;
+    sfz::scoped_ptr<PngWriter> _png_writer;
+    sfz::scoped_ptr<FrameStream> _frame_stream;
 
     EventTracker _event_tracker;
 
@@ -21,12 +21,14 @@
 #define ANTARES_VIDEO_OPEN_GL_DRIVER_HPP_
 
 #include <stdint.h>
+#include <vector>
 #include <sfz/sfz.hpp>
 
 #include "drawing/color.hpp"
 #include "math/geometry.hpp"
 #include "ui/card.hpp"
 #include "video/driver.hpp"
+#include "video/texture-atlas.hpp"
 
 namespace antares {
 
@@ -35,12 +37,15 @@ class Event;
 class OpenGlVideoDriver : public VideoDriver {
   public:
     OpenGlVideoDriver(Size screen_size);
+    virtual ~OpenGlVideoDriver();
 
     virtual void set_game_state(GameState state);
     virtual int get_demo_scenario();
     virtual void main_loop_iteration_complete(uint32_t game_time);
 
     virtual Sprite* new_sprite(sfz::PrintItem name, const PixMap& content);
+    virtual Sprite* new_packed_sprite(sfz::PrintItem name, const PixMap& content);
+    virtual Sprite* new_persistent_sprite(sfz::PrintItem name, const PixMap& content);
     virtual void fill_rect(const Rect& rect, const RgbColor& color);
     virtual void draw_point(const Point& at, const RgbColor& color);
     virtual void draw_line(const Point& from, const Point& to, const RgbColor& color);
@@ -52,10 +57,16 @@ class OpenGlVideoDriver : public VideoDriver {
     virtual void apply_stencil();
     virtual void end_stencil();
 
+    virtual void begin_batch();
+    virtual void batch_point(const Point& at, const RgbColor& color);
+    virtual void batch_line(const Point& from, const Point& to, const RgbColor& color);
+    virtual void end_batch();
+
   protected:
     class MainLoop {
       public:
-        MainLoop(const OpenGlVideoDriver& driver, Card* initial);
+        MainLoop(OpenGlVideoDriver& driver, Card* initial);
+        ~MainLoop();
         bool done();
         void draw();
         Card* top() const;
@@ -65,7 +76,7 @@ class OpenGlVideoDriver : public VideoDriver {
             Setup();
         };
         const Setup _setup;
-        const OpenGlVideoDriver& _driver;
+        OpenGlVideoDriver& _driver;
         CardStack _stack;
 
         DISALLOW_COPY_AND_ASSIGN(MainLoop);
@@ -74,6 +85,28 @@ class OpenGlVideoDriver : public VideoDriver {
     Size screen_size() const { return _screen_size; }
 
   private:
+    class OpenGlSprite;
+
+    // Copies `content` into `_atlas`, or into a sprite of its own if it is too large to share.
+    Sprite* pack_sprite(sfz::PrintItem name, const PixMap& content, bool persistent);
+
+    // Deletes the textures of `_atlas`.  They belong to the GL context, so this is done before the
+    // main loop's context goes away, as well as when the driver is destroyed.
+    void delete_atlas_textures();
+
+    // Queues a quad which draws `source`, in texels of `texture`, to `dest`.  Consecutive quads
+    // from the same texture are drawn together by `flush()`.
+    void batch_quad(uint32_t texture, const Rect& source, const Rect& dest);
+
+    // Queues a vertex at (x, y) of an untextured shape drawn in `mode`.  Consecutive vertices with
+    // the same mode are drawn together by `flush()`.
+    void batch_vertex(uint32_t mode, float x, float y, const RgbColor& color);
+
+    // Draws any queued quads and shapes.  This must be done before anything else is drawn, before
+    // any change to the GL state that they depend on, and before any texture is modified or
+    // deleted.
+    void flush();
+
     // Clamps all bytes in the stencil buffer to [0, _stencil_height].  This is done whenever a
     // transition is made from drawing the stencil buffer to drawing pixels, so that if another
     // stenciling operation is pushed, incrementing bytes in the stencil buffer is guaranteed to
@@ -82,6 +115,17 @@ class OpenGlVideoDriver : public VideoDriver {
 
     const Size _screen_size;
 
+    // Textures for sprites from `new_packed_sprite()`, one per page of `_atlas`.
+    TextureAtlas _atlas;
+    std::vector<uint32_t> _atlas_textures;
+
+    uint32_t _batch_texture;
+    std::vector<float> _batch;
+
+    uint32_t _shape_mode;
+    std::vector<float> _shape_vertices;
+    std::vector<uint8_t> _shape_colors;
+
     double _transition_fraction;
     RgbColor _transition_color;
 
@@ -0,0 +1,89 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_VIDEO_PNG_WRITER_HPP_
+#define ANTARES_VIDEO_PNG_WRITER_HPP_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "drawing/pix-map.hpp"
+
+namespace antares {
+
+// Encodes PixMaps as PNG files on background threads.
+//
+// `write()` copies the PixMap into a buffer from a fixed pool, converting it to RGBA as it goes,
+// and queues it; so taking a screenshot costs the main thread only that copy, unless every buffer
+// is still waiting to be encoded, in which case it blocks until one is free.  A background thread
+// takes everything queued at once, and encodes it with ParallelFor().  Errors on the background
+// threads are thrown from the next call to `write()` or `finish()`.
+class PngWriter {
+  public:
+    // @param [in] buffers  the number of frames which may be copied but not yet written.
+    explicit PngWriter(int buffers);
+    ~PngWriter();
+
+    // Queues `pix` to be written to `path`.
+    void write(const sfz::StringSlice& path, const PixMap& pix);
+
+    // Waits until everything queued has been written.
+    void finish();
+
+  private:
+    struct Frame {
+        sfz::String path;
+        Size size;
+        std::vector<uint8_t> rgba;
+    };
+
+    static void* thread_main(void* writer);
+    static void encode_frame(void* batch, size_t index);
+    void encode_frames();
+    void check_error();
+
+    // Stops and joins the background thread, if it was started, and frees the synchronization
+    // objects.
+    void stop();
+
+    pthread_mutex_t _mutex;
+    pthread_cond_t _frame_queued;       // signalled when a frame joins `_queue`.
+    pthread_cond_t _frame_done;         // signalled when a frame returns to `_free`.
+    pthread_t _thread;
+    bool _started;
+    std::vector<sfz::linked_ptr<Frame> > _frames;
+    std::vector<Frame*> _free;
+    std::deque<Frame*> _queue;
+    int _encoding;                      // frames taken from `_queue` but not yet written.
+    bool _stopping;
+    bool _failed;
+    sfz::String _error;
+
+    DISALLOW_COPY_AND_ASSIGN(PngWriter);
+};
+
+// Converts `count` pixels from A, R, G, B order to R, G, B, A order.
+void argb_to_rgba(const RgbColor* argb, uint8_t* rgba, size_t count);
+
+}  // namespace antares
+
+#endif  // ANTARES_VIDEO_PNG_WRITER_HPP_
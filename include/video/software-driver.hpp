@@ -0,0 +1,129 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_VIDEO_SOFTWARE_DRIVER_HPP_
+#define ANTARES_VIDEO_SOFTWARE_DRIVER_HPP_
+
+#include <stdint.h>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "drawing/color.hpp"
+#include "drawing/pix-map.hpp"
+#include "math/geometry.hpp"
+#include "ui/card.hpp"
+#include "video/driver.hpp"
+#include "video/texture-atlas.hpp"
+
+namespace antares {
+
+// A VideoDriver which rasterizes on the CPU into an ArrayPixMap.
+//
+// Mirrors the state machine of OpenGlVideoDriver--blending with (SRC_ALPHA,
+// ONE_MINUS_SRC_ALPHA), nearest-neighbor texture sampling, and the same stencil protocol--so that
+// it can stand in for it wherever there is no GL context available, such as on headless machines
+// rendering replays.
+class SoftwareVideoDriver : public VideoDriver {
+  public:
+    SoftwareVideoDriver(Size screen_size);
+
+    virtual void set_game_state(GameState state);
+    virtual int get_demo_scenario();
+    virtual void main_loop_iteration_complete(uint32_t game_time);
+
+    virtual Sprite* new_sprite(sfz::PrintItem name, const PixMap& content);
+    virtual Sprite* new_packed_sprite(sfz::PrintItem name, const PixMap& content);
+    virtual Sprite* new_persistent_sprite(sfz::PrintItem name, const PixMap& content);
+    virtual void fill_rect(const Rect& rect, const RgbColor& color);
+    virtual void draw_point(const Point& at, const RgbColor& color);
+    virtual void draw_line(const Point& from, const Point& to, const RgbColor& color);
+    virtual void set_transition_fraction(double fraction);
+    virtual void set_transition_to(const RgbColor& color);
+
+    virtual void start_stencil();
+    virtual void set_stencil_threshold(uint8_t alpha);
+    virtual void apply_stencil();
+    virtual void end_stencil();
+
+    // Points and lines are cheap to draw directly, so batches aren't queued.
+    virtual void begin_batch() { }
+    virtual void batch_point(const Point& at, const RgbColor& color) { draw_point(at, color); }
+    virtual void batch_line(const Point& from, const Point& to, const RgbColor& color) {
+        draw_line(from, to, color);
+    }
+    virtual void end_batch() { }
+
+  protected:
+    class MainLoop {
+      public:
+        MainLoop(SoftwareVideoDriver& driver, Card* initial);
+        bool done();
+        void draw();
+        Card* top() const;
+
+      private:
+        SoftwareVideoDriver& _driver;
+        CardStack _stack;
+
+        DISALLOW_COPY_AND_ASSIGN(MainLoop);
+    };
+
+    Size screen_size() const { return _screen_size; }
+
+    // @returns             the frame buffer, as of the last completed `MainLoop::draw()`.
+    const ArrayPixMap& pix() const { return _pix; }
+
+  private:
+    class SoftwareSprite;
+
+    // Draws a horizontal run of pixels in row `y`, starting at column `left`.  If `step` is zero,
+    // then all `count` pixels are drawn with `*colors`; otherwise, consecutive pixels are drawn
+    // from consecutive elements of `colors`.  The span must already be clipped to the screen.
+    void draw_span(int32_t left, int32_t y, int32_t count, const RgbColor* colors, int step);
+
+    // Clears the color and stencil buffers, as at the start of a frame.
+    void clear();
+
+    // Copies `content` into `_atlas`, or into a sprite of its own if it is too large to share.
+    Sprite* pack_sprite(sfz::PrintItem name, const PixMap& content, bool persistent);
+
+    const Size _screen_size;
+
+    ArrayPixMap _pix;
+    sfz::scoped_array<uint8_t> _stencil;
+
+    // Pixels of sprites from `new_packed_sprite()`, laid out by `_atlas`.
+    TextureAtlas _atlas;
+    std::vector<sfz::linked_ptr<ArrayPixMap> > _atlas_pages;
+
+    double _transition_fraction;
+    RgbColor _transition_color;
+
+    // True between `start_stencil()` and `apply_stencil()`: drawing operations increment the
+    // stencil buffer instead of touching the color buffer.
+    bool _stencil_writing;
+    uint8_t _stencil_threshold;
+    int8_t _stencil_height;
+
+    DISALLOW_COPY_AND_ASSIGN(SoftwareVideoDriver);
+};
+
+}  // namespace antares
+
+#endif  // ANTARES_VIDEO_SOFTWARE_DRIVER_HPP_
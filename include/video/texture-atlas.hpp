@@ -0,0 +1,93 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef ANTARES_VIDEO_TEXTURE_ATLAS_HPP_
+#define ANTARES_VIDEO_TEXTURE_ATLAS_HPP_
+
+#include <stdint.h>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "math/geometry.hpp"
+
+namespace antares {
+
+// The width and height of atlas pages.  Both OpenGlVideoDriver and SoftwareVideoDriver use this,
+// so that they lay out packed sprites identically.
+const int32_t kTextureAtlasPageSize = 1024;
+
+// Packs small images into a few large pages, so that a driver can draw many of them without
+// switching textures.  This only decides where images go; drivers own the pages themselves.
+//
+// Each page is divided into horizontal shelves, filled left to right.  An image goes on the
+// shortest shelf which is tall enough and has room for it; failing that, a new shelf is opened at
+// the bottom of the first page with room, or a new page is added.  Images are separated by a
+// one-pixel gutter, so that scaled drawing never samples a neighbor.
+//
+// Space is not reused piecemeal: a page is emptied for reuse once every image on it has been
+// released.  This suits sprite frames, which are loaded and freed a level at a time.  Images which
+// are never released go on pages of their own, so that they can't keep a page of frames from being
+// emptied.
+class TextureAtlas {
+  public:
+    struct Location {
+        int32_t page;
+        Rect bounds;
+    };
+
+    TextureAtlas(Size page_size);
+
+    const Size& page_size() const { return _page_size; }
+    int32_t page_count() const { return _pages.size(); }
+
+    // Finds room for an image of `size`.
+    //
+    // @param [in] size     the size of the image.
+    // @param [in] persistent  true if the image is kept for the life of the atlas.
+    // @param [out] location  set to the page and bounds the image should be copied to.
+    // @returns             true if the image was placed; false if it is too large to share a page
+    //                      (more than a quarter of the page in either dimension).
+    bool place(Size size, bool persistent, Location* location);
+
+    // Releases the space of an image returned by `place()`.
+    void release(const Location& location);
+
+  private:
+    struct Shelf {
+        int32_t top;
+        int32_t height;
+        int32_t right;
+    };
+    struct Page {
+        explicit Page(bool persistent): persistent(persistent), bottom(0), live(0) { }
+        bool persistent;
+        std::vector<Shelf> shelves;
+        int32_t bottom;
+        int32_t live;
+    };
+
+    const Size _page_size;
+    std::vector<Page> _pages;
+
+    DISALLOW_COPY_AND_ASSIGN(TextureAtlas);
+};
+
+}  // namespace antares
+
+#endif  // ANTARES_VIDEO_TEXTURE_ATLAS_HPP_
@@ -0,0 +1,461 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <sys/time.h>
+#include <algorithm>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "data/space-object.hpp"
+#include "game/globals.hpp"
+#include "game/motion.hpp"
+#include "game/space-object.hpp"
+#include "game/starfield.hpp"
+#include "math/fixed.hpp"
+#include "math/rotation.hpp"
+#include "math/special.hpp"
+#include "math/units.hpp"
+
+using sfz::String;
+using sfz::args::help;
+using sfz::args::store;
+using sfz::args::store_const;
+using sfz::dec;
+using sfz::format;
+using sfz::print;
+using std::vector;
+
+namespace args = sfz::args;
+namespace io = sfz::io;
+
+namespace antares {
+namespace {
+
+int64_t wall_usecs() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (tv.tv_sec * 1000000ll) + tv.tv_usec;
+}
+
+// A small, deterministic generator, so that each configuration sees the same objects.
+class Lcg {
+  public:
+    Lcg(uint32_t seed): _state(seed) { }
+    uint32_t next(uint32_t range) {
+        _state = (_state * 1103515245u) + 12345u;
+        return (_state >> 8) % range;
+    }
+
+  private:
+    uint32_t _state;
+};
+
+baseObjectType gBenchBaseObject;
+
+// Fills the first `count` slots of gSpaceObjectData with turning, thrusting ships, and links them
+// into gRootObject.  If `shuffle` is true, they are linked in a random order, as they are after a
+// scenario has been running for a while and slots have been freed and reused; otherwise, they are
+// linked in slot order.
+void place(int count, bool shuffle, Lcg* random) {
+    vector<int> order;
+    for (int i = 0; i < kMaxSpaceObject; ++i) {
+        gSpaceObjectData[i] = spaceObjectType();
+        if (i < count) {
+            order.push_back(i);
+        }
+    }
+    if (shuffle) {
+        for (int i = count - 1; i > 0; --i) {
+            std::swap(order[i], order[random->next(i + 1)]);
+        }
+    }
+
+    gRootObject = NULL;
+    for (int i = count - 1; i >= 0; --i) {
+        spaceObjectType* o = &gSpaceObjectData[order[i]];
+        o->entryNumber = order[i];
+        o->baseType = &gBenchBaseObject;
+        o->active = kObjectInUse;
+        o->attributes = kCanTurn | kDoesBounce;
+        o->direction = random->next(ROT_POS);
+        o->turnVelocity = random->next(512) - 256;
+        o->location.h = kUniversalCenter + random->next(32768);
+        o->location.v = kUniversalCenter + random->next(32768);
+        o->maxVelocity = 0x300;
+        o->thrust = random->next(0x200) - 0x100;
+        o->nextObject = gRootObject;
+        gRootObject = o;
+    }
+}
+
+const uint32_t kThinkiverseTopLeft       = (kUniversalCenter - (2 * 65534));
+const uint32_t kThinkiverseBottomRight   = (kUniversalCenter + (2 * 65534));
+
+// The sub-step loop of MoveSpaceObjects() from before objects were packed into MotionState, which
+// turned, thrust, moved and bounded each object in place as it walked gRootObject.  Animation and
+// beams are left out, since the objects placed here have neither.
+void MoveInPlace(int units) {
+    for (int unit = 0; unit < units; ++unit) {
+        for (spaceObjectType* anObject = gRootObject; anObject != NULL;
+                anObject = anObject->nextObject) {
+            if (anObject->active != kObjectInUse) {
+                continue;
+            }
+            if (( anObject->maxVelocity != 0) || ( anObject->attributes & kCanTurn))
+            {
+                long h, v;
+                if ( anObject->attributes & kCanTurn)
+                {
+                    anObject->turnFraction += anObject->turnVelocity;
+
+                    if ( anObject->turnFraction >= 0)
+                        h = more_evil_fixed_to_long(anObject->turnFraction + mFloatToFixed(0.5));
+                    else
+                        h = more_evil_fixed_to_long(anObject->turnFraction - mFloatToFixed(0.5)) + 1;
+                    anObject->direction += h;
+                    anObject->turnFraction -= mLongToFixed(h);
+
+                    while ( anObject->direction >= ROT_POS)
+                        anObject->direction -= ROT_POS;
+                    while ( anObject->direction < 0)
+                        anObject->direction += ROT_POS;
+                }
+
+                if ( anObject->thrust != 0)
+                {
+                    Fixed fa, fb, fh, fv, useThrust;
+                    if ( anObject->thrust > 0)
+                    {
+                        GetRotPoint(&fa, &fb, anObject->direction);
+                        if (( anObject->presenceState == kWarpingPresence) ||
+                            ( anObject->presenceState == kWarpOutPresence))
+                        {
+                            fa = mMultiplyFixed( fa, anObject->presenceData);
+                            fb = mMultiplyFixed( fb, anObject->presenceData);
+                        } else
+                        {
+                            fa = mMultiplyFixed( anObject->maxVelocity, fa);
+                            fb = mMultiplyFixed( anObject->maxVelocity, fb);
+                        }
+                        fa = fa - anObject->velocity.h;
+                        fb = fb - anObject->velocity.v;
+                        useThrust = anObject->thrust;
+                    } else
+                    {
+                        fa = -anObject->velocity.h;
+                        fb = -anObject->velocity.v;
+                        useThrust = -anObject->thrust;
+                    }
+
+                    int32_t angle;
+                    if ( fa == 0)
+                    {
+                        if ( fb < 0)
+                            angle = 180;
+                        else angle = 0;
+                    } else
+                    {
+                        angle = AngleFromSlope( MyFixRatio(fa, fb));
+                        if ( fa > 0) angle += 180;
+                        if ( angle >= 360) angle -= 360;
+                    }
+
+                    GetRotPoint(&fh, &fv, angle);
+                    fh = mMultiplyFixed( useThrust, fh);
+                    fv = mMultiplyFixed( useThrust, fv);
+
+                    if ( fh < 0)
+                    {
+                        if ( fa < fh)
+                            fa = fh;
+                    } else
+                    {
+                        if ( fa > fh)
+                            fa = fh;
+                    }
+                    if ( fv < 0)
+                    {
+                        if ( fb < fv)
+                            fb = fv;
+                    } else
+                    {
+                        if ( fb > fv)
+                            fb = fv;
+                    }
+
+                    anObject->velocity.h += fa;
+                    anObject->velocity.v += fb;
+                }
+
+                anObject->motionFraction.h += anObject->velocity.h;
+                anObject->motionFraction.v += anObject->velocity.v;
+
+                if ( anObject->motionFraction.h >= 0)
+                    h = more_evil_fixed_to_long(anObject->motionFraction.h + mFloatToFixed(0.5));
+                else
+                    h = more_evil_fixed_to_long(anObject->motionFraction.h - mFloatToFixed(0.5)) + 1;
+                anObject->location.h -= h;
+                anObject->motionFraction.h -= mLongToFixed(h);
+
+                if ( anObject->motionFraction.v >= 0)
+                    v = more_evil_fixed_to_long(anObject->motionFraction.v + mFloatToFixed(0.5));
+                else
+                    v = more_evil_fixed_to_long(anObject->motionFraction.v - mFloatToFixed(0.5)) + 1;
+                anObject->location.v -= v;
+                anObject->motionFraction.v -= mLongToFixed(v);
+            }
+
+            if ( !(anObject->attributes & kDoesBounce))
+            {
+                if (( anObject->location.h < kThinkiverseTopLeft) ||
+                    ( anObject->location.v < kThinkiverseTopLeft) ||
+                    ( anObject->location.h > kThinkiverseBottomRight) ||
+                    ( anObject->location.v > kThinkiverseBottomRight))
+                {
+                    anObject->active = kObjectToBeFreed;
+                }
+            } else
+            {
+                if ( anObject->location.h < kThinkiverseTopLeft)
+                {
+                    anObject->location.h = kThinkiverseTopLeft;
+                    anObject->velocity.h = -anObject->velocity.h;
+                } else if ( anObject->location.h > kThinkiverseBottomRight)
+                {
+                    anObject->location.h = kThinkiverseBottomRight;
+                    anObject->velocity.h = -anObject->velocity.h;
+                }
+                if ( anObject->location.v < kThinkiverseTopLeft)
+                {
+                    anObject->location.v = kThinkiverseTopLeft;
+                    anObject->velocity.v = -anObject->velocity.v;
+                } else if ( anObject->location.v > kThinkiverseBottomRight)
+                {
+                    anObject->location.v = kThinkiverseBottomRight;
+                    anObject->velocity.v = -anObject->velocity.v;
+                }
+            }
+        }
+    }
+}
+
+int64_t in_place(int cycles, int units) {
+    int64_t usecs = 0;
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        const int64_t start = wall_usecs();
+        MoveInPlace(units);
+        usecs += wall_usecs() - start;
+    }
+    return usecs;
+}
+
+int64_t move(int cycles, int units) {
+    int64_t usecs = 0;
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        const int64_t start = wall_usecs();
+        MoveSpaceObjects(gSpaceObjectData.get(), kMaxSpaceObject, units);
+        usecs += wall_usecs() - start;
+    }
+    return usecs;
+}
+
+// The fields which moving an object changes.
+struct Kinematics {
+    int32_t direction;
+    Fixed turnFraction;
+    coordPointType location;
+    fixedPointType velocity;
+    fixedPointType motionFraction;
+    int32_t active;
+
+    explicit Kinematics(const spaceObjectType& o)
+            : direction(o.direction),
+              turnFraction(o.turnFraction),
+              location(o.location),
+              velocity(o.velocity),
+              motionFraction(o.motionFraction),
+              active(o.active) { }
+
+    bool operator==(const Kinematics& other) const {
+        return (direction == other.direction)
+            && (turnFraction == other.turnFraction)
+            && (location.h == other.location.h) && (location.v == other.location.v)
+            && (velocity.h == other.velocity.h) && (velocity.v == other.velocity.v)
+            && (motionFraction.h == other.motionFraction.h)
+            && (motionFraction.v == other.motionFraction.v)
+            && (active == other.active);
+    }
+};
+
+// A value in [-magnitude, magnitude].
+int32_t signed_next(Lcg* random, int32_t magnitude) {
+    return static_cast<int32_t>(random->next((2 * magnitude) + 1)) - magnitude;
+}
+
+// Fills the first `count` slots of gSpaceObjectData with objects in random states, and links them
+// into gRootObject in slot order.  The states cover more than the game produces: fast turns,
+// speeds which overflow the int16_t slope in MyFixRatio(), warping objects, objects which neither
+// turn nor move, and objects at or outside the edges of the universe.
+void place_random(int count, Lcg* random) {
+    for (int i = 0; i < kMaxSpaceObject; ++i) {
+        gSpaceObjectData[i] = spaceObjectType();
+    }
+
+    const uint32_t kEdgeMargin = 8192;
+    gRootObject = NULL;
+    for (int i = count - 1; i >= 0; --i) {
+        spaceObjectType* o = &gSpaceObjectData[i];
+        o->entryNumber = i;
+        o->baseType = &gBenchBaseObject;
+        o->active = kObjectInUse;
+        o->attributes = (random->next(4) != 0) ? kCanTurn : 0;
+        if (random->next(2)) {
+            o->attributes |= kDoesBounce;
+        }
+        o->direction = random->next(ROT_POS);
+        o->turnVelocity = signed_next(random, 0x10000);
+        o->turnFraction = signed_next(random, 0x80);
+        o->maxVelocity = (random->next(8) == 0) ? 0 : random->next(0x8000);
+        o->thrust = (random->next(4) == 0) ? 0 : signed_next(random, 0x8000);
+        if (random->next(4) == 0) {
+            o->presenceState = random->next(2) ? kWarpingPresence : kWarpOutPresence;
+            o->presenceData = random->next(0x8000);
+        }
+        o->velocity.h = signed_next(random, 0x100000);
+        o->velocity.v = signed_next(random, 0x100000);
+        o->motionFraction.h = signed_next(random, 0x80);
+        o->motionFraction.v = signed_next(random, 0x80);
+        const uint32_t span = kThinkiverseBottomRight - kThinkiverseTopLeft + (2 * kEdgeMargin);
+        o->location.h = kThinkiverseTopLeft - kEdgeMargin + random->next(span);
+        o->location.v = kThinkiverseTopLeft - kEdgeMargin + random->next(span);
+        o->nextObject = gRootObject;
+        gRootObject = o;
+    }
+}
+
+// Moves `states` random objects, kMaxSpaceObject at a time, with both the in-place loop and
+// MoveSpaceObjects(), and counts the objects which they leave in different states.
+int check(int states, int units) {
+    int mismatches = 0;
+    for (int done = 0, batch = 1; done < states; done += kMaxSpaceObject, ++batch) {
+        const int count = std::min<int>(kMaxSpaceObject, states - done);
+        Lcg in_place_random(batch);
+        place_random(count, &in_place_random);
+        MoveInPlace(units);
+        vector<Kinematics> expected;
+        for (int i = 0; i < count; ++i) {
+            expected.push_back(Kinematics(gSpaceObjectData[i]));
+        }
+
+        Lcg move_random(batch);
+        place_random(count, &move_random);
+        MoveSpaceObjects(gSpaceObjectData.get(), kMaxSpaceObject, units);
+        for (int i = 0; i < count; ++i) {
+            if (!(Kinematics(gSpaceObjectData[i]) == expected[i])) {
+                if (mismatches++ == 0) {
+                    print(io::err, format("mismatch at object {0} of batch {1}\n",
+                                dec(i, 0), dec(batch, 0)));
+                }
+            }
+        }
+    }
+    print(io::out, "states\tunits\tmismatches\n");
+    print(io::out, format("{0}\t{1}\t{2}\n", dec(states, 0), dec(units, 0), dec(mismatches, 0)));
+    return mismatches;
+}
+
+// Times the in-place loop and MoveSpaceObjects() on the same objects, and counts the objects
+// which they leave in different states.
+void run(int count, bool shuffle, int units, int cycles) {
+    Lcg in_place_random(count);
+    place(count, shuffle, &in_place_random);
+    const int64_t in_place_usecs = in_place(cycles, units);
+    vector<Kinematics> expected;
+    for (int i = 0; i < count; ++i) {
+        expected.push_back(Kinematics(gSpaceObjectData[i]));
+    }
+
+    Lcg move_random(count);
+    place(count, shuffle, &move_random);
+    const int64_t move_usecs = move(cycles, units);
+    int mismatches = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!(Kinematics(gSpaceObjectData[i]) == expected[i])) {
+            ++mismatches;
+        }
+    }
+
+    // Report nanoseconds per object per sub-step.
+    const int64_t steps = static_cast<int64_t>(cycles) * units * count;
+    print(io::out, format("{0}\t{1}\t{2}\t{3}\t{4}\t{5}\n",
+                dec(count, 0), shuffle ? "shuffled" : "linear", dec(units, 0),
+                dec((in_place_usecs * 1000) / steps, 0), dec((move_usecs * 1000) / steps, 0),
+                dec(mismatches, 0)));
+}
+
+void main(int argc, char* const* argv) {
+    args::Parser parser(argv[0], "Benchmarks MoveSpaceObjects()");
+
+    int units = 3;
+    int cycles = 10000;
+    bool check_only = false;
+    parser.add_argument("-u", "--units", store(units))
+        .help("sub-steps per call (default: 3)");
+    parser.add_argument("-c", "--cycles", store(cycles))
+        .help("number of calls to time (default: 10000)");
+    parser.add_argument("-k", "--check", store_const(check_only, true))
+        .help("check against the in-place loop on 20000 random states, instead of timing");
+    parser.add_argument("-h", "--help", help(parser, 0))
+        .help("display this help screen");
+
+    String error;
+    if (!parser.parse_args(argc - 1, argv + 1, error)) {
+        print(io::err, format("{0}: {1}\n", parser.name(), error));
+        exit(1);
+    }
+
+    init_globals();
+    gSpaceObjectData.reset(new spaceObjectType[kMaxSpaceObject]);
+    gScrollStarObject = NULL;
+    InitMotion();
+
+    if (check_only) {
+        const int mismatches = check(20000, units);
+        MotionCleanup();
+        exit((mismatches == 0) ? 0 : 1);
+    }
+
+    print(io::out, format("sizeof(spaceObjectType) = {0}\n", sizeof(spaceObjectType)));
+    print(io::out, "objects\torder\tunits\tin-place ns\tmove ns\tmismatches\n");
+    const int counts[] = {50, 125, kMaxSpaceObject};
+    for (size_t i = 0; i < (sizeof(counts) / sizeof(counts[0])); ++i) {
+        run(counts[i], false, units, cycles);
+        run(counts[i], true, units, cycles);
+    }
+
+    MotionCleanup();
+}
+
+}  // namespace
+}  // namespace antares
+
+int main(int argc, char* const* argv) {
+    antares::main(argc, argv);
+    return 0;
+}
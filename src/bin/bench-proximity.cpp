@@ -0,0 +1,175 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <sys/time.h>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "game/spatial-hash.hpp"
+#include "math/units.hpp"
+
+using sfz::String;
+using sfz::StringSlice;
+using sfz::args::help;
+using sfz::args::store;
+using sfz::dec;
+using sfz::format;
+using sfz::print;
+using std::vector;
+
+namespace args = sfz::args;
+namespace io = sfz::io;
+namespace utf8 = sfz::utf8;
+
+namespace antares {
+namespace {
+
+// The collision grid used by CollideSpaceObjects(): 128-unit cells in a 16x16 grid.
+const int kCurrentUnitShift = 7;
+const int kCurrentSizeShift = 4;
+
+int64_t wall_usecs() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (tv.tv_sec * 1000000ll) + tv.tv_usec;
+}
+
+// A small, deterministic generator, so that each configuration sees the same objects.
+class Lcg {
+  public:
+    Lcg(uint32_t seed): _state(seed) { }
+    uint32_t next(uint32_t range) {
+        _state = (_state * 1103515245u) + 12345u;
+        return (_state >> 8) % range;
+    }
+
+  private:
+    uint32_t _state;
+};
+
+struct Location {
+    uint32_t h;
+    uint32_t v;
+};
+
+// Places `count` objects.  In the "uniform" layout, objects are spread evenly over a square
+// `spread` units on a side.  In the "aliased" layout, objects are gathered in clumps exactly one
+// 16x16 grid apart, so that every clump hashes into the same few buckets of the current grid;
+// this is the case which degrades it to O(n^2).
+void place(StringSlice layout, int count, int spread, Lcg* random, vector<Location>* out) {
+    out->resize(count);
+    const int period = 1 << (kCurrentUnitShift + kCurrentSizeShift);
+    for (int i = 0; i < count; ++i) {
+        Location& l = (*out)[i];
+        if (layout == "aliased") {
+            const int clumps = (spread / period) + 1;
+            l.h = kUniversalCenter + (period * random->next(clumps)) + random->next(256);
+            l.v = kUniversalCenter + (period * random->next(clumps)) + random->next(256);
+        } else {
+            l.h = kUniversalCenter + random->next(spread);
+            l.v = kUniversalCenter + random->next(spread);
+        }
+    }
+}
+
+// Runs `cycles` rebuild-and-query cycles, as CollideSpaceObjects() does for its collision grid.
+// `tests` counts entries examined by the pair search; `pairs` counts those actually adjacent.
+void run(
+        int unit_shift, int size_shift, StringSlice layout, int count, int spread, int cycles) {
+    SpatialHash grid(unit_shift, size_shift);
+    Lcg random(count);
+    vector<Location> locations;
+    int64_t tests = 0;
+    int64_t pairs = 0;
+    int64_t usecs = 0;
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        place(layout, count, spread, &random, &locations);
+
+        const int64_t start = wall_usecs();
+        grid.clear();
+        for (int i = 0; i < count; ++i) {
+            grid.add(i, locations[i].h, locations[i].v);
+        }
+        grid.sort();
+        for (int32_t bucket = 0; bucket < grid.bucket_count(); ++bucket) {
+            const SpatialHash::Entry* end = grid.end(bucket);
+            for (const SpatialHash::Entry* a = grid.begin(bucket); a != end; ++a) {
+                for (int k = 0; k < SpatialHash::kNeighborCount; ++k) {
+                    const Point cell = SpatialHash::neighbor_cell(a->cell, k);
+                    const int32_t b_bucket = grid.neighbor_bucket(bucket, k);
+                    const SpatialHash::Entry* b = (k == 0) ? (a + 1) : grid.begin(b_bucket);
+                    for ( ; b != grid.end(b_bucket); ++b) {
+                        ++tests;
+                        if ((b->cell.h == cell.h) && (b->cell.v == cell.v)) {
+                            ++pairs;
+                        }
+                    }
+                }
+            }
+        }
+        usecs += wall_usecs() - start;
+    }
+
+    print(io::out, format("{0}\t{1}x{1}\t{2}\t{3}\t{4}\t{5}\n",
+                dec(1 << unit_shift, 0), dec(1 << size_shift, 0),
+                dec(tests / cycles, 0), dec(pairs / cycles, 0),
+                dec(usecs / cycles, 0),
+                (unit_shift == kCurrentUnitShift) && (size_shift == kCurrentSizeShift)
+                ? "current" : ""));
+}
+
+void main(int argc, char* const* argv) {
+    args::Parser parser(argv[0], "Benchmarks the proximity grid used for collision checking");
+
+    String layout("uniform");
+    int count = 250;
+    int spread = 32768;
+    int cycles = 1000;
+    parser.add_argument("-l", "--layout", store(layout))
+        .help("uniform or aliased (default: uniform)");
+    parser.add_argument("-n", "--objects", store(count))
+        .help("number of objects (default: 250)");
+    parser.add_argument("-s", "--spread", store(spread))
+        .help("width of the area objects are placed in (default: 32768)");
+    parser.add_argument("-c", "--cycles", store(cycles))
+        .help("number of cycles to run (default: 1000)");
+    parser.add_argument("-h", "--help", help(parser, 0))
+        .help("display this help screen");
+
+    String error;
+    if (!parser.parse_args(argc - 1, argv + 1, error)) {
+        print(io::err, format("{0}: {1}\n", parser.name(), error));
+        exit(1);
+    }
+
+    print(io::out, "cell\tgrid\ttests\tpairs\tusecs\n");
+    run(kCurrentUnitShift, kCurrentSizeShift, layout, count, spread, cycles);
+    run(kCurrentUnitShift, 5, layout, count, spread, cycles);
+    run(kCurrentUnitShift, 6, layout, count, spread, cycles);
+    run(kCurrentUnitShift, 8, layout, count, spread, cycles);
+    run(kCurrentUnitShift + 1, 6, layout, count, spread, cycles);
+}
+
+}  // namespace
+}  // namespace antares
+
+int main(int argc, char* const* argv) {
+    antares::main(argc, argv);
+    return 0;
+}
@@ -0,0 +1,266 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <limits>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "math/fixed.hpp"
+#include "math/rotation.hpp"
+#include "math/special.hpp"
+
+using sfz::String;
+using sfz::args::help;
+using sfz::args::store_const;
+using sfz::dec;
+using sfz::format;
+using sfz::print;
+using std::numeric_limits;
+using std::vector;
+
+namespace args = sfz::args;
+namespace io = sfz::io;
+
+namespace antares {
+namespace {
+
+// Inputs are checked this many at a time.  It is not a multiple of four, so that the scalar tail
+// of each kernel is checked too.
+const size_t kChunk = (1 << 16) + 3;
+
+// A small, deterministic generator, so that each run checks the same inputs.
+class Lcg {
+  public:
+    Lcg(uint32_t seed): _state(seed) { }
+    uint32_t next() {
+        _state = (_state * 1103515245u) + 12345u;
+        return _state;
+    }
+
+  private:
+    uint32_t _state;
+};
+
+// Counts the inputs checked against one kernel, and reports the first mismatch.
+class Check {
+  public:
+    explicit Check(const char* name): _name(name), _count(0), _failures(0) { }
+
+    void expect(bool ok, const String& input) {
+        ++_count;
+        if (!ok && (_failures++ == 0)) {
+            print(io::err, format("{0}: mismatch at {1}\n", _name, input));
+        }
+    }
+
+    bool report() const {
+        print(io::out, format("{0}\t{1}\t{2}\n", _name, dec(_count, 0), dec(_failures, 0)));
+        return _failures == 0;
+    }
+
+  private:
+    const char* const _name;
+    int64_t _count;
+    int64_t _failures;
+};
+
+// Every uint32_t.
+bool check_lsqrt(bool quick) {
+    Check check("lsqrt");
+    const uint64_t step = quick ? 65537 : 1;
+    vector<uint32_t> n(kChunk);
+    vector<uint32_t> out(kChunk);
+    for (uint64_t base = 0; base < (1ull << 32); base += kChunk * step) {
+        size_t count = 0;
+        for (uint64_t i = base; (i < (1ull << 32)) && (count < kChunk); i += step) {
+            n[count++] = i;
+        }
+        lsqrt_batch(&n[0], &out[0], count);
+        for (size_t i = 0; i < count; ++i) {
+            check.expect(out[i] == lsqrt(n[i]), format("{0}", n[i]));
+        }
+    }
+    return check.report();
+}
+
+// Every pair of int16_ts, except (-32768, -1), where the scalar division traps.
+bool check_fix_ratio(bool quick) {
+    Check check("MyFixRatio");
+    vector<int16_t> numer(65536);
+    vector<int16_t> denom(65536);
+    vector<Fixed> out(65536);
+    for (int32_t d = -32768; d < 32768; d += (quick ? 257 : 1)) {
+        for (int32_t n = -32768; n < 32768; ++n) {
+            numer[n + 32768] = ((n == -32768) && (d == -1)) ? 0 : n;
+            denom[n + 32768] = d;
+        }
+        MyFixRatioBatch(&numer[0], &denom[0], &out[0], 65536);
+        for (int32_t i = 0; i < 65536; ++i) {
+            check.expect(out[i] == MyFixRatio(numer[i], denom[i]),
+                    format("({0}, {1})", numer[i], denom[i]));
+        }
+    }
+    return check.report();
+}
+
+// Every slope within a few of an entry in the table, which covers every way the table can be
+// searched, and the extremes.  Slopes between entries all give the same answer as the entries
+// on either side of them.
+bool check_angle_from_slope() {
+    Check check("AngleFromSlope");
+    vector<Fixed> slope;
+    slope.push_back(numeric_limits<int32_t>::min());
+    slope.push_back(numeric_limits<int32_t>::max());
+    for (Fixed s = -4000000; s <= 4000000; ++s) {
+        slope.push_back(s);
+    }
+    vector<int32_t> out(slope.size());
+    AngleFromSlopeBatch(&slope[0], &out[0], slope.size());
+    for (size_t i = 0; i < slope.size(); ++i) {
+        check.expect(out[i] == AngleFromSlope(slope[i]), format("{0}", slope[i]));
+    }
+    return check.report();
+}
+
+// Random pairs, plus every pair of values near zero and near the edges of the range.
+bool check_multiply_fixed(bool quick) {
+    Check check("mMultiplyFixed");
+    vector<Fixed> values;
+    for (int32_t i = -1024; i <= 1024; ++i) {
+        values.push_back(i);
+        values.push_back(numeric_limits<int32_t>::min() + 1024 + i);
+        values.push_back(numeric_limits<int32_t>::max() - 1024 + i);
+    }
+    vector<Fixed> a;
+    vector<Fixed> b;
+    for (size_t i = 0; i < values.size(); i += (quick ? 61 : 1)) {
+        for (size_t j = 0; j < values.size(); ++j) {
+            a.push_back(values[i]);
+            b.push_back(values[j]);
+        }
+    }
+    Lcg random(1);
+    for (int i = 0; i < (quick ? (1 << 16) : (1 << 24)); ++i) {
+        a.push_back(random.next());
+        b.push_back(random.next());
+    }
+    vector<Fixed> out(a.size());
+    MultiplyFixedBatch(&a[0], &b[0], &out[0], a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        check.expect(out[i] == mMultiplyFixed(a[i], b[i]), format("({0}, {1})", a[i], b[i]));
+    }
+    return check.report();
+}
+
+// Fills the rotation table.  The kernels must agree whatever is in it, so as well as points
+// like the ones in the real table, it is tried with values small enough to tie often, and large
+// enough to overflow.
+void fill_rot_table(int kind, Lcg* random) {
+    for (int i = 0; i < kRotTableSize; ++i) {
+        const uint32_t r = random->next();
+        switch (kind) {
+          case 0: gRotTable[i] = static_cast<int32_t>(r % 513) - 256; break;
+          case 1: gRotTable[i] = static_cast<int32_t>(r % 7) - 3; break;
+          default: gRotTable[i] = r; break;
+        }
+    }
+}
+
+// Every rotation, and every vector with coordinates in [-512, 512], plus random ones.
+bool check_rotation(bool quick) {
+    Check rot_point("GetRotPoint");
+    Check angle("GetAngleFromVector");
+    Lcg random(2);
+    for (int kind = 0; kind < 3; ++kind) {
+        fill_rot_table(kind, &random);
+
+        vector<int32_t> rotpos;
+        for (int32_t i = 0; i < ROT_POS; ++i) {
+            rotpos.push_back(i);
+        }
+        vector<int32_t> px(rotpos.size());
+        vector<int32_t> py(rotpos.size());
+        GetRotPointBatch(&rotpos[0], &px[0], &py[0], rotpos.size());
+        for (size_t i = 0; i < rotpos.size(); ++i) {
+            int32_t x, y;
+            GetRotPoint(&x, &y, rotpos[i]);
+            rot_point.expect((px[i] == x) && (py[i] == y), format("{0}", rotpos[i]));
+        }
+
+        vector<int32_t> x;
+        vector<int32_t> y;
+        const int32_t limit = quick ? 64 : 512;
+        for (int32_t h = -limit; h <= limit; ++h) {
+            for (int32_t v = -limit; v <= limit; ++v) {
+                x.push_back(h);
+                y.push_back(v);
+            }
+        }
+        for (int i = 0; i < (quick ? (1 << 12) : (1 << 20)); ++i) {
+            x.push_back(random.next());
+            y.push_back(random.next());
+        }
+        x.push_back(numeric_limits<int32_t>::min());
+        y.push_back(numeric_limits<int32_t>::min());
+        vector<int32_t> out(x.size());
+        GetAngleFromVectorBatch(&x[0], &y[0], &out[0], x.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            angle.expect(out[i] == GetAngleFromVector(x[i], y[i]),
+                    format("({0}, {1})", x[i], y[i]));
+        }
+    }
+    const bool rot_point_ok = rot_point.report();
+    const bool angle_ok = angle.report();
+    return rot_point_ok && angle_ok;
+}
+
+void main(int argc, char* const* argv) {
+    args::Parser parser(argv[0], "Checks the batch math kernels against the scalar ones");
+
+    bool quick = false;
+    parser.add_argument("-q", "--quick", store_const(quick, true))
+        .help("check a sample of each input domain, rather than all of it");
+    parser.add_argument("-h", "--help", help(parser, 0))
+        .help("display this help screen");
+
+    String error;
+    if (!parser.parse_args(argc - 1, argv + 1, error)) {
+        print(io::err, format("{0}: {1}\n", parser.name(), error));
+        exit(1);
+    }
+
+    print(io::out, "kernel\tinputs\tmismatches\n");
+    bool ok = true;
+    ok = check_multiply_fixed(quick) && ok;
+    ok = check_lsqrt(quick) && ok;
+    ok = check_fix_ratio(quick) && ok;
+    ok = check_angle_from_slope() && ok;
+    ok = check_rotation(quick) && ok;
+    if (!ok) {
+        exit(1);
+    }
+}
+
+}  // namespace
+}  // namespace antares
+
+int main(int argc, char* const* argv) {
+    antares::main(argc, argv);
+    return 0;
+}
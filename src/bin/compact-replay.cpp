@@ -0,0 +1,144 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <fcntl.h>
+#include <sfz/sfz.hpp>
+
+#include "data/replay.hpp"
+
+using sfz::Bytes;
+using sfz::Exception;
+using sfz::MappedFile;
+using sfz::Optional;
+using sfz::ScopedFd;
+using sfz::String;
+using sfz::args::help;
+using sfz::args::store;
+using sfz::dec;
+using sfz::format;
+using sfz::print;
+
+namespace args = sfz::args;
+namespace io = sfz::io;
+namespace path = sfz::path;
+
+namespace antares {
+namespace {
+
+bool same_item(const ReplayData::Item& a, const ReplayData::Item& b) {
+    if (a.type != b.type) {
+        return false;
+    }
+    switch (a.type) {
+      case ReplayData::Item::WAIT:
+        return a.data.wait == b.data.wait;
+      case ReplayData::Item::KEY_DOWN:
+        return a.data.key_down == b.data.key_down;
+      case ReplayData::Item::KEY_UP:
+        return a.data.key_up == b.data.key_up;
+    }
+    return false;
+}
+
+// Checks that `compact` decodes to exactly the items of `replay`, and that seeking to the start of
+// each non-empty wait lands on it.
+void check(const ReplayData& replay, const Bytes& compact) {
+    ReplayReader reader(compact);
+    if ((reader.chapter_id() != replay.chapter_id)
+            || (reader.global_seed() != replay.global_seed)) {
+        throw Exception("header differs after conversion");
+    }
+    ReplayData::Item item;
+    for (size_t i = 0; i < replay.items.size(); ++i) {
+        if (!reader.next(&item) || !same_item(item, replay.items[i])) {
+            throw Exception(format("item {0} differs after conversion", dec(i, 0)));
+        }
+    }
+    if (reader.next(&item)) {
+        throw Exception("extra items after conversion");
+    }
+
+    uint32_t ticks = 0;
+    for (size_t i = 0; i < replay.items.size(); ++i) {
+        if ((replay.items[i].type != ReplayData::Item::WAIT)
+                || (replay.items[i].data.wait == 0)) {
+            continue;
+        }
+        uint64_t keys_down;
+        if ((reader.seek(ticks, &keys_down) != ticks)
+                || !reader.next(&item) || (item.type != ReplayData::Item::WAIT)) {
+            throw Exception(format("seek to tick {0} failed after conversion", dec(ticks, 0)));
+        }
+        ticks += replay.items[i].data.wait;
+    }
+}
+
+void main(int argc, char* const* argv) {
+    args::Parser parser(argv[0], "Rewrites a replay in the compact format");
+
+    String input;
+    Optional<String> output;
+    Optional<String> output_dir;
+    parser.add_argument("input", store(input))
+        .help("a replay, in either format")
+        .required();
+    parser.add_argument("output", store(output))
+        .help("where to write the compact replay");
+    parser.add_argument("-o", "--output", store(output_dir))
+        .help("write the compact replay to this directory, under the input's name");
+    parser.add_argument("-h", "--help", help(parser, 0))
+        .help("display this help screen");
+
+    String error;
+    if (!parser.parse_args(argc - 1, argv + 1, error)) {
+        print(io::err, format("{0}: {1}\n", parser.name(), error));
+        exit(1);
+    }
+    if (output.has() == output_dir.has()) {
+        print(io::err, format("{0}: exactly one of output and --output is required\n",
+                    parser.name()));
+        exit(1);
+    }
+    String output_path;
+    if (output_dir.has()) {
+        output_path.assign(format("{0}/{1}", *output_dir, path::basename(input)));
+    } else {
+        output_path.assign(*output);
+    }
+
+    MappedFile file(input);
+    ReplayData replay(file.data());
+    Bytes compact;
+    write_compact(compact, replay);
+    check(replay, compact);
+
+    ScopedFd fd(open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    write(fd, compact);
+    print(io::out, format("{0}: {1} items, {2} bytes -> {3} bytes\n",
+                input, dec(replay.items.size(), 0), dec(file.data().size(), 0),
+                dec(compact.size(), 0)));
+}
+
+}  // namespace
+}  // namespace antares
+
+int main(int argc, char* const* argv) {
+    antares::main(argc, argv);
+    return 0;
+}
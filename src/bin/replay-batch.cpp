@@ -0,0 +1,354 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <dirent.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "config/ledger.hpp"
+#include "config/preferences.hpp"
+#include "game/globals.hpp"
+#include "game/main.hpp"
+#include "game/space-object.hpp"
+#include "sound/driver.hpp"
+#include "ui/event.hpp"
+#include "ui/flows/replay-master.hpp"
+#include "video/driver.hpp"
+#include "video/offscreen-driver.hpp"
+
+using sfz::CString;
+using sfz::Exception;
+using sfz::MappedFile;
+using sfz::Optional;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::args::help;
+using sfz::args::store;
+using sfz::dec;
+using sfz::format;
+using sfz::hex;
+using sfz::linked_ptr;
+using sfz::make_linked_ptr;
+using sfz::print;
+using sfz::string_to_int;
+using std::map;
+using std::max;
+using std::vector;
+
+namespace args = sfz::args;
+namespace io = sfz::io;
+namespace utf8 = sfz::utf8;
+
+namespace antares {
+namespace {
+
+int64_t wall_usecs() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (tv.tv_sec * 1000000ll) + tv.tv_usec;
+}
+
+// The outcome of one replay, as sent from a worker to the parent.
+struct Outcome {
+    Outcome(): failed(true), usecs(0), ticks(0), synch(0), result(NO_GAME) { }
+
+    bool failed;
+    int64_t usecs;
+    int64_t ticks;
+    uint64_t synch;
+    int32_t result;
+};
+
+const char* game_result_name(int32_t result) {
+    switch (result) {
+      case NO_GAME:         return "none";
+      case LOSE_GAME:       return "lose";
+      case WIN_GAME:        return "win";
+      case RESTART_GAME:    return "restart";
+      case QUIT_GAME:       return "quit";
+    }
+    return "unknown";
+}
+
+// Runs the replay at `path` to completion, in simulate-only mode, and writes its outcome to `fd`.
+// Only called in a freshly-forked worker, which exits afterwards: ReplayMaster leaves the
+// process's global state initialized, so it can only be used once.
+void run_replay(const StringSlice& path, int width, int height, int fd) {
+    Preferences::set_preferences(new Preferences);
+    Preferences::preferences()->set_screen_size(Size(width, height));
+    Preferences::preferences()->set_play_music_in_game(true);
+    PrefsDriver::set_driver(new NullPrefsDriver);
+
+    sfz::scoped_ptr<OffscreenVideoDriver> video(new OffscreenVideoDriver(
+                Preferences::preferences()->screen_size(), Optional<String>()));
+    video->schedule_event(make_linked_ptr(new MouseMoveEvent(0, Point(320, 240))));
+    VideoDriver::set_driver(video.release());
+    SoundDriver::set_driver(new NullSoundDriver);
+    Ledger::set_ledger(new NullLedger);
+
+    MappedFile replay_file(path);
+    GameResult game_result = NO_GAME;
+    Outcome outcome;
+    const int64_t start = wall_usecs();
+    VideoDriver::driver()->loop(new ReplayMaster(replay_file.data(), true, &game_result));
+    outcome.usecs = wall_usecs() - start;
+    outcome.failed = false;
+    outcome.ticks = globals()->gGameTime;
+    outcome.synch = globals()->gSynchValue;
+    outcome.result = game_result;
+
+    // An Outcome is much smaller than PIPE_BUF, so this is written atomically, and the worker
+    // never blocks on a parent which is waiting for it to exit.
+    if (write(fd, &outcome, sizeof(outcome)) != sizeof(outcome)) {
+        _exit(1);
+    }
+}
+
+// A running worker, reading replay `index` and writing its outcome to the other end of `fd`.
+struct Worker {
+    Worker(): pid(-1), fd(-1), index(-1) { }
+
+    pid_t pid;
+    int fd;
+    int index;
+};
+
+Worker start_worker(const StringSlice& path, int index, int width, int height) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw Exception("pipe() failed");
+    }
+    const pid_t pid = fork();
+    if (pid < 0) {
+        throw Exception("fork() failed");
+    } else if (pid == 0) {
+        close(fds[0]);
+        try {
+            run_replay(path, width, height, fds[1]);
+        } catch (Exception& e) {
+            print(io::err, format("{0}: {1}\n", path, e.what()));
+            _exit(1);
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    Worker worker;
+    worker.pid = pid;
+    worker.fd = fds[0];
+    worker.index = index;
+    return worker;
+}
+
+// Reads the outcome of `worker`, which has exited with `status`.
+Outcome finish_worker(const Worker& worker, int status) {
+    Outcome outcome;
+    if (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) {
+        if (read(worker.fd, &outcome, sizeof(outcome)) != sizeof(outcome)) {
+            outcome = Outcome();
+        }
+    }
+    close(worker.fd);
+    return outcome;
+}
+
+bool name_less(const linked_ptr<String>& a, const linked_ptr<String>& b) {
+    return StringSlice(*a) < StringSlice(*b);
+}
+
+// Lists the replays (files ending in ".NLRP") in `dir`, sorted by name.
+void list_replays(const StringSlice& dir, vector<linked_ptr<String> >* names) {
+    CString c_dir(dir);
+    DIR* d = opendir(c_dir.data());
+    if (d == NULL) {
+        throw Exception(format("{0}: couldn't open directory", dir));
+    }
+    while (dirent* entry = readdir(d)) {
+        linked_ptr<String> name(new String(utf8::decode(entry->d_name)));
+        if ((name->size() > 5) && (StringSlice(*name).slice(name->size() - 5) == ".NLRP")) {
+            names->push_back(name);
+        }
+    }
+    closedir(d);
+    std::sort(names->begin(), names->end(), name_less);
+}
+
+// Reads a report written by a previous run, and stores the synch value and tick count for each
+// replay in `names` at the same index of `expected`.  Replays which aren't in the report are left
+// marked as failed.
+void read_expected(
+        const StringSlice& path, const vector<linked_ptr<String> >& names,
+        vector<Outcome>* expected) {
+    map<StringSlice, size_t> index;
+    for (size_t i = 0; i < names.size(); ++i) {
+        index[*names[i]] = i;
+    }
+    expected->assign(names.size(), Outcome());
+
+    MappedFile file(path);
+    String data(utf8::decode(file.data()));
+    StringSlice rest(data);
+    while (!rest.empty()) {
+        size_t eol = rest.find('\n');
+        if (eol == StringSlice::npos) {
+            eol = rest.size();
+        }
+        StringSlice line = rest.slice(0, eol);
+        rest = (eol < rest.size()) ? rest.slice(eol + 1) : StringSlice();
+
+        // replay, usecs, ticks, ticks/sec, synch, result, status.
+        vector<StringSlice> fields;
+        while (true) {
+            const size_t tab = line.find('\t');
+            if (tab == StringSlice::npos) {
+                fields.push_back(line);
+                break;
+            }
+            fields.push_back(line.slice(0, tab));
+            line = line.slice(tab + 1);
+        }
+        Outcome outcome;
+        if ((fields.size() < 5)
+                || !string_to_int(fields[2], outcome.ticks)
+                || !string_to_int(fields[4], outcome.synch, 16)) {
+            continue;  // The header, or a replay which failed.
+        }
+        map<StringSlice, size_t>::const_iterator it = index.find(fields[0]);
+        if (it != index.end()) {
+            outcome.failed = false;
+            (*expected)[it->second] = outcome;
+        }
+    }
+}
+
+int main(int argc, char* const* argv) {
+    args::Parser parser(argv[0], "Simulates a directory of replays in parallel");
+
+    String dir;
+    parser.add_argument("directory", store(dir))
+        .help("a directory of Antares replays")
+        .required();
+
+    int jobs = max<long>(sysconf(_SC_NPROCESSORS_ONLN), 1);
+    Optional<String> expected_path;
+    int width = 640;
+    int height = 480;
+    parser.add_argument("-j", "--jobs", store(jobs))
+        .help("number of replays to run at once (default: number of cores)");
+    parser.add_argument("-e", "--expected", store(expected_path))
+        .help("a report from an earlier run to compare against");
+    parser.add_argument("-w", "--width", store(width))
+        .help("screen width (default: 640)");
+    parser.add_argument("-h", "--height", store(height))
+        .help("screen height (default: 480)");
+    int objects = kMaxSpaceObject;
+    parser.add_argument("--objects", store(objects))
+        .help("maximum number of space objects (default: 250)");
+
+    parser.add_argument("--help", help(parser, 0))
+        .help("display this help screen");
+
+    String error;
+    if (!parser.parse_args(argc - 1, argv + 1, error)) {
+        print(io::err, format("{0}: {1}\n", parser.name(), error));
+        exit(1);
+    }
+    if ((objects < kMaxSpaceObject) || (objects > kSpaceObjectLimit)) {
+        print(io::err, format("{0}: --objects must be between {1} and {2}\n",
+                    parser.name(), dec(kMaxSpaceObject, 0), dec(kSpaceObjectLimit, 0)));
+        exit(1);
+    }
+    gMaxSpaceObject = objects;
+    jobs = max(jobs, 1);
+
+    vector<linked_ptr<String> > names;
+    list_replays(dir, &names);
+    vector<Outcome> expected;
+    if (expected_path.has()) {
+        read_expected(*expected_path, names, &expected);
+    }
+
+    // Keep `jobs` workers running until every replay has been started, then wait for the rest.
+    vector<Outcome> outcomes(names.size());
+    map<pid_t, Worker> workers;
+    size_t next = 0;
+    const int64_t start = wall_usecs();
+    while ((next < names.size()) || !workers.empty()) {
+        if ((next < names.size()) && (workers.size() < static_cast<size_t>(jobs))) {
+            String path(format("{0}/{1}", dir, *names[next]));
+            Worker worker = start_worker(path, next, width, height);
+            workers[worker.pid] = worker;
+            ++next;
+            continue;
+        }
+        int status;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            throw Exception("waitpid() failed");
+        }
+        map<pid_t, Worker>::iterator it = workers.find(pid);
+        if (it != workers.end()) {
+            outcomes[it->second.index] = finish_worker(it->second, status);
+            workers.erase(it);
+        }
+    }
+    const int64_t usecs = wall_usecs() - start;
+
+    int diverged = 0;
+    int failed = 0;
+    print(io::out, "replay\tusecs\tticks\tticks/sec\tsynch\tresult\tstatus\n");
+    for (size_t i = 0; i < names.size(); ++i) {
+        const Outcome& outcome = outcomes[i];
+        if (outcome.failed) {
+            ++failed;
+            print(io::out, format("{0}\t-\t-\t-\t-\t-\tfailed\n", *names[i]));
+            continue;
+        }
+
+        String status("ok");
+        if (!expected_path.has()) {
+            // Nothing to compare against.
+        } else if (expected[i].failed) {
+            status.assign("new");
+        } else if ((expected[i].synch != outcome.synch) || (expected[i].ticks != outcome.ticks)) {
+            ++diverged;
+            status.assign(format("diverged (expected {0} at {1})",
+                        hex(expected[i].synch, 8), dec(expected[i].ticks, 0)));
+        }
+        print(io::out, format("{0}\t{1}\t{2}\t{3}\t",
+                    *names[i], dec(outcome.usecs, 0), dec(outcome.ticks, 0),
+                    dec((outcome.ticks * 1000000) / max<int64_t>(outcome.usecs, 1), 0)));
+        print(io::out, format("{0}\t{1}\t{2}\n",
+                    hex(outcome.synch, 8), game_result_name(outcome.result), status));
+    }
+    print(io::err, format("{0} replays in {1} secs with {2} jobs: {3} diverged, {4} failed\n",
+                dec(names.size(), 0), dec(usecs / 1000000, 0), jobs, diverged, failed));
+    return ((diverged > 0) || (failed > 0)) ? 1 : 0;
+}
+
+}  // namespace
+}  // namespace antares
+
+int main(int argc, char* const* argv) {
+    return antares::main(argc, argv);
+}
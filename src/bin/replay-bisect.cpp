@@ -0,0 +1,243 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "game/checksum.hpp"
+#include "game/space-object.hpp"
+
+using sfz::CString;
+using sfz::Exception;
+using sfz::MappedFile;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::args::help;
+using sfz::args::store;
+using sfz::dec;
+using sfz::format;
+using sfz::hex;
+using sfz::linked_ptr;
+using sfz::print;
+using std::min;
+using std::vector;
+
+namespace args = sfz::args;
+namespace io = sfz::io;
+namespace utf8 = sfz::utf8;
+
+namespace antares {
+namespace {
+
+// Runs `binary` (the replay tool) in simulate-only mode on `replay`, with `extra` arguments, and
+// waits for it to finish.  Its output is discarded.
+void run_replay(
+        const StringSlice& binary, const StringSlice& replay, int objects,
+        const vector<linked_ptr<String> >& extra) {
+    vector<linked_ptr<CString> > c_args;
+    c_args.push_back(linked_ptr<CString>(new CString(binary)));
+    c_args.push_back(linked_ptr<CString>(new CString("--simulate-only")));
+    c_args.push_back(linked_ptr<CString>(new CString(format("--objects={0}", objects))));
+    for (size_t i = 0; i < extra.size(); ++i) {
+        c_args.push_back(linked_ptr<CString>(new CString(*extra[i])));
+    }
+    c_args.push_back(linked_ptr<CString>(new CString(replay)));
+    vector<char*> argv;
+    for (size_t i = 0; i < c_args.size(); ++i) {
+        argv.push_back(c_args[i]->data());
+    }
+    argv.push_back(NULL);
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        throw Exception("fork() failed");
+    } else if (pid == 0) {
+        const int null = ::open("/dev/null", O_WRONLY);
+        if (null >= 0) {
+            dup2(null, 1);
+        }
+        execv(argv[0], &argv[0]);
+        _exit(127);
+    }
+    int status;
+    if ((waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+        throw Exception(format("{0} failed on {1}", binary, replay));
+    }
+}
+
+void read_checksums(const StringSlice& path, vector<StateChecksum>* checksums) {
+    MappedFile file(path);
+    ReadChecksums(file.data(), checksums);
+}
+
+// Reads a dump written by ChecksumLog, one line per value.  If the run ended before the dump was
+// due, there is no file, and no lines.
+void read_dump(const StringSlice& path, vector<linked_ptr<String> >* lines) {
+    if (access(CString(path).data(), F_OK) != 0) {
+        return;
+    }
+    MappedFile file(path);
+    String data(utf8::decode(file.data()));
+    StringSlice rest(data);
+    while (!rest.empty()) {
+        size_t eol = rest.find('\n');
+        if (eol == StringSlice::npos) {
+            eol = rest.size();
+        }
+        lines->push_back(linked_ptr<String>(new String(rest.slice(0, eol))));
+        rest = (eol < rest.size()) ? rest.slice(eol + 1) : StringSlice();
+    }
+}
+
+// Finds the first record at which `a` and `b` differ, or the end of the shorter one if they agree
+// up to there.  A checksum can happen to match again after the runs diverge, so every record up to
+// the first mismatch is compared.
+size_t first_divergence(const vector<StateChecksum>& a, const vector<StateChecksum>& b) {
+    const size_t count = min(a.size(), b.size());
+    for (size_t i = 0; i < count; ++i) {
+        if (a[i] != b[i]) {
+            return i;
+        }
+    }
+    return count;
+}
+
+void remove_if_present(const StringSlice& path) {
+    unlink(CString(path).data());
+}
+
+int main(int argc, char* const* argv) {
+    args::Parser parser(argv[0], "Finds where two builds diverge while simulating a replay");
+
+    String replay;
+    String binary_a;
+    String binary_b;
+    parser.add_argument("replay", store(replay))
+        .help("an Antares replay script")
+        .required();
+    parser.add_argument("binary_a", store(binary_a))
+        .help("the replay tool from one build")
+        .required();
+    parser.add_argument("binary_b", store(binary_b))
+        .help("the replay tool from the other build")
+        .required();
+
+    int objects = kMaxSpaceObject;
+    parser.add_argument("--objects", store(objects))
+        .help("maximum number of space objects (default: 250)");
+    parser.add_argument("-h", "--help", help(parser, 0))
+        .help("display this help screen");
+
+    String error;
+    if (!parser.parse_args(argc - 1, argv + 1, error)) {
+        print(io::err, format("{0}: {1}\n", parser.name(), error));
+        exit(1);
+    }
+
+    char dir_template[] = "/tmp/antares-bisect.XXXXXX";
+    if (mkdtemp(dir_template) == NULL) {
+        throw Exception("mkdtemp() failed");
+    }
+    const String dir(utf8::decode(dir_template));
+    const String sums_a(format("{0}/a.checksums", dir));
+    const String sums_b(format("{0}/b.checksums", dir));
+    const String dump_a(format("{0}/a.dump", dir));
+    const String dump_b(format("{0}/b.dump", dir));
+
+    // Record checksums for the whole of both runs, and find the first decide cycle at which they
+    // differ.
+    vector<linked_ptr<String> > extra;
+    extra.push_back(linked_ptr<String>(new String(format("--checksums={0}", sums_a))));
+    run_replay(binary_a, replay, objects, extra);
+    extra[0].reset(new String(format("--checksums={0}", sums_b)));
+    run_replay(binary_b, replay, objects, extra);
+
+    vector<StateChecksum> a;
+    vector<StateChecksum> b;
+    read_checksums(sums_a, &a);
+    read_checksums(sums_b, &b);
+    const size_t index = first_divergence(a, b);
+    int result = 0;
+    if ((index == a.size()) && (index == b.size())) {
+        print(io::out, format("no divergence in {0} decide cycles\n", dec(a.size(), 0)));
+    } else if ((index == a.size()) || (index == b.size())) {
+        const vector<StateChecksum>& longer = (index == a.size()) ? b : a;
+        print(io::out, format("{0} ended early, at tick {1}\n",
+                    (index == a.size()) ? "a" : "b", dec(longer[index].game_time, 0)));
+        result = 1;
+    } else {
+        const int64_t tick = min(a[index].game_time, b[index].game_time);
+        print(io::out, format("first divergence at tick {0} (decide cycle {1})\n",
+                    dec(tick, 0), dec(index, 0)));
+        for (int i = 0; i < CHECKSUM_FIELD_COUNT; ++i) {
+            if (a[index].fields[i] != b[index].fields[i]) {
+                print(io::out, format("  {0}: {1} vs {2}\n",
+                            checksum_field_name(static_cast<ChecksumField>(i)),
+                            hex(a[index].fields[i], 8), hex(b[index].fields[i], 8)));
+            }
+        }
+
+        // Run both again, dumping every checksummed value at that cycle, and find the first
+        // value which differs.
+        extra.push_back(linked_ptr<String>(new String(format("--dump-at={0}", tick))));
+        extra.push_back(linked_ptr<String>(new String(format("--dump={0}", dump_a))));
+        extra[0].reset(new String(format("--checksums={0}", sums_a)));
+        run_replay(binary_a, replay, objects, extra);
+        extra[0].reset(new String(format("--checksums={0}", sums_b)));
+        extra[2].reset(new String(format("--dump={0}", dump_b)));
+        run_replay(binary_b, replay, objects, extra);
+
+        vector<linked_ptr<String> > lines_a;
+        vector<linked_ptr<String> > lines_b;
+        read_dump(dump_a, &lines_a);
+        read_dump(dump_b, &lines_b);
+        for (size_t i = 0; i < std::max(lines_a.size(), lines_b.size()); ++i) {
+            if (i >= lines_a.size()) {
+                print(io::out, format("  only in b: {0}\n", *lines_b[i]));
+                break;
+            } else if (i >= lines_b.size()) {
+                print(io::out, format("  only in a: {0}\n", *lines_a[i]));
+                break;
+            } else if (*lines_a[i] != *lines_b[i]) {
+                print(io::out, format("  a: {0}\n  b: {1}\n", *lines_a[i], *lines_b[i]));
+                break;
+            }
+        }
+        result = 1;
+    }
+
+    remove_if_present(sums_a);
+    remove_if_present(sums_b);
+    remove_if_present(dump_a);
+    remove_if_present(dump_b);
+    rmdir(dir_template);
+    return result;
+}
+
+}  // namespace
+}  // namespace antares
+
+int main(int argc, char* const* argv) {
+    return antares::main(argc, argv);
+}
@@ -17,46 +17,40 @@
 // License along with this program.  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <sys/time.h>
+#include <algorithm>
 #include <sfz/sfz.hpp>
 #include <getopt.h>
 
 #include "config/ledger.hpp"
 #include "config/preferences.hpp"
-#include "data/replay.hpp"
-#include "drawing/color.hpp"
-#include "drawing/offscreen-gworld.hpp"
-#include "drawing/pix-map.hpp"
-#include "drawing/text.hpp"
-#include "game/admiral.hpp"
-#include "game/cheat.hpp"
-#include "game/cursor.hpp"
+#include "game/checksum.hpp"
 #include "game/globals.hpp"
-#include "game/input-source.hpp"
-#include "game/instruments.hpp"
-#include "game/labels.hpp"
 #include "game/main.hpp"
-#include "game/messages.hpp"
-#include "game/motion.hpp"
+#include "game/profiler.hpp"
 #include "game/scenario-maker.hpp"
-#include "math/random.hpp"
-#include "math/rotation.hpp"
+#include "game/snapshot.hpp"
+#include "game/space-object.hpp"
 #include "sound/driver.hpp"
-#include "sound/music.hpp"
 #include "ui/card.hpp"
-#include "ui/interface-handling.hpp"
+#include "ui/flows/replay-master.hpp"
 #include "video/driver.hpp"
+#include "video/frame-stream.hpp"
 #include "video/offscreen-driver.hpp"
 
-using sfz::BytesSlice;
 using sfz::MappedFile;
 using sfz::Optional;
 using sfz::String;
 using sfz::StringSlice;
 using sfz::args::store;
+using sfz::args::store_const;
+using sfz::dec;
 using sfz::format;
+using sfz::hex;
 using sfz::make_linked_ptr;
 using sfz::mkdir;
 using sfz::scoped_ptr;
+using std::max;
 namespace args = sfz::args;
 namespace io = sfz::io;
 namespace path = sfz::path;
@@ -64,81 +58,6 @@ namespace utf8 = sfz::utf8;
 
 namespace antares {
 
-class ReplayMaster : public Card {
-  public:
-    ReplayMaster(BytesSlice data):
-            _state(NEW),
-            _replay_data(data),
-            _random_seed(_replay_data.global_seed),
-            _game_result(NO_GAME) { }
-
-    virtual void become_front() {
-        switch (_state) {
-          case NEW:
-            _state = REPLAY;
-            init();
-            Randomize(4);  // For the decision to replay intro.
-            _game_result = NO_GAME;
-            gRandomSeed = _random_seed;
-            globals()->gInputSource.reset(new ReplayInputSource(&_replay_data));
-            stack()->push(new MainPlay(
-                        GetScenarioPtrFromChapter(_replay_data.chapter_id), true, &_game_result));
-            break;
-
-          case REPLAY:
-            stack()->pop(this);
-            break;
-        }
-    }
-
-  private:
-    void init();
-
-    enum State {
-        NEW,
-        REPLAY,
-    };
-    State _state;
-
-    ReplayData _replay_data;
-    const int32_t _random_seed;
-    GameResult _game_result;
-
-    DISALLOW_COPY_AND_ASSIGN(ReplayMaster);
-};
-
-void ReplayMaster::init() {
-    init_globals();
-
-    SoundDriver::driver()->set_global_volume(8);  // Max volume.
-
-    world = Rect(Point(0, 0), Preferences::preferences()->screen_size());
-    play_screen = Rect(
-        world.left + kLeftPanelWidth, world.top,
-        world.right - kRightPanelWidth, world.bottom);
-    viewport = play_screen;
-
-    gRealWorld = new ArrayPixMap(world.width(), world.height());
-    gRealWorld->fill(RgbColor::kBlack);
-    CreateOffscreenWorld();
-    InitSpriteCursor();
-    RotationInit();
-    InterfaceHandlingInit();
-    InitDirectText();
-    ScreenLabelInit();
-    InitMessageScreen();
-    InstrumentInit();
-    SpriteHandlingInit();
-    AresCheatInit();
-    ScenarioMakerInit();
-    SpaceObjectHandlingInit();  // MUST be after ScenarioMakerInit()
-    InitSoundFX();
-    MusicInit();
-    InitMotion();
-    AdmiralInit();
-    InitBeams();
-}
-
 void demo(OffscreenVideoDriver& driver) {
 }
 
@@ -146,6 +65,23 @@ void space_race(OffscreenVideoDriver& driver) {
     demo(driver);  // 2:50
 }
 
+int64_t wall_usecs() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (tv.tv_sec * 1000000ll) + tv.tv_usec;
+}
+
+const char* game_result_name(GameResult result) {
+    switch (result) {
+      case NO_GAME:         return "none";
+      case LOSE_GAME:       return "lose";
+      case WIN_GAME:        return "win";
+      case RESTART_GAME:    return "restart";
+      case QUIT_GAME:       return "quit";
+    }
+    return "unknown";
+}
+
 void usage(StringSlice program_name) {
     print(io::err, format("usage: {0} replay_path output_dir\n", program_name));
     exit(1);
@@ -173,6 +109,45 @@ void main(int argc, char** argv) {
     parser.add_argument("-h", "--height", store(height))
         .help("screen height (default: 480)");
 
+    Optional<String> video_path;
+    String video_format("y4m");
+    parser.add_argument("--video", store(video_path))
+        .help("also write the screenshots as one video stream to this file (- for stdout)");
+    parser.add_argument("--video-format", store(video_format))
+        .help("y4m or rgba (default: y4m)");
+
+    bool simulate_only = false;
+    parser.add_argument("-s", "--simulate-only", store_const(simulate_only, true))
+        .help("only run the simulation, and print the outcome");
+
+    int objects = kMaxSpaceObject;
+    parser.add_argument("--objects", store(objects))
+        .help("maximum number of space objects (default: 250)");
+
+    Optional<String> profile_path;
+    Optional<String> flamegraph_path;
+    parser.add_argument("--profile", store(profile_path))
+        .help("write the time spent in each phase of each cycle to this CSV file");
+    parser.add_argument("--flamegraph", store(flamegraph_path))
+        .help("write the total time spent in each phase to this file, as folded stacks");
+
+    int rewind_at = -1;
+    int rewind_to = -1;
+    parser.add_argument("--rewind-at", store(rewind_at))
+        .help("when the game reaches this tick, wind it back to --rewind-to and play on");
+    parser.add_argument("--rewind-to", store(rewind_to))
+        .help("tick to wind back to; play resumes from the last snapshot at or before it");
+
+    Optional<String> checksums_path;
+    Optional<String> dump_path;
+    int dump_at = -1;
+    parser.add_argument("--checksums", store(checksums_path))
+        .help("write checksums of the game state at each decide cycle to this file");
+    parser.add_argument("--dump", store(dump_path))
+        .help("with --checksums and --dump-at, write the checksummed state to this file");
+    parser.add_argument("--dump-at", store(dump_at))
+        .help("tick at which to write the state given by --dump");
+
     parser.add_argument("--help", help(parser, 0))
         .help("display this help screen");
 
@@ -181,7 +156,39 @@ void main(int argc, char** argv) {
         print(io::err, format("{0}: {1}\n", parser.name(), error));
         exit(1);
     }
+    if ((objects < kMaxSpaceObject) || (objects > kSpaceObjectLimit)) {
+        print(io::err, format("{0}: --objects must be between {1} and {2}\n",
+                    parser.name(), dec(kMaxSpaceObject, 0), dec(kSpaceObjectLimit, 0)));
+        exit(1);
+    }
+    gMaxSpaceObject = objects;
+    if ((rewind_at < 0) != (rewind_to < 0)) {
+        print(io::err, format("{0}: --rewind-at and --rewind-to go together\n", parser.name()));
+        exit(1);
+    }
+    if ((dump_path.has() || (dump_at >= 0))
+            && !(dump_path.has() && (dump_at >= 0) && checksums_path.has())) {
+        print(io::err, format("{0}: --dump and --dump-at go together, with --checksums\n",
+                    parser.name()));
+        exit(1);
+    }
+    if (checksums_path.has() && (rewind_at >= 0)) {
+        // Winding back would repeat ticks in the stream.
+        print(io::err, format("{0}: --checksums can't be used with --rewind-at\n", parser.name()));
+        exit(1);
+    }
 
+    if (simulate_only && (output_dir.has() || video_path.has())) {
+        print(io::err, format("{0}: --simulate-only produces no output\n", parser.name()));
+        exit(1);
+    }
+    FrameStream::Format frame_format = FrameStream::Y4M;
+    if (video_format == "rgba") {
+        frame_format = FrameStream::RGBA;
+    } else if (video_format != "y4m") {
+        print(io::err, format("{0}: --video-format must be y4m or rgba\n", parser.name()));
+        exit(1);
+    }
     if (output_dir.has()) {
         makedirs(*output_dir, 0755);
     }
@@ -195,8 +202,15 @@ void main(int argc, char** argv) {
                 Preferences::preferences()->screen_size(), output_dir));
     video->schedule_event(make_linked_ptr(new MouseMoveEvent(0, Point(320, 240))));
     // TODO(sfiera): add recurring snapshots to OffscreenVideoDriver.
-    for (int64_t i = 1; i < 72000; i += interval) {
-        video->schedule_snapshot(i);
+    if (!simulate_only) {
+        for (int64_t i = 1; i < 72000; i += interval) {
+            video->schedule_snapshot(i);
+        }
+    }
+    if (video_path.has()) {
+        // One frame per screenshot, so the stream runs at 60 / interval frames per second.
+        video->set_frame_stream(new FrameStream(
+                    *video_path, frame_format, Size(width, height), 60, interval));
     }
     VideoDriver::set_driver(video.release());
 
@@ -208,8 +222,56 @@ void main(int argc, char** argv) {
     }
     Ledger::set_ledger(new NullLedger);
 
+    if (profile_path.has() || flamegraph_path.has()) {
+        Profiler::set_enabled(true);
+    }
+
+    // One snapshot per second of game time, with a keyframe every 16, for up to 20 minutes.
+    scoped_ptr<SnapshotRing> snapshots;
+    if (rewind_at >= 0) {
+        snapshots.reset(new SnapshotRing(60, 16, 1200));
+        snapshots->schedule_seek(rewind_at, rewind_to);
+        SnapshotRing::set_ring(snapshots.get());
+    }
+
+    scoped_ptr<ChecksumLog> checksums;
+    if (checksums_path.has()) {
+        checksums.reset(new ChecksumLog(*checksums_path));
+        if (dump_path.has()) {
+            checksums->schedule_dump(dump_at, *dump_path);
+        }
+        ChecksumLog::set_log(checksums.get());
+    }
+
     MappedFile replay_file(replay_path);
-    VideoDriver::driver()->loop(new ReplayMaster(replay_file.data()));
+    GameResult game_result = NO_GAME;
+    const int64_t start = wall_usecs();
+    VideoDriver::driver()->loop(new ReplayMaster(replay_file.data(), simulate_only, &game_result));
+    const int64_t usecs = wall_usecs() - start;
+
+    if (simulate_only) {
+        const int64_t ticks = globals()->gGameTime;
+        print(io::out, format("ticks: {0}\n", dec(ticks, 0)));
+        print(io::out, format("synch: {0}\n", hex(globals()->gSynchValue, 8)));
+        print(io::out, format("result: {0}\n", game_result_name(game_result)));
+        print(io::out, format("winner: {0}\n", dec(globals()->gScenarioWinner.player, 0)));
+        print(io::out, format("ticks/sec: {0}\n",
+                    dec((ticks * 1000000) / max<int64_t>(usecs, 1), 0)));
+        print(io::out, format("load usecs: {0}\n", dec(ScenarioLoadNsecs() / 1000, 0)));
+        print(io::out, format("dropped actions: {0}\n", dec(DroppedActionCount(), 0)));
+        if (snapshots.get() != NULL) {
+            print(io::out, format("snapshots: {0} in {1} bytes\n",
+                        dec(snapshots->size(), 0), dec(snapshots->bytes(), 0)));
+        }
+    }
+    SnapshotRing::set_ring(NULL);
+    ChecksumLog::set_log(NULL);
+    if (profile_path.has()) {
+        Profiler::write_csv(*profile_path);
+    }
+    if (flamegraph_path.has()) {
+        Profiler::write_folded(*flamegraph_path);
+    }
 }
 
 }  // namespace antares
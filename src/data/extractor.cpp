@@ -26,6 +26,7 @@
 #include <zipxx/zipxx.hpp>
 
 #include "data/replay.hpp"
+#include "data/resource-pack.hpp"
 #include "net/http.hpp"
 
 using rezin::AppleDouble;
@@ -113,7 +114,7 @@ bool convert_nlrp(int16_t id, BytesSlice data, WriteTarget out) {
         keys = new_keys;
     }
 
-    write(out, replay);
+    write_compact(out, replay);
     return true;
 }
 
@@ -216,7 +217,7 @@ const ResourceFile::ExtractedResource kPluginFiles[] = {
 
 const char kFactoryScenario[] = "com.biggerplanet.ares";
 const char kDownloadBase[] = "http://downloads.arescentral.org";
-const char kVersion[] = "3\n";
+const char kVersion[] = "5\n";
 
 const char kPluginVersionFile[] = "data/version";
 const char kPluginVersion[] = "1\n";
@@ -312,6 +313,7 @@ void DataExtractor::extract_factory_scenario(Observer* observer) const {
         extract_original(observer, "Ares-1.2.0.zip");
         extract_supplemental(observer, "Antares-Music-0.3.0.zip");
         extract_supplemental(observer, "Antares-Text-0.3.0.zip");
+        write_resource_pack(scenario_dir);
         write_version(kFactoryScenario);
     }
 }
@@ -321,6 +323,7 @@ void DataExtractor::extract_plugin_scenario(Observer* observer) const {
         String scenario_dir(format("{0}/{1}", _output_dir, _scenario));
         rmtree(scenario_dir);
         extract_plugin(observer);
+        write_resource_pack(scenario_dir);
         write_version(_scenario);
     }
 }
@@ -21,6 +21,8 @@
 
 #include <sfz/sfz.hpp>
 
+using sfz::Bytes;
+using sfz::BytesSlice;
 using sfz::Exception;
 using sfz::ReadSource;
 using sfz::WriteTarget;
@@ -28,14 +30,72 @@ using sfz::format;
 using sfz::range;
 using sfz::read;
 using sfz::write;
+using std::vector;
 
 namespace antares {
 
+namespace {
+
+// Compact replays start with this; replays in the original format start with a chapter number,
+// the high byte of which is always zero.
+const uint8_t kCompactMagic[] = {'N', 'L', 'R', '2'};
+const size_t kCompactMagicSize = sizeof(kCompactMagic);
+
+// The number of bits of each compact item's varint which give its type.
+const int kCompactTypeBits = 2;
+
+void write_varint(WriteTarget out, uint64_t value) {
+    while (value >= 0x80) {
+        write<uint8_t>(out, (value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    write<uint8_t>(out, value);
+}
+
+uint64_t read_varint(BytesSlice* in) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (in->empty()) {
+            break;
+        }
+        const uint8_t byte = in->at(0);
+        in->shift(1);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    throw Exception("invalid varint in replay");
+}
+
+// Applies `item` to the elapsed ticks and held keys of a replay.
+void apply_item(const ReplayData::Item& item, uint32_t* ticks, uint64_t* keys_down) {
+    switch (item.type) {
+      case ReplayData::Item::WAIT:
+        *ticks += item.data.wait;
+        break;
+      case ReplayData::Item::KEY_DOWN:
+        *keys_down |= (1ull << item.data.key_down);
+        break;
+      case ReplayData::Item::KEY_UP:
+        *keys_down &= ~(1ull << item.data.key_up);
+        break;
+    }
+}
+
+}  // namespace
+
 ReplayData::ReplayData() {
 }
 
 ReplayData::ReplayData(sfz::BytesSlice in) {
-    read(in, *this);
+    ReplayReader reader(in);
+    chapter_id = reader.chapter_id();
+    global_seed = reader.global_seed();
+    Item item;
+    while (reader.next(&item)) {
+        items.push_back(item);
+    }
 }
 
 void ReplayData::wait(uint32_t ticks) {
@@ -114,4 +174,146 @@ void write_to(WriteTarget out, const ReplayData::Item& item) {
     }
 }
 
+void write_compact(WriteTarget out, const ReplayData& replay) {
+    Bytes items;
+    Bytes index;
+    uint32_t ticks = 0;
+    uint64_t keys_down = 0;
+    uint32_t last_ticks = 0;
+    size_t last_offset = 0;
+    size_t keyframes = 0;
+    for (size_t i = 0; i < replay.items.size(); ++i) {
+        const ReplayData::Item& item = replay.items[i];
+        if ((i > 0) && ((i % kReplayKeyframeInterval) == 0)) {
+            write_varint(index, ticks - last_ticks);
+            write_varint(index, items.size() - last_offset);
+            write_varint(index, keys_down);
+            last_ticks = ticks;
+            last_offset = items.size();
+            ++keyframes;
+        }
+
+        uint64_t value = 0;
+        switch (item.type) {
+          case ReplayData::Item::WAIT:
+            value = item.data.wait;
+            break;
+          case ReplayData::Item::KEY_DOWN:
+            value = item.data.key_down;
+            break;
+          case ReplayData::Item::KEY_UP:
+            value = item.data.key_up;
+            break;
+        }
+        if ((item.type != ReplayData::Item::WAIT) && (value >= 64)) {
+            throw Exception(format("key {0} out of range for a compact replay", value));
+        }
+        write_varint(items, (value << kCompactTypeBits) | item.type);
+        apply_item(item, &ticks, &keys_down);
+    }
+
+    write(out, kCompactMagic, kCompactMagicSize);
+    write_varint(out, static_cast<uint32_t>(replay.chapter_id));
+    write(out, replay.global_seed);
+    write_varint(out, keyframes);
+    write(out, index);
+    write(out, items);
+}
+
+ReplayReader::ReplayReader(BytesSlice data):
+        _compact(false) {
+    if ((data.size() >= kCompactMagicSize)
+            && (data.slice(0, kCompactMagicSize) == BytesSlice(kCompactMagic, kCompactMagicSize))) {
+        _compact = true;
+        data.shift(kCompactMagicSize);
+        _chapter_id = read_varint(&data);
+        read(data, _global_seed);
+        const uint64_t keyframes = read_varint(&data);
+        Keyframe keyframe = {0, 0, 0};
+        for (uint64_t i = 0; i < keyframes; ++i) {
+            keyframe.ticks += read_varint(&data);
+            keyframe.offset += read_varint(&data);
+            keyframe.keys_down = read_varint(&data);
+            _index.push_back(keyframe);
+        }
+    } else {
+        read(data, _chapter_id);
+        read(data, _global_seed);
+        const uint32_t item_count = read<uint32_t>(data);
+
+        // Items are read one at a time, so find where the stored number of them ends, and ignore
+        // anything after that, as read_from() does.
+        BytesSlice rest(data);
+        ReplayData::Item item;
+        for (uint32_t i = 0; i < item_count; ++i) {
+            read(rest, item);
+        }
+        data = data.slice(0, data.size() - rest.size());
+    }
+    _items = data;
+    _rest = data;
+}
+
+bool ReplayReader::next(ReplayData::Item* item) {
+    if (_rest.empty()) {
+        return false;
+    }
+    if (_compact) {
+        const uint64_t token = read_varint(&_rest);
+        const uint64_t value = token >> kCompactTypeBits;
+        switch (token & ((1 << kCompactTypeBits) - 1)) {
+          case ReplayData::Item::WAIT:
+            item->type = ReplayData::Item::WAIT;
+            item->data.wait = value;
+            break;
+          case ReplayData::Item::KEY_DOWN:
+            item->type = ReplayData::Item::KEY_DOWN;
+            item->data.key_down = value;
+            break;
+          case ReplayData::Item::KEY_UP:
+            item->type = ReplayData::Item::KEY_UP;
+            item->data.key_up = value;
+            break;
+          default:
+            throw Exception(format("Illegal replay item type {0}", token & 0x3));
+        }
+    } else {
+        read(_rest, *item);
+    }
+    return true;
+}
+
+void ReplayReader::set_position(size_t position) {
+    if (position > _items.size()) {
+        throw Exception("replay position out of range");
+    }
+    _rest = _items.slice(position);
+}
+
+uint32_t ReplayReader::seek(uint32_t ticks, uint64_t* keys_down) {
+    uint32_t elapsed = 0;
+    *keys_down = 0;
+    set_position(0);
+    for (vector<Keyframe>::const_iterator it = _index.begin(); it != _index.end(); ++it) {
+        if (it->ticks > ticks) {
+            break;
+        }
+        elapsed = it->ticks;
+        *keys_down = it->keys_down;
+        set_position(it->offset);
+    }
+
+    ReplayData::Item item;
+    size_t before = position();
+    while (next(&item)) {
+        if ((item.type == ReplayData::Item::WAIT) && ((elapsed + item.data.wait) > ticks)) {
+            set_position(before);
+            break;
+        }
+        apply_item(item, &elapsed, keys_down);
+        before = position();
+    }
+    return elapsed;
+}
+
 }  // namespace antares
@@ -0,0 +1,285 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "data/resource-pack.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+using sfz::Bytes;
+using sfz::BytesSlice;
+using sfz::CString;
+using sfz::Exception;
+using sfz::MappedFile;
+using sfz::Rune;
+using sfz::ScopedFd;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::format;
+using sfz::linked_ptr;
+using sfz::quote;
+using sfz::write;
+using std::vector;
+
+namespace utf8 = sfz::utf8;
+
+namespace antares {
+
+const char kResourcePackName[] = "resources.pack";
+
+namespace {
+
+const uint8_t kMagic[] = {'A', 'R', 'P', 'K'};
+const uint32_t kPackVersion = 2;
+const size_t kHeaderSize = 12;
+const size_t kIndexEntrySize = 16;
+const size_t kPageSize = 4096;
+
+// Top-level directories which other code finds files in by globbing, rather than as resources.
+// They aren't packed, so that their files stay where that code looks.
+const char* const kLooseDirs[] = {"replays", "scenario-info"};
+const size_t kLooseDirCount = sizeof(kLooseDirs) / sizeof(kLooseDirs[0]);
+
+uint32_t get_u32(const uint8_t* data) {
+    return (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+size_t page_align(size_t offset) {
+    return (offset + kPageSize - 1) & ~(kPageSize - 1);
+}
+
+bool is_dir(const StringSlice& path) {
+    struct stat st;
+    return (stat(CString(path).data(), &st) == 0) && S_ISDIR(st.st_mode);
+}
+
+// Resources were once looked up on HFS+, which ignores case, so packs do too.  Paths are folded to
+// lower case both when packing and when looking up.  Only ASCII letters are folded; resource paths
+// don't use any others.
+String fold_case(const StringSlice& path) {
+    String result;
+    for (size_t i = 0; i < path.size(); ++i) {
+        const Rune r = path.at(i);
+        result.append(1, ((r >= 'A') && (r <= 'Z')) ? (r - 'A' + 'a') : r);
+    }
+    return result;
+}
+
+struct PackEntry {
+    String path;    // as found on disk.
+    String key;     // as looked up.
+};
+
+bool key_less(const linked_ptr<PackEntry>& a, const linked_ptr<PackEntry>& b) {
+    return StringSlice(a->key) < StringSlice(b->key);
+}
+
+bool is_loose_dir(const StringSlice& name) {
+    for (size_t i = 0; i < kLooseDirCount; ++i) {
+        if (name == kLooseDirs[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Appends to `paths` the path, relative to `root`, of each file under `root/prefix`, and to `dirs`
+// the path of each directory under it, parents before children.
+void list_files(
+        const StringSlice& root, const StringSlice& prefix, vector<linked_ptr<String> >* paths,
+        vector<linked_ptr<String> >* dirs) {
+    String dir(root);
+    if (!prefix.empty()) {
+        dir.assign(format("{0}/{1}", root, prefix));
+    }
+    DIR* d = opendir(CString(dir).data());
+    if (d == NULL) {
+        throw Exception(format("{0}: couldn't open directory", dir));
+    }
+    const String tmp_name(format("{0}.tmp", kResourcePackName));
+    while (dirent* entry = readdir(d)) {
+        const String name(utf8::decode(entry->d_name));
+        if ((name == ".") || (name == "..")
+                || (prefix.empty()
+                    && ((name == kResourcePackName) || (name == tmp_name)
+                        || is_loose_dir(name)))) {
+            continue;
+        }
+        linked_ptr<String> path(new String(name));
+        if (!prefix.empty()) {
+            path->assign(format("{0}/{1}", prefix, name));
+        }
+        if (is_dir(format("{0}/{1}", root, *path))) {
+            dirs->push_back(path);
+            list_files(root, *path, paths, dirs);
+        } else {
+            paths->push_back(path);
+        }
+    }
+    closedir(d);
+}
+
+}  // namespace
+
+ResourcePack::ResourcePack(const StringSlice& path)
+        : _file(path) {
+    const BytesSlice data = _file.data();
+    if ((data.size() < kHeaderSize)
+            || (data.slice(0, sizeof(kMagic)) != BytesSlice(kMagic, sizeof(kMagic)))
+            || (get_u32(data.data() + 4) != kPackVersion)) {
+        throw Exception(format("{0}: not a resource pack", quote(path)));
+    }
+    _count = get_u32(data.data() + 8);
+    const size_t strings_start = kHeaderSize + (_count * kIndexEntrySize);
+    if (strings_start > data.size()) {
+        throw Exception(format("{0}: truncated resource pack", quote(path)));
+    }
+    _index = data.data() + kHeaderSize;
+    _strings = data.slice(strings_start);
+
+    // Check every entry up front, so that find() can trust them.
+    for (uint32_t i = 0; i < _count; ++i) {
+        const uint8_t* entry = _index + (i * kIndexEntrySize);
+        if ((get_u32(entry) + static_cast<uint64_t>(get_u32(entry + 4)) > _strings.size())
+                || (get_u32(entry + 8) + static_cast<uint64_t>(get_u32(entry + 12))
+                    > data.size())) {
+            throw Exception(format("{0}: corrupt resource pack", quote(path)));
+        }
+    }
+}
+
+bool ResourcePack::is_current(const StringSlice& path) {
+    uint8_t header[kHeaderSize];
+    ScopedFd fd(open(path, O_RDONLY));
+    return (::read(fd.get(), header, kHeaderSize) == ssize_t(kHeaderSize))
+        && (memcmp(header, kMagic, sizeof(kMagic)) == 0)
+        && (get_u32(header + 4) == kPackVersion);
+}
+
+bool ResourcePack::find(const StringSlice& resource_path, BytesSlice* data) const {
+    const Bytes key(utf8::encode(fold_case(resource_path)));
+    size_t lo = 0;
+    size_t hi = _count;
+    while (lo < hi) {
+        const size_t mid = lo + ((hi - lo) / 2);
+        const uint8_t* entry = _index + (mid * kIndexEntrySize);
+        const BytesSlice name = _strings.slice(get_u32(entry), get_u32(entry + 4));
+        const int cmp = memcmp(name.data(), key.data(), std::min(name.size(), key.size()));
+        if ((cmp < 0) || ((cmp == 0) && (name.size() < key.size()))) {
+            lo = mid + 1;
+        } else if ((cmp > 0) || (name.size() > key.size())) {
+            hi = mid;
+        } else {
+            *data = _file.data().slice(get_u32(entry + 8), get_u32(entry + 12));
+            return true;
+        }
+    }
+    return false;
+}
+
+void write_resource_pack(const StringSlice& dir) {
+    // Keys sort the same way by code point as by their UTF-8 bytes, which is the order find()
+    // searches in.
+    vector<linked_ptr<String> > paths;
+    vector<linked_ptr<String> > dirs;
+    list_files(dir, "", &paths, &dirs);
+    vector<linked_ptr<PackEntry> > entries;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        linked_ptr<PackEntry> entry(new PackEntry);
+        entry->path.assign(*paths[i]);
+        entry->key.assign(fold_case(*paths[i]));
+        entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(), key_less);
+    for (size_t i = 1; i < entries.size(); ++i) {
+        if (entries[i - 1]->key == entries[i]->key) {
+            throw Exception(format("{0} and {1} differ only in case",
+                        quote(entries[i - 1]->path), quote(entries[i]->path)));
+        }
+    }
+
+    Bytes strings;
+    vector<uint32_t> string_offsets;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        string_offsets.push_back(strings.size());
+        strings.push(utf8::encode(entries[i]->key));
+    }
+    string_offsets.push_back(strings.size());
+
+    vector<linked_ptr<MappedFile> > files;
+    Bytes head;
+    head.push(BytesSlice(kMagic, sizeof(kMagic)));
+    write<uint32_t>(head, kPackVersion);
+    write<uint32_t>(head, entries.size());
+    size_t offset = page_align(kHeaderSize + (entries.size() * kIndexEntrySize) + strings.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        files.push_back(linked_ptr<MappedFile>(
+                    new MappedFile(format("{0}/{1}", dir, entries[i]->path))));
+        const size_t size = files.back()->data().size();
+        write<uint32_t>(head, string_offsets[i]);
+        write<uint32_t>(head, string_offsets[i + 1] - string_offsets[i]);
+        write<uint32_t>(head, offset);
+        write<uint32_t>(head, size);
+        offset = page_align(offset + size);
+    }
+    head.push(strings);
+
+    // Write to a temporary file and rename it into place, so that a pack is never seen half
+    // written.
+    const String path(format("{0}/{1}", dir, kResourcePackName));
+    const String tmp_path(format("{0}.tmp", path));
+    {
+        ScopedFd fd(open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644));
+        size_t written = head.size();
+        write(fd, head);
+        for (size_t i = 0; i < files.size(); ++i) {
+            Bytes padding;
+            padding.push(page_align(written) - written, 0);
+            write(fd, padding);
+            write(fd, files[i]->data());
+            written = page_align(written) + files[i]->data().size();
+        }
+    }
+    files.clear();
+    if (rename(CString(tmp_path).data(), CString(path).data()) != 0) {
+        throw Exception(format("{0}: couldn't rename", quote(tmp_path)));
+    }
+
+    // The pack replaces the files in it.  Directories are removed children first, and only once
+    // they are empty.
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const String file_path(format("{0}/{1}", dir, entries[i]->path));
+        if (unlink(CString(file_path).data()) != 0) {
+            throw Exception(format("{0}: couldn't remove", quote(file_path)));
+        }
+    }
+    for (size_t i = dirs.size(); i > 0; --i) {
+        const String dir_path(format("{0}/{1}", dir, *dirs[i - 1]));
+        rmdir(CString(dir_path).data());
+    }
+}
+
+}  // namespace antares
@@ -20,8 +20,11 @@
 #include "data/resource.hpp"
 
 #include <stdio.h>
+#include <vector>
 #include <sfz/sfz.hpp>
 #include "config/preferences.hpp"
+#include "data/resource-pack.hpp"
+#include "lang/threads.hpp"
 
 using sfz::BytesSlice;
 using sfz::Exception;
@@ -29,6 +32,9 @@ using sfz::MappedFile;
 using sfz::String;
 using sfz::StringSlice;
 using sfz::format;
+using sfz::linked_ptr;
+using sfz::scoped_ptr;
+using std::vector;
 
 namespace path = sfz::path;
 namespace utf8 = sfz::utf8;
@@ -39,6 +45,53 @@ namespace {
 
 const char kAres[] = "com.biggerplanet.ares";
 
+struct ScenarioPack {
+    String dir;
+    scoped_ptr<ResourcePack> pack;
+};
+
+// The pack for each scenario directory looked in so far.  Each is opened the first time it is
+// needed, and kept for the life of the process; `pack` is NULL if the directory has no pack, or
+// only one written by an older version, which is ignored in favor of the loose files.
+// Resources may be loaded from several threads at once, so `scenario_packs_mutex` guards the list.
+vector<linked_ptr<ScenarioPack> > scenario_packs;
+pthread_mutex_t scenario_packs_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+const ResourcePack* pack_for(const StringSlice& dir) {
+    MutexLock lock(&scenario_packs_mutex);
+    for (size_t i = 0; i < scenario_packs.size(); ++i) {
+        if (scenario_packs[i]->dir == dir) {
+            return scenario_packs[i]->pack.get();
+        }
+    }
+    linked_ptr<ScenarioPack> entry(new ScenarioPack);
+    entry->dir.assign(dir);
+    const String pack_path(format("{0}/{1}", dir, kResourcePackName));
+    if (path::isfile(pack_path) && ResourcePack::is_current(pack_path)) {
+        entry->pack.reset(new ResourcePack(pack_path));
+    }
+    scenario_packs.push_back(entry);
+    return entry->pack.get();
+}
+
+// Looks for `resource_path` in the scenario directory `dir`: first in its pack, if it has one,
+// and then as a loose file, such as a replay, or a file added since the pack was written.
+bool find_resource(
+        const StringSlice& dir, const StringSlice& resource_path,
+        scoped_ptr<MappedFile>* file, BytesSlice* data) {
+    const ResourcePack* pack = pack_for(dir);
+    if (pack && pack->find(resource_path, data)) {
+        return true;
+    }
+    const String p(format("{0}/{1}", dir, resource_path));
+    if (path::isfile(p)) {
+        file->reset(new MappedFile(p));
+        *data = (*file)->data();
+        return true;
+    }
+    return false;
+}
+
 }  // namespace
 
 Resource::Resource(const StringSlice& type, const StringSlice& extension, int id) {
@@ -54,26 +107,23 @@ Resource::Resource(const sfz::PrintItem& resource_path) {
 Resource::~Resource() { }
 
 BytesSlice Resource::data() const {
-    return _file->data();
+    return _data;
 }
 
 void Resource::init(const sfz::StringSlice& resource_path) {
     const StringSlice scenario_id = Preferences::preferences()->scenario_identifier();
     const String home(utf8::decode(getenv("HOME")));
     const String base(format("{0}/Library/Application Support/Antares/Scenarios", home));
-    String p;
 
     if (scenario_id != kAres) {
-        p.assign(format("{0}/{1}/{2}", base, scenario_id, resource_path));
-        if (path::isfile(p)) {
-            _file.reset(new MappedFile(p));
+        const String plugin_dir(format("{0}/{1}", base, scenario_id));
+        if (find_resource(plugin_dir, resource_path, &_file, &_data)) {
             return;
         }
     }
 
-    p.assign(format("{0}/{1}/{2}", base, kAres, resource_path));
-    if (path::isfile(p)) {
-        _file.reset(new MappedFile(p));
+    const String factory_dir(format("{0}/{1}", base, kAres));
+    if (find_resource(factory_dir, resource_path, &_file, &_data)) {
         return;
     }
 
@@ -346,7 +346,7 @@ void Briefing_Objects_Render(
 
     objectNum = 1;  // extra 1 for last null briefingSpriteBounds
 
-    for ( count = 0; count < kMaxSpaceObject; count++)
+    for ( count = 0; count < gMaxSpaceObject; count++)
     {
         if (( anObject->active == kObjectInUse) && ( anObject->sprite != NULL))
         {
@@ -359,7 +359,7 @@ void Briefing_Objects_Render(
     if ( gBriefingSpriteBounds == NULL) return;
     sBounds = gBriefingSpriteBounds;
 
-    for ( count = 0; count < kMaxSpaceObject; count++)
+    for ( count = 0; count < gMaxSpaceObject; count++)
     {
         if (( anObject->active == kObjectInUse) && ( anObject->sprite != NULL))
         {
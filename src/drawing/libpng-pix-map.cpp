@@ -44,6 +44,43 @@ void png_write_data(png_struct* png, png_byte* data, png_size_t length) {
 
 void png_flush_data(png_struct*) { }
 
+// Writes a PNG of `size`, reading each row `stride` bytes after the one before.  Pixels are in
+// A, R, G, B order if `argb`, and R, G, B, A order otherwise.
+void write_png(WriteTarget out, const Size& size, const uint8_t* rows, size_t stride, bool argb) {
+    png_struct* png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (!png) {
+        throw Exception("couldn't create png_struct");
+    }
+
+    png_info* info = png_create_info_struct(png);
+    if (!info) {
+        png_destroy_write_struct(&png, NULL);
+        throw Exception("couldn't create png_info");
+    }
+
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        throw Exception("reading png failed");
+    }
+
+    png_set_write_fn(png, &out, png_write_data, png_flush_data);
+    png_set_IHDR(
+            png, info, size.width, size.height, 8, PNG_COLOR_TYPE_RGBA, NULL,
+            NULL, NULL);
+    if (argb) {
+        png_set_swap_alpha(png);
+    }
+
+    png_write_info(png, info);
+    for (int i = 0; i < size.height; ++i) {
+        png_write_row(png, const_cast<uint8_t*>(rows + (i * stride)));
+    }
+
+    png_write_end(png, NULL);
+
+    png_destroy_write_struct(&png, &info);
+}
+
 }  // namespace
 
 void read_from(ReadSource in, ArrayPixMap& pix) {
@@ -113,36 +150,13 @@ void read_from(ReadSource in, ArrayPixMap& pix) {
 }
 
 void write_to(WriteTarget out, const PixMap& pix) {
-    png_struct* png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-    if (!png) {
-        throw Exception("couldn't create png_struct");
-    }
-
-    png_info* info = png_create_info_struct(png);
-    if (!info) {
-        png_destroy_write_struct(&png, NULL);
-        throw Exception("couldn't create png_info");
-    }
-
-    if (setjmp(png_jmpbuf(png))) {
-        png_destroy_write_struct(&png, &info);
-        throw Exception("reading png failed");
-    }
-
-    png_set_write_fn(png, &out, png_write_data, png_flush_data);
-    png_set_IHDR(
-            png, info, pix.size().width, pix.size().height, 8, PNG_COLOR_TYPE_RGBA, NULL,
-            NULL, NULL);
-    png_set_swap_alpha(png);
-
-    png_write_info(png, info);
-    for (int i = 0; i < pix.size().height; ++i) {
-        png_write_row(png, const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(pix.row(i))));
-    }
-
-    png_write_end(png, NULL);
+    write_png(
+            out, pix.size(), reinterpret_cast<const uint8_t*>(pix.bytes()),
+            pix.row_bytes() * sizeof(RgbColor), true);
+}
 
-    png_destroy_write_struct(&png, &info);
+void write_rgba_png(WriteTarget out, const Size& size, const uint8_t* rgba) {
+    write_png(out, size, rgba, size.width * 4, false);
 }
 
 }  // namespace antares
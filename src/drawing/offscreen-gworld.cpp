@@ -26,7 +26,7 @@
 namespace antares {
 
 PixMap*         gOffWorld;
-PixMap*         gRealWorld;
+TrackedPixMap*  gRealWorld;
 
 void CreateOffscreenWorld() {
     const Size size = gRealWorld->size();
@@ -32,6 +32,13 @@ using sfz::write;
 
 namespace antares {
 
+namespace {
+
+// The width and height of the tiles that TrackedPixMap keeps track of changes in.
+const int32_t kTrackedTileSize = 32;
+
+}  // namespace
+
 PixMap::~PixMap() { }
 
 const RgbColor* PixMap::row(int y) const {
@@ -42,12 +49,32 @@ RgbColor* PixMap::mutable_row(int y) {
     return mutable_bytes() + y * row_bytes();
 }
 
+RgbColor* PixMap::mutable_region(const Rect& bounds) {
+    return mutable_bytes() + bounds.top * row_bytes() + bounds.left;
+}
+
 const RgbColor& PixMap::get(int x, int y) const {
     return row(y)[x];
 }
 
 void PixMap::set(int x, int y, const RgbColor& color) {
-    mutable_row(y)[x] = color;
+    *mutable_region(Rect(x, y, x + 1, y + 1)) = color;
+}
+
+void PixMap::set_points(const Point* points, size_t count, const RgbColor& color) {
+    if (count == 0) {
+        return;
+    }
+    Rect bounds(points[0].h, points[0].v, points[0].h + 1, points[0].v + 1);
+    for (size_t i = 1; i < count; ++i) {
+        bounds.enlarge_to(Rect(points[i].h, points[i].v, points[i].h + 1, points[i].v + 1));
+    }
+    RgbColor* base = mutable_region(bounds);
+    const int32_t stride = row_bytes();
+    for (size_t i = 0; i < count; ++i) {
+        const Point& p = points[i];
+        base[((p.v - bounds.top) * stride) + (p.h - bounds.left)] = color;
+    }
 }
 
 void PixMap::fill(const RgbColor& color) {
@@ -133,6 +160,63 @@ void ArrayPixMap::swap(ArrayPixMap& other) {
     swap(_bytes, other._bytes);
 }
 
+TrackedPixMap::TrackedPixMap(int32_t width, int32_t height)
+        : ArrayPixMap(width, height),
+          _tiles(
+                  (width + kTrackedTileSize - 1) / kTrackedTileSize,
+                  (height + kTrackedTileSize - 1) / kTrackedTileSize),
+          _changed(new bool[_tiles.width * _tiles.height]) {
+    std::fill(_changed.get(), _changed.get() + (_tiles.width * _tiles.height), true);
+}
+
+RgbColor* TrackedPixMap::mutable_bytes() {
+    mark(size().as_rect());
+    return ArrayPixMap::mutable_bytes();
+}
+
+RgbColor* TrackedPixMap::mutable_region(const Rect& bounds) {
+    mark(bounds);
+    return ArrayPixMap::mutable_bytes() + bounds.top * row_bytes() + bounds.left;
+}
+
+void TrackedPixMap::mark(const Rect& bounds) {
+    if (bounds.empty()) {
+        return;
+    }
+    const int32_t left = bounds.left / kTrackedTileSize;
+    const int32_t top = bounds.top / kTrackedTileSize;
+    const int32_t right = (bounds.right + kTrackedTileSize - 1) / kTrackedTileSize;
+    const int32_t bottom = (bounds.bottom + kTrackedTileSize - 1) / kTrackedTileSize;
+    for (int32_t y = top; y < bottom; ++y) {
+        bool* row = _changed.get() + y * _tiles.width;
+        std::fill(row + left, row + right, true);
+    }
+}
+
+void TrackedPixMap::take_changes(std::vector<Rect>* changes) {
+    // Each run of changed tiles in a row of tiles becomes one rect.
+    for (int32_t y = 0; y < _tiles.height; ++y) {
+        bool* row = _changed.get() + y * _tiles.width;
+        int32_t x = 0;
+        while (x < _tiles.width) {
+            if (!row[x]) {
+                ++x;
+                continue;
+            }
+            const int32_t start = x;
+            while ((x < _tiles.width) && row[x]) {
+                row[x] = false;
+                ++x;
+            }
+            Rect change(
+                    start * kTrackedTileSize, y * kTrackedTileSize,
+                    x * kTrackedTileSize, (y + 1) * kTrackedTileSize);
+            change.clip_to(size().as_rect());
+            changes->push_back(change);
+        }
+    }
+}
+
 PixMap::View::View(PixMap* pix, const Rect& bounds)
         : _parent(pix),
           _offset(bounds.origin()),
@@ -158,7 +242,13 @@ const RgbColor* PixMap::View::bytes() const {
 }
 
 RgbColor* PixMap::View::mutable_bytes() {
-    return _parent->mutable_bytes() + _offset.v * row_bytes() + _offset.h;
+    return _parent->mutable_region(Rect(_offset, _size));
+}
+
+RgbColor* PixMap::View::mutable_region(const Rect& bounds) {
+    Rect parent_bounds = bounds;
+    parent_bounds.offset(_offset.h, _offset.v);
+    return _parent->mutable_region(parent_bounds);
 }
 
 PixMap::View PixMap::view(const Rect& bounds) {
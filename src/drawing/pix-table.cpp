@@ -26,35 +26,111 @@
 #include "video/driver.hpp"
 
 using sfz::BytesSlice;
-using sfz::ReadSource;
 using sfz::format;
-using sfz::range;
+using sfz::linked_ptr;
 using sfz::read;
-using sfz::scoped_ptr;
 
 namespace antares {
 
-NatePixTable::NatePixTable(int id, uint8_t color) {
+namespace {
+
+// Fills `palette` with the color of each index in a sprite of the given coloring, for sprites
+// whose pixels are recolored where they have some bit of `color_mask` set.
+void make_palette(uint8_t color, uint8_t color_mask, RgbColor* palette) {
+    palette[0] = RgbColor::kClear;
+    for (int i = 1; i < 256; ++i) {
+        uint8_t byte = i;
+        if (color && (byte & color_mask)) {
+            byte = (byte & 0x0F) | (color << 4);
+        }
+        palette[i] = RgbColor::at(byte);
+    }
+}
+
+}  // namespace
+
+IndexedPixTable::IndexedPixTable(int id)
+        : _id(id) {
     Resource rsrc("sprites", "SMIV", id);
     BytesSlice in(rsrc.data());
 
     in.shift(4);
-    _size = read<uint32_t>(in);
+    const uint32_t size = read<uint32_t>(in);
 
     std::vector<uint32_t> offsets;
-    for (size_t i = 0; i < _size; ++i) {
+    for (size_t i = 0; i < size; ++i) {
         offsets.push_back(read<uint32_t>(in));
     }
 
-    _entries.reset(new Frame[_size]);
-    for (size_t i = 0; i < _size; ++i) {
+    _frames.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        Frame& frame = _frames[i];
         BytesSlice entry_data(rsrc.data().slice(offsets[i]));
-        _entries[i].build(entry_data, id, i, color);
+        read(entry_data, frame.width);
+        read(entry_data, frame.height);
+        read(entry_data, frame.h_offset);
+        read(entry_data, frame.v_offset);
+        const BytesSlice pixels = entry_data.slice(0, frame.width * frame.height);
+        frame.offset = _pixels.size();
+        _pixels.push(pixels);
+
+        // If more than 1/3 of the opaque pixels in this frame are in the 'white' band of the
+        // color table, then colorize all opaque (non-0x00) pixels.  Otherwise, only colorize
+        // pixels which are opaque and outside of the white band (which is 0x01..0x0F).
+        int white_count = 0;
+        int pixel_count = 0;
+        for (size_t j = 0; j < pixels.size(); ++j) {
+            const uint8_t byte = pixels.at(j);
+            if (byte) {
+                ++pixel_count;
+                if (byte <= 15) {
+                    ++white_count;
+                }
+            }
+        }
+        frame.color_mask = (white_count > (pixel_count / 3)) ? 0xFF : 0xF0;
     }
 }
 
+IndexedPixTable::~IndexedPixTable() { }
+
+NatePixTable::NatePixTable(int id, uint8_t color)
+        : _indexed(new IndexedPixTable(id)),
+          _color(color),
+          _size(0) {
+    build();
+    create_sprites();
+}
+
+NatePixTable::NatePixTable(const linked_ptr<const IndexedPixTable>& indexed, uint8_t color)
+        : _indexed(indexed),
+          _color(color),
+          _size(0) { }
+
 NatePixTable::~NatePixTable() { }
 
+void NatePixTable::build() {
+    // One palette for frames which are colored entirely, and one for those which keep their
+    // white pixels.
+    RgbColor all_palette[256];
+    RgbColor non_white_palette[256];
+    make_palette(_color, 0xFF, all_palette);
+    make_palette(_color, 0xF0, non_white_palette);
+
+    _size = _indexed->size();
+    _entries.reset(new Frame[_size]);
+    for (size_t i = 0; i < _size; ++i) {
+        const bool all = (_indexed->at(i).color_mask == 0xFF);
+        _entries[i].build(*_indexed, i, all ? all_palette : non_white_palette);
+    }
+}
+
+void NatePixTable::create_sprites() {
+    for (size_t i = 0; i < _size; ++i) {
+        _entries[i].create_sprite(_indexed->id(), i);
+    }
+}
+
 const NatePixTable::Frame& NatePixTable::at(size_t index) const {
     return _entries[index];
 }
@@ -78,65 +154,30 @@ Point NatePixTable::Frame::center() const { return Point(_h_offset, _v_offset);
 const PixMap& NatePixTable::Frame::pix_map() const { return _pix_map; }
 const Sprite& NatePixTable::Frame::sprite() const { return *_sprite; }
 
-void NatePixTable::Frame::build(BytesSlice in, int32_t id, int32_t frame_number, uint8_t color) {
-    read(in, _width);
-    read(in, _height);
-    read(in, _h_offset);
-    read(in, _v_offset);
-    in = in.slice(0, _width * _height);
+void NatePixTable::Frame::build(
+        const IndexedPixTable& indexed, int32_t frame_number, const RgbColor* palette) {
+    const IndexedPixTable::Frame& frame = indexed.at(frame_number);
+    _width = frame.width;
+    _height = frame.height;
+    _h_offset = frame.h_offset;
+    _v_offset = frame.v_offset;
 
+    // Map each index through the palette, a row at a time.  The loop has no branches, so that it
+    // stays tight however many of the pixels are clear.
     _pix_map.resize(Size(_width, _height));
-    _pix_map.fill(RgbColor::kClear);
-    if (color) {
-        colorize_pix_map(in, color);
-    } else {
-        fill_pix_map(in);
-    }
-    _sprite.reset(VideoDriver::driver()->new_sprite(
-                format("/sprites/{0}.SMIV/{1}", id, frame_number), _pix_map));
-}
-
-void NatePixTable::Frame::fill_pix_map(BytesSlice bytes) {
-    SFZ_FOREACH(uint16_t y, range(_height), {
-        SFZ_FOREACH(uint16_t x, range(_width), {
-            uint8_t byte = read<uint8_t>(bytes);
-            if (byte) {
-                _pix_map.set(x, y, RgbColor::at(byte));
-            }
-        });
-    });
-}
-
-void NatePixTable::Frame::colorize_pix_map(BytesSlice bytes, uint8_t color) {
-    color <<= 4;
-
-    // count the # of pixels, and # of pixels that are white
-    int white_count = 0;
-    int pixel_count = 0;
-    SFZ_FOREACH(uint8_t byte, bytes, {
-        if (byte) {
-            ++pixel_count;
-            if (byte <= 15) {
-                ++white_count;
-            }
-        }
-    });
-
-    // If more than 1/3 of the opaque pixels in this sprite are in the 'white' band of the
-    // color table, then colorize all opaque (non-0x00) pixels.  Otherwise, only colorize
-    // pixels which are opaque and outside of the white band (which is 0x01..0x0F).
-    const uint8_t color_mask = (white_count > (pixel_count / 3)) ? 0xFF : 0xF0;
+    const uint8_t* in = indexed.pixels(frame);
     for (int y = 0; y < _height; ++y) {
+        RgbColor* out = _pix_map.mutable_row(y);
         for (int x = 0; x < _width; ++x) {
-            uint8_t byte = read<uint8_t>(bytes);
-            if (byte & color_mask) {
-                byte = (byte & 0x0F) | color;
-                _pix_map.set(x, y, RgbColor::at(byte));
-            } else if (byte) {
-                _pix_map.set(x, y, RgbColor::at(byte));
-            }
+            out[x] = palette[in[x]];
         }
+        in += _width;
     }
 }
 
+void NatePixTable::Frame::create_sprite(int32_t id, int32_t frame_number) {
+    _sprite.reset(VideoDriver::driver()->new_packed_sprite(
+                format("/sprites/{0}.SMIV/{1}", id, frame_number), _pix_map));
+}
+
 }  // namespace antares
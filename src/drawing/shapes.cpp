@@ -728,7 +728,8 @@ void DrawNateLine(
 
     // Point to the bitmap address first pixel to draw
     drowPlus = destPix->row_bytes();
-    dbyte = destPix->mutable_bytes() + YStart * drowPlus + XStart;
+    const Rect lineBounds(std::min(XStart, XEnd), YStart, std::max(XStart, XEnd) + 1, YEnd + 1);
+    dbyte = destPix->mutable_region(lineBounds) + (XStart - lineBounds.left);
 
     // Figure out whether we're going left or right, and how far we're
     // going horizontally
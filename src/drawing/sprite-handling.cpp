@@ -19,30 +19,44 @@
 
 #include "drawing/sprite-handling.hpp"
 
+#include <algorithm>
+#include <map>
 #include <numeric>
+#include <vector>
 
 #include "drawing/color.hpp"
 #include "drawing/offscreen-gworld.hpp"
 #include "drawing/pix-table.hpp"
 #include "drawing/shapes.hpp"
 #include "drawing/text.hpp"
+#include "game/free-slots.hpp"
 #include "game/globals.hpp"
+#include "game/snapshot.hpp"
+#include "game/space-object.hpp"
+#include "lang/threads.hpp"
 #include "math/random.hpp"
 #include "math/rotation.hpp"
 #include "video/driver.hpp"
 
+using sfz::Bytes;
+using sfz::BytesSlice;
 using sfz::Exception;
 using sfz::Range;
 using sfz::format;
+using sfz::linked_ptr;
+using sfz::make_linked_ptr;
 using sfz::range;
 using sfz::scoped_array;
 using sfz::scoped_ptr;
 using std::accumulate;
+using std::map;
+using std::vector;
 
 namespace antares {
 
 namespace {
 
+// The number of sprites when gMaxSpaceObject is at its default; the table grows in proportion.
 const size_t kMaxSpriteNum = 500;
 
 const size_t kMinVolatilePixTable = 1;  // sound 0 is always there; 1+ is volatile
@@ -56,11 +70,51 @@ const uint32_t kFramedSquareBlip    = 0x00000040;
 const uint32_t kBlipSizeMask        = 0x0000000f;
 const uint32_t kBlipTypeMask        = 0x000000f0;
 
+bool is_drawn_layer(int layer) {
+    return (kFirstSpriteLayer <= layer) && (layer <= kLastSpriteLayer);
+}
+
 template <typename T>
 void zero(T* t) {
     *t = T();
 }
 
+// A set of sprite slots, iterated in slot order.
+class SpriteList {
+  public:
+    void reset(size_t capacity) {
+        _words.assign((capacity + kWordBits - 1) / kWordBits, 0);
+    }
+
+    void add(int32_t slot) {
+        _words[slot / kWordBits] |= uint64_t(1) << (slot % kWordBits);
+    }
+
+    void remove(int32_t slot) {
+        _words[slot / kWordBits] &= ~(uint64_t(1) << (slot % kWordBits));
+    }
+
+    // @returns             the lowest slot in the list which is at least `slot`, or -1.
+    int32_t next(int32_t slot) const {
+        size_t w = slot / kWordBits;
+        if (w >= _words.size()) {
+            return -1;
+        }
+        uint64_t bits = _words[w] & (~uint64_t(0) << (slot % kWordBits));
+        while (bits == 0) {
+            if (++w == _words.size()) {
+                return -1;
+            }
+            bits = _words[w];
+        }
+        return (w * kWordBits) + __builtin_ctzll(bits);
+    }
+
+  private:
+    static const int kWordBits = 64;
+    vector<uint64_t> _words;
+};
+
 template <typename T>
 Range<T*> slice(T* array, size_t start, size_t end) {
     return Range<T*>(array + start, array + end);
@@ -78,6 +132,12 @@ pixTableType gPixTable[kMaxPixTableEntry];
 
 int32_t gAbsoluteScale = MIN_SCALE;
 scoped_array<spriteType> gSpriteTable;
+size_t gSpriteCapacity = kMaxSpriteNum;
+FreeSlots gFreeSprites;
+
+// The live sprites in each layer, kept up to date by AddSprite(), RemoveSprite(), and
+// SetSpriteLayer(), so that draw_sprites() need not look at the rest of the table.
+SpriteList gLayerSprites[kLastSpriteLayer + 1];
 const RgbColor& kNoTinyColor = RgbColor::kBlack;
 
 const int32_t kStaticTableSize = 4000;
@@ -86,13 +146,23 @@ const int32_t kStaticTileHeight = 16;
 const int32_t kStaticTileCount = 61;
 Sprite** gStaticTiles;
 
+// Rasterized triangle, plus, and diamond blips, keyed by shape, width, and color.  There are only
+// a few dozen of each, so once they have all been seen, drawing blips allocates nothing.  They are
+// kept until the sprites are next reset.  Like gStaticTiles, the cache itself is never destroyed,
+// since the video driver is gone by the time static destructors run.
+map<uint64_t, linked_ptr<Sprite> >* gBlipCache;
+
 bool PixelInSprite_IsOutside(
         const PixMap& pix, long x, long y, const int32_t* hmap, const int32_t* vmap);
 
 void SpriteHandlingInit() {
     ResetAllPixTables();
 
-    gSpriteTable.reset(new spriteType[kMaxSpriteNum]);
+    gSpriteCapacity = (kMaxSpriteNum * gMaxSpaceObject) / kMaxSpaceObject;
+    gSpriteTable.reset(new spriteType[gSpriteCapacity]);
+    if (gBlipCache == NULL) {
+        gBlipCache = new map<uint64_t, linked_ptr<Sprite> >;
+    }
     ResetAllSprites();
 
     uint8_t static_table[kStaticTableSize];
@@ -110,7 +180,7 @@ void SpriteHandlingInit() {
                 static_index = (static_index + 223) % 3989;
             });
         });
-        *tile = VideoDriver::driver()->new_sprite("/x/static", pix);
+        *tile = VideoDriver::driver()->new_persistent_sprite("/x/static", pix);
     });
 }
 
@@ -124,9 +194,33 @@ spriteType::spriteType()
           killMe(false) { }
 
 void ResetAllSprites() {
-    SFZ_FOREACH(int i, range(kMaxSpriteNum), {
+    SFZ_FOREACH(int i, range(gSpriteCapacity), {
         zero(&gSpriteTable[i]);
     });
+    gFreeSprites.reset(gSpriteCapacity);
+    SFZ_FOREACH(int layer, range<int>(kLastSpriteLayer + 1), {
+        gLayerSprites[layer].reset(gSpriteCapacity);
+    });
+    gBlipCache->clear();
+}
+
+void SaveSprites(Bytes* out) {
+    save_raw(out, gSpriteTable.get(), gSpriteCapacity);
+    gFreeSprites.save(out);
+}
+
+void RestoreSprites(BytesSlice* in) {
+    restore_raw(in, gSpriteTable.get(), gSpriteCapacity);
+    gFreeSprites.restore(in);
+    SFZ_FOREACH(int layer, range<int>(kLastSpriteLayer + 1), {
+        gLayerSprites[layer].reset(gSpriteCapacity);
+    });
+    SFZ_FOREACH(int i, range(gSpriteCapacity), {
+        const spriteType& sprite = gSpriteTable[i];
+        if ((sprite.table != NULL) && is_drawn_layer(sprite.whichLayer)) {
+            gLayerSprites[sprite.whichLayer].add(i);
+        }
+    });
 }
 
 void ResetAllPixTables() {
@@ -165,6 +259,46 @@ void RemoveAllUnusedPixTables() {
     });
 }
 
+namespace {
+
+// If another coloring of the same sprites is loaded, AddPixTable() shares its decoded frames rather
+// than reading and decoding them again.
+const NatePixTable* GetAnyColoring(int16_t real_resource_id) {
+    SFZ_FOREACH(const pixTableType* entry, range(gPixTable, gPixTable + kMaxPixTableEntry), {
+        if ((entry->resource.get() != NULL)
+                && ((entry->resID & ~kSpriteTableColorIDMask) == real_resource_id)) {
+            return entry->resource.get();
+        }
+    });
+    return NULL;
+}
+
+pixTableType* GetFreePixTable() {
+    SFZ_FOREACH(pixTableType* entry, range(gPixTable, gPixTable + kMaxPixTableEntry), {
+        if ((entry->resource.get() == NULL) && (entry->resID == -1)) {
+            return entry;
+        }
+    });
+    throw Exception("Can't manage any more sprite tables");
+}
+
+struct DecodeWork {
+    vector<int16_t> ids;
+    vector<linked_ptr<const IndexedPixTable> > tables;
+};
+
+void DecodeIndexedPixTable(void* arg, size_t index) {
+    DecodeWork* work = reinterpret_cast<DecodeWork*>(arg);
+    work->tables[index].reset(new IndexedPixTable(work->ids[index]));
+}
+
+void BuildPixTable(void* arg, size_t index) {
+    vector<pixTableType*>* entries = reinterpret_cast<vector<pixTableType*>*>(arg);
+    (*entries)[index]->resource->build();
+}
+
+}  // namespace
+
 NatePixTable* AddPixTable(int16_t resource_id) {
     NatePixTable* result = GetPixTable(resource_id);
     if (result != NULL) {
@@ -173,15 +307,69 @@ NatePixTable* AddPixTable(int16_t resource_id) {
 
     int16_t real_resource_id = resource_id & ~kSpriteTableColorIDMask;
     int16_t color = (resource_id & kSpriteTableColorIDMask) >> kSpriteTableColorShift;
-    SFZ_FOREACH(pixTableType* entry, range(gPixTable, gPixTable + kMaxPixTableEntry), {
-        if (entry->resource.get() == NULL) {
-            entry->resID = resource_id;
-            entry->resource.reset(new NatePixTable(real_resource_id, color));
-            return entry->resource.get();
+
+    const NatePixTable* same_sprites = GetAnyColoring(real_resource_id);
+    pixTableType* entry = GetFreePixTable();
+    if (same_sprites != NULL) {
+        entry->resource.reset(new NatePixTable(same_sprites->indexed(), color));
+        entry->resource->build();
+        entry->resource->create_sprites();
+    } else {
+        entry->resource.reset(new NatePixTable(real_resource_id, color));
+    }
+    entry->resID = resource_id;
+    return entry->resource.get();
+}
+
+void AddPixTables(const vector<int16_t>& resource_ids) {
+    // Give each table not yet loaded a slot, in the order asked for, and note each SMIV which
+    // isn't already decoded for some other coloring.
+    vector<int16_t> added_ids;
+    vector<pixTableType*> entries;
+    DecodeWork decode;
+    for (size_t i = 0; i < resource_ids.size(); ++i) {
+        const int16_t resource_id = resource_ids[i];
+        if ((GetPixTable(resource_id) != NULL)
+                || (std::find(added_ids.begin(), added_ids.end(), resource_id)
+                    != added_ids.end())) {
+            continue;
         }
-    });
+        pixTableType* entry = GetFreePixTable();
+        entry->resID = resource_id;
+        added_ids.push_back(resource_id);
+        entries.push_back(entry);
+
+        const int16_t real_resource_id = resource_id & ~kSpriteTableColorIDMask;
+        if ((GetAnyColoring(real_resource_id) == NULL)
+                && (std::find(decode.ids.begin(), decode.ids.end(), real_resource_id)
+                    == decode.ids.end())) {
+            decode.ids.push_back(real_resource_id);
+        }
+    }
 
-    throw Exception("Can't manage any more sprite tables");
+    // Read and decode the SMIVs, then color the frames, each step on all processors.
+    // linked_ptrs can't be shared between threads, so they are copied here in between.
+    decode.tables.resize(decode.ids.size());
+    ParallelFor(decode.ids.size(), DecodeIndexedPixTable, &decode);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const int16_t resource_id = entries[i]->resID;
+        const int16_t real_resource_id = resource_id & ~kSpriteTableColorIDMask;
+        const int16_t color = (resource_id & kSpriteTableColorIDMask) >> kSpriteTableColorShift;
+        const NatePixTable* same_sprites = GetAnyColoring(real_resource_id);
+        if (same_sprites != NULL) {
+            entries[i]->resource.reset(new NatePixTable(same_sprites->indexed(), color));
+        } else {
+            const size_t j = std::find(decode.ids.begin(), decode.ids.end(), real_resource_id)
+                - decode.ids.begin();
+            entries[i]->resource.reset(new NatePixTable(decode.tables[j], color));
+        }
+    }
+    ParallelFor(entries.size(), BuildPixTable, &entries);
+
+    // The video driver is only safe to call from this thread.
+    for (size_t i = 0; i < entries.size(); ++i) {
+        entries[i]->resource->create_sprites();
+    }
 }
 
 NatePixTable* GetPixTable(int16_t resource_id) {
@@ -196,36 +384,55 @@ NatePixTable* GetPixTable(int16_t resource_id) {
 spriteType *AddSprite(
         Point where, NatePixTable* table, short resID, short whichShape, int32_t scale, long size,
         short layer, const RgbColor& color, long *whichSprite) {
-    SFZ_FOREACH(
-            spriteType* sprite, range(gSpriteTable.get(), gSpriteTable.get() + kMaxSpriteNum), {
-        if (sprite->table == NULL) {
-            *whichSprite = sprite - gSpriteTable.get();
-
-            sprite->where = where;
-            sprite->table = table;
-            sprite->resID = resID;
-            sprite->whichShape = whichShape;
-            sprite->scale = scale;
-            sprite->whichLayer = layer;
-            sprite->tinySize = size;
-            sprite->tinyColor = color;
-            sprite->killMe = false;
-            sprite->style = spriteNormal;
-            sprite->styleColor = RgbColor::kWhite;
-            sprite->styleData = 0;
-
-            return sprite;
-        }
-    });
+    const int32_t slot = gFreeSprites.first();
+    if (slot < 0) {
+        *whichSprite = kNoSprite;
+        return NULL;
+    }
+    gFreeSprites.acquire(slot);
+
+    spriteType* sprite = &gSpriteTable[slot];
+    *whichSprite = slot;
+
+    sprite->where = where;
+    sprite->table = table;
+    sprite->resID = resID;
+    sprite->whichShape = whichShape;
+    sprite->scale = scale;
+    sprite->whichLayer = layer;
+    sprite->tinySize = size;
+    sprite->tinyColor = color;
+    sprite->killMe = false;
+    sprite->style = spriteNormal;
+    sprite->styleColor = RgbColor::kWhite;
+    sprite->styleData = 0;
+    if ((table != NULL) && is_drawn_layer(layer)) {
+        gLayerSprites[layer].add(slot);
+    }
 
-    *whichSprite = kNoSprite;
-    return NULL;
+    return sprite;
 }
 
 void RemoveSprite(spriteType *aSprite) {
+    const int32_t slot = aSprite - gSpriteTable.get();
+    if ((aSprite->table != NULL) && is_drawn_layer(aSprite->whichLayer)) {
+        gLayerSprites[aSprite->whichLayer].remove(slot);
+    }
     aSprite->killMe = false;
     aSprite->table = NULL;
     aSprite->resID = -1;
+    gFreeSprites.release(slot);
+}
+
+void SetSpriteLayer(spriteType* sprite, short layer) {
+    const int32_t slot = sprite - gSpriteTable.get();
+    if ((sprite->table != NULL) && is_drawn_layer(sprite->whichLayer)) {
+        gLayerSprites[sprite->whichLayer].remove(slot);
+    }
+    sprite->whichLayer = layer;
+    if ((sprite->table != NULL) && is_drawn_layer(layer)) {
+        gLayerSprites[layer].add(slot);
+    }
 }
 
 namespace {
@@ -569,14 +776,48 @@ bool PixelInSprite_IsOutside(
     return false;
 }
 
+namespace {
+
+Sprite* blip_sprite(uint32_t type, int32_t width, const RgbColor& color) {
+    const uint64_t key = (uint64_t(type) << 40) | (uint64_t(width) << 32)
+        | (uint64_t(color.alpha) << 24) | (color.red << 16) | (color.green << 8) | color.blue;
+    map<uint64_t, linked_ptr<Sprite> >::const_iterator it = gBlipCache->find(key);
+    if (it != gBlipCache->end()) {
+        return it->second.get();
+    }
+
+    ArrayPixMap pix(width, width);
+    pix.fill(RgbColor::kClear);
+    const char* name = "";
+    switch (type) {
+      case kTriangleUpBlip:
+        DrawNateTriangleUpClipped(&pix, color);
+        name = "triangle";
+        break;
+      case kPlusBlip:
+        DrawNatePlusClipped(&pix, color);
+        name = "plus";
+        break;
+      case kDiamondBlip:
+        DrawNateDiamondClipped(&pix, color);
+        name = "diamond";
+        break;
+    }
+    Sprite* sprite = VideoDriver::driver()->new_packed_sprite(
+            format("/x/{0}/{1}: {2}", name, width, color), pix);
+    (*gBlipCache)[key] = make_linked_ptr(sprite);
+    return sprite;
+}
+
+}  // namespace
+
 void draw_sprites() {
     if (gAbsoluteScale >= kBlipThreshhold) {
         SFZ_FOREACH(int layer, range<int>(kFirstSpriteLayer, kLastSpriteLayer + 1), {
-            SFZ_FOREACH(int i, range(kMaxSpriteNum), {
+            const SpriteList& list = gLayerSprites[layer];
+            for (int32_t i = list.next(0); i >= 0; i = list.next(i + 1)) {
                 spriteType* aSprite = &gSpriteTable[i];
-                if ((aSprite->table != NULL)
-                        && !aSprite->killMe
-                        && (aSprite->whichLayer == layer)) {
+                if (!aSprite->killMe) {
                     int32_t trueScale = evil_scale_by(aSprite->scale, gAbsoluteScale);
                     const NatePixTable::Frame& frame = aSprite->table->at(aSprite->whichShape);
 
@@ -612,32 +853,27 @@ void draw_sprites() {
                         break;
                     }
                 }
-            });
+            }
         });
     } else {
         SFZ_FOREACH(int layer, range<int>(kFirstSpriteLayer, kLastSpriteLayer + 1), {
-            SFZ_FOREACH(int i, range(kMaxSpriteNum), {
+            const SpriteList& list = gLayerSprites[layer];
+            for (int32_t i = list.next(0); i >= 0; i = list.next(i + 1)) {
                 spriteType* aSprite = &gSpriteTable[i];
                 int tinySize = aSprite->tinySize & kBlipSizeMask;
-                if ((aSprite->table != NULL)
-                        && !aSprite->killMe
+                if (!aSprite->killMe
                         && (aSprite->tinyColor != kNoTinyColor)
-                        && tinySize
-                        && (aSprite->whichLayer == layer)) {
+                        && tinySize) {
                     Rect sprite_rect(
                             aSprite->where.h - tinySize, aSprite->where.v - tinySize,
                             aSprite->where.h + tinySize, aSprite->where.v + tinySize);
-                    switch (aSprite->tinySize & kBlipTypeMask) {
+                    const uint32_t type = aSprite->tinySize & kBlipTypeMask;
+                    switch (type) {
                       case kTriangleUpBlip:
-                        {
-                            ArrayPixMap pix(sprite_rect.width(), sprite_rect.height());
-                            pix.fill(RgbColor::kClear);
-                            DrawNateTriangleUpClipped(&pix, aSprite->tinyColor);
-                            scoped_ptr<Sprite> sprite(VideoDriver::driver()->new_sprite(
-                                    format("/x/triangle/{0}: {1}", sprite_rect.width(), aSprite->tinyColor),
-                                    pix));
-                            sprite->draw(sprite_rect.left, sprite_rect.top);
-                        }
+                      case kPlusBlip:
+                      case kDiamondBlip:
+                        blip_sprite(type, sprite_rect.width(), aSprite->tinyColor)
+                            ->draw(sprite_rect.left, sprite_rect.top);
                         break;
 
                       case kFramedSquareBlip:
@@ -645,35 +881,11 @@ void draw_sprites() {
                         VideoDriver::driver()->fill_rect(sprite_rect, aSprite->tinyColor);
                         break;
 
-                      case kPlusBlip:
-                        {
-                            ArrayPixMap pix(sprite_rect.width(), sprite_rect.height());
-                            pix.fill(RgbColor::kClear);
-                            DrawNatePlusClipped(&pix, aSprite->tinyColor);
-                            scoped_ptr<Sprite> sprite(VideoDriver::driver()->new_sprite(
-                                    format("/x/plus/{0}: {1}", sprite_rect.width(), aSprite->tinyColor),
-                                    pix));
-                            sprite->draw(sprite_rect.left, sprite_rect.top);
-                        }
-                        break;
-
-                      case kDiamondBlip:
-                        {
-                            ArrayPixMap pix(sprite_rect.width(), sprite_rect.height());
-                            pix.fill(RgbColor::kClear);
-                            DrawNateDiamondClipped(&pix, aSprite->tinyColor);
-                            scoped_ptr<Sprite> sprite(VideoDriver::driver()->new_sprite(
-                                    format("/x/diamond/{0}: {1}", sprite_rect.width(), aSprite->tinyColor),
-                                    pix));
-                            sprite->draw(sprite_rect.left, sprite_rect.top);
-                        }
-                        break;
-
                       default:
                         break;
                     }
                 }
-            });
+            }
         });
     }
 }
@@ -683,7 +895,7 @@ void draw_sprites() {
 // Asteroids before the player actually starts.
 
 void CullSprites() {
-    SFZ_FOREACH(int i, range(kMaxSpriteNum), {
+    SFZ_FOREACH(int i, range(gSpriteCapacity), {
         spriteType* aSprite = &gSpriteTable[i];
         if (aSprite->table != NULL) {
             if (aSprite->killMe) {
@@ -20,20 +20,19 @@
 #include "drawing/text.hpp"
 
 #include <algorithm>
+#include <utility>
 #include <sfz/sfz.hpp>
 
 #include "data/resource.hpp"
 #include "drawing/color.hpp"
+#include "drawing/pix-map.hpp"
 #include "game/globals.hpp"
-#include "video/driver.hpp"
 
 using sfz::Bytes;
 using sfz::BytesSlice;
 using sfz::Rune;
 using sfz::String;
 using sfz::StringSlice;
-using sfz::format;
-using sfz::hex;
 using sfz::read;
 using sfz::scoped_ptr;
 
@@ -58,16 +57,41 @@ enum {
     kButtonSmallFontResID   = 5005,
 };
 
-uint8_t to_mac_roman(Rune code) {
-    String string(1, code);
-    Bytes bytes(macroman::encode(string));
-    return bytes.at(0);
-}
+// Encodes characters as MacRoman without going through macroman::encode(), which builds a String
+// and a Bytes for each character.
+class MacRomanTable {
+  public:
+    MacRomanTable() {
+        for (int i = 0x80; i < 0x100; ++i) {
+            uint8_t byte = i;
+            String string(macroman::decode(BytesSlice(&byte, 1)));
+            _high[i - 0x80] = std::make_pair(string.at(0), byte);
+        }
+        std::sort(_high, _high + 0x80);
+    }
 
-Rune from_mac_roman(uint8_t byte) {
-    BytesSlice bytes(&byte, 1);
-    String string(macroman::decode(bytes));
-    return string.at(0);
+    uint8_t encode(Rune code) const {
+        if (code < 0x80) {
+            return code;
+        }
+        const std::pair<Rune, uint8_t>* it =
+            std::lower_bound(_high, _high + 0x80, std::make_pair(code, uint8_t(0)));
+        if ((it != _high + 0x80) && (it->first == code)) {
+            return it->second;
+        }
+        // Not in MacRoman; let the encoder decide what it becomes.
+        String string(1, code);
+        Bytes bytes(macroman::encode(string));
+        return bytes.at(0);
+    }
+
+  private:
+    std::pair<Rune, uint8_t> _high[0x80];
+};
+
+uint8_t to_mac_roman(Rune code) {
+    static const MacRomanTable table;
+    return table.encode(code);
 }
 
 }  // namespace
@@ -87,16 +111,9 @@ directTextType::directTextType(int32_t id) {
     Resource data_rsrc("font-bitmaps", "nlFM", resID);
     charSet.assign(data_rsrc.data());
 
-    if (VideoDriver::driver()) {
-        _sprites.reset(new scoped_ptr<Sprite>[256]);
-        for (int i = 0; i < 256; i++) {
-            ArrayPixMap pix(char_width(i), height + 1);
-            pix.fill(RgbColor::kClear);
-            String s(1, from_mac_roman(i));
-            draw(Point(0, ascent), s, RgbColor::kWhite, &pix, pix.size().as_rect());
-            _sprites[i].reset(VideoDriver::driver()->new_sprite(
-                        format("/font/{0}/{1}", id, hex(i, 2)), pix));
-        }
+    // Each character's bitmap is preceded by its width.
+    for (int i = 0; i < 256; ++i) {
+        _widths[i] = charSet.at((height * physicalWidth * i) + i);
     }
 }
 
@@ -105,6 +122,24 @@ directTextType::~directTextType() { }
 void directTextType::draw(
         Point origin, sfz::StringSlice string, RgbColor color, PixMap* pix,
         const Rect& clip) const {
+    // Encode and draw the string a chunk at a time, to avoid allocating.
+    uint8_t chunk[64];
+    for (size_t start = 0; start < string.size(); start += sizeof(chunk)) {
+        const size_t size = std::min(sizeof(chunk), string.size() - start);
+        for (size_t i = 0; i < size; ++i) {
+            chunk[i] = to_mac_roman(string.at(start + i));
+        }
+        draw_glyphs(origin, chunk, size, color, pix, clip);
+        for (size_t i = 0; i < size; ++i) {
+            origin.h += _widths[chunk[i]];
+        }
+    }
+    MoveTo(origin.h, origin.v);
+}
+
+void directTextType::draw_glyphs(
+        Point origin, const uint8_t* text, size_t size, RgbColor color, PixMap* pix,
+        const Rect& clip) const {
     // move the pen to the resulting location
     origin.v -= ascent;
 
@@ -114,13 +149,24 @@ void directTextType::draw(
 
     int rowBytes = pix->row_bytes();
 
+    // Only the pixels covered by both the text and the clip rect are changed.
+    int32_t textWidth = 0;
+    for (size_t i = 0; i < size; ++i) {
+        textWidth += _widths[text[i]];
+    }
+    Rect changed(origin.h, origin.v + topEdge, origin.h + textWidth, origin.v + bottomEdge);
+    changed.clip_to(clip);
+    changed.clip_to(pix->size().as_rect());
+    if (changed.empty()) {
+        return;
+    }
+
     // set hchar = place holder for start of each char we draw
-    RgbColor* hchar = pix->mutable_bytes() + (origin.v + topEdge) * rowBytes + origin.h;
+    RgbColor* hchar = pix->mutable_region(changed)
+        + (origin.v + topEdge - changed.top) * rowBytes + (origin.h - changed.left);
 
-    for (size_t i = 0; i < string.size(); ++i) {
-        const uint8_t* sbyte = charSet.data()
-            + height * physicalWidth * to_mac_roman(string.at(i))
-            + to_mac_roman(string.at(i));
+    for (size_t i = 0; i < size; ++i) {
+        const uint8_t* sbyte = charSet.data() + height * physicalWidth * text[i] + text[i];
 
         int width = *sbyte;
         ++sbyte;
@@ -159,25 +205,6 @@ void directTextType::draw(
         // increase our hposition (our position in pixels)
         origin.h += width;
     }
-    MoveTo(origin.h, origin.v + ascent);
-}
-
-void directTextType::draw_sprite(Point origin, sfz::StringSlice string, RgbColor color) const {
-    // TODO(sfiera): using stencils is a rather inefficient way of doing
-    // this, compared to using GL colors to tint the sprite.  However,
-    // we already have the code to do it with stencils, and don't yet
-    // have tinting.  If we do (and we probably will) then we should
-    // switch to using that here instead.
-    Stencil stencil(VideoDriver::driver());
-    stencil.set_threshold(1);
-    origin.offset(0, -ascent);
-    for (size_t i = 0; i < string.size(); ++i) {
-        uint8_t byte = to_mac_roman(string.at(i));
-        _sprites[byte]->draw(origin.h, origin.v);
-        origin.offset(char_width(string.at(i)), 0);
-    }
-    stencil.apply();
-    VideoDriver::driver()->fill_rect(world, color);
 }
 
 void InitDirectText() {
@@ -198,9 +225,7 @@ void DirectTextCleanup() {
 }
 
 uint8_t directTextType::char_width(Rune mchar) const {
-    const uint8_t* widptr =
-        charSet.data() + height * physicalWidth * to_mac_roman(mchar) + to_mac_roman(mchar);
-    return *widptr;
+    return _widths[to_mac_roman(mchar)];
 }
 
 void mDirectCharWidth(unsigned char& width, uint32_t mchar) {
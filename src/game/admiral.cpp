@@ -23,6 +23,7 @@
 #include "data/string-list.hpp"
 #include "game/cheat.hpp"
 #include "game/globals.hpp"
+#include "game/snapshot.hpp"
 #include "game/space-object.hpp"
 #include "lang/casts.hpp"
 #include "math/macros.hpp"
@@ -31,6 +32,7 @@
 #include "sound/fx.hpp"
 
 using sfz::Bytes;
+using sfz::BytesSlice;
 using sfz::Exception;
 using sfz::String;
 using sfz::StringSlice;
@@ -58,6 +60,24 @@ const Fixed kAbsolutelyEssential        = 0x00008000;
 
 scoped_array<destBalanceType> gDestBalanceData;
 
+// admiralType and destBalanceType are plain data, apart from their names, which come last.  Save
+// the bytes up to the name as they are, and the name separately.
+template <typename T>
+void save_named(Bytes* out, const T& t) {
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(&t);
+    const uint8_t* name = reinterpret_cast<const uint8_t*>(&t.name);
+    out->push(BytesSlice(begin, name - begin));
+    save_string(out, t.name);
+}
+
+template <typename T>
+void restore_named(BytesSlice* in, T* t) {
+    uint8_t* begin = reinterpret_cast<uint8_t*>(t);
+    uint8_t* name = reinterpret_cast<uint8_t*>(&t->name);
+    restore_raw(in, begin, name - begin);
+    restore_string(in, &t->name);
+}
+
 }  // namespace
 
 void AdmiralInit() {
@@ -121,6 +141,24 @@ void ResetAllDestObjectData() {
     }
 }
 
+void SaveAdmirals(Bytes* out) {
+    for (int i = 0; i < kMaxPlayerNum; ++i) {
+        save_named(out, globals()->gAdmiralData[i]);
+    }
+    for (int i = 0; i < kMaxDestObject; ++i) {
+        save_named(out, gDestBalanceData[i]);
+    }
+}
+
+void RestoreAdmirals(BytesSlice* in) {
+    for (int i = 0; i < kMaxPlayerNum; ++i) {
+        restore_named(in, &globals()->gAdmiralData[i]);
+    }
+    for (int i = 0; i < kMaxDestObject; ++i) {
+        restore_named(in, &gDestBalanceData[i]);
+    }
+}
+
 destBalanceType* mGetDestObjectBalancePtr(long whichObject) {
     return gDestBalanceData.get() + whichObject;
 }
@@ -842,7 +880,7 @@ void AdmiralThink() {
                     // Really 48:
                     a->blitzkrieg = 0 - (RandomSeeded(1200, &gRandomSeed, 'adm1', -1) + 1200);
                     anObject = gSpaceObjectData.get();
-                    for (int j = 0; j < kMaxSpaceObject; j++) {
+                    for (int j = 0; j < gMaxSpaceObject; j++) {
                         if (anObject->owner == i) {
                             anObject->currentTargetValue = 0x00000000;
                         }
@@ -855,7 +893,7 @@ void AdmiralThink() {
                     // Really 48:
                     a->blitzkrieg = RandomSeeded(1200, &gRandomSeed, 'adm2', -1) + 1200;
                     anObject = gSpaceObjectData.get();
-                    for (int j = 0; j < kMaxSpaceObject; j++) {
+                    for (int j = 0; j < gMaxSpaceObject; j++) {
                         if (anObject->owner == i) {
                             anObject->currentTargetValue = 0x00000000;
                         }
@@ -1220,14 +1258,14 @@ void AdmiralThink() {
                                     if (baseObject->buildFlags & kSufficientEscortsExist) {
                                         anObject = gSpaceObjectData.get();
                                         int j = 0;
-                                        while (j < kMaxSpaceObject) {
+                                        while (j < gMaxSpaceObject) {
                                             if ((anObject->active)
                                                     && (anObject->owner == i)
                                                     && (anObject->whichBaseObject == baseNum)
                                                     && (anObject->escortStrength <
                                                         baseObject->friendDefecit)) {
                                                 a->hopeToBuild = -1;
-                                                j = kMaxSpaceObject;
+                                                j = gMaxSpaceObject;
                                             }
                                             j++;
                                             anObject++;
@@ -1237,7 +1275,7 @@ void AdmiralThink() {
                                     if (baseObject->buildFlags & kMatchingFoeExists) {
                                         thisValue = 0;
                                         anObject = gSpaceObjectData.get();
-                                        for (int j = 0; j < kMaxSpaceObject; j++) {
+                                        for (int j = 0; j < gMaxSpaceObject; j++) {
                                             if ((anObject->active)
                                                     && (anObject->owner != i)
                                                     && ((anObject->baseType->buildFlags
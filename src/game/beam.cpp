@@ -28,6 +28,7 @@
 #include "drawing/shapes.hpp"
 #include "game/globals.hpp"
 #include "game/motion.hpp"
+#include "game/snapshot.hpp"
 #include "game/space-object.hpp"
 #include "lang/casts.hpp"
 #include "math/random.hpp"
@@ -35,6 +36,8 @@
 #include "math/units.hpp"
 #include "video/driver.hpp"
 
+using sfz::Bytes;
+using sfz::BytesSlice;
 using sfz::range;
 using sfz::scoped_array;
 using std::abs;
@@ -87,6 +90,14 @@ void ResetBeams() {
     });
 }
 
+void SaveBeams(Bytes* out) {
+    save_raw(out, globals()->gBeamData.get(), kBeamNum);
+}
+
+void RestoreBeams(BytesSlice* in) {
+    restore_raw(in, globals()->gBeamData.get(), kBeamNum);
+}
+
 beamType *AddBeam(
         coordPointType* location, uint8_t color, beamKindType kind, int32_t accuracy,
         int32_t beam_range, int32_t* whichBeam) {
@@ -246,6 +257,7 @@ void update_beams() {
 void draw_beams() {
     Rect bounds = viewport;
 
+    PrimitiveBatch batch(VideoDriver::driver());
     beamType* const beams = globals()->gBeamData.get();
     SFZ_FOREACH(beamType* beam, range(beams, beams + kBeamNum), {
         if (beam->active) {
@@ -254,12 +266,12 @@ void draw_beams() {
                     if ((beam->beamKind == eBoltObjectToObjectKind)
                             || (beam->beamKind == eBoltObjectToRelativeCoordKind)) {
                         SFZ_FOREACH(int j, range(1, kBoltPointNum), {
-                            VideoDriver::driver()->draw_line(
+                            batch.draw_line(
                                     beam->thisBoltPoint[j-1], beam->thisBoltPoint[j],
                                     GetRGBTranslateColor(beam->color));
                         });
                     } else {
-                        VideoDriver::driver()->draw_line(
+                        batch.draw_line(
                                 Point(beam->thisLocation.left, beam->thisLocation.top),
                                 Point(beam->thisLocation.right, beam->thisLocation.bottom),
                                 GetRGBTranslateColor(beam->color));
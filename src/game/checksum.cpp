@@ -0,0 +1,211 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "game/checksum.hpp"
+
+#include <fcntl.h>
+#include <sfz/sfz.hpp>
+
+#include "data/space-object.hpp"
+#include "game/globals.hpp"
+#include "game/space-object.hpp"
+#include "math/random.hpp"
+
+using sfz::BytesSlice;
+using sfz::ReadSource;
+using sfz::ScopedFd;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::WriteTarget;
+using sfz::dec;
+using sfz::format;
+using sfz::print;
+using sfz::read;
+using sfz::write;
+using std::vector;
+
+namespace utf8 = sfz::utf8;
+
+namespace antares {
+
+namespace {
+
+const uint32_t kFnvOffsetBasis = 2166136261u;
+const uint32_t kFnvPrime = 16777619u;
+
+// Buffered checksums are written out once there are this many bytes of them.
+const size_t kChecksumFlushSize = 65536;
+
+const char* const kChecksumFieldNames[CHECKSUM_FIELD_COUNT] = {
+    "location",
+    "velocity",
+    "health",
+    "random",
+    "actions",
+};
+
+}  // namespace
+
+const char* checksum_field_name(ChecksumField field) {
+    return kChecksumFieldNames[field];
+}
+
+bool StateChecksum::operator==(const StateChecksum& other) const {
+    if (game_time != other.game_time) {
+        return false;
+    }
+    for (int i = 0; i < CHECKSUM_FIELD_COUNT; ++i) {
+        if (fields[i] != other.fields[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void read_from(ReadSource in, StateChecksum& checksum) {
+    read(in, checksum.game_time);
+    read(in, checksum.fields, CHECKSUM_FIELD_COUNT);
+}
+
+void write_to(WriteTarget out, const StateChecksum& checksum) {
+    write(out, checksum.game_time);
+    write(out, checksum.fields, CHECKSUM_FIELD_COUNT);
+}
+
+StateHash::StateHash(String* dump)
+        : _value(kFnvOffsetBasis),
+          _dump(dump) { }
+
+void StateHash::add(const char* table, int32_t index, const char* field, int64_t value) {
+    // Hash the value a byte at a time, least significant first, so that the result doesn't depend
+    // on the byte order of the machine.
+    uint64_t bits = value;
+    for (int i = 0; i < 8; ++i) {
+        _value = (_value ^ (bits & 0xff)) * kFnvPrime;
+        bits >>= 8;
+    }
+    if (_dump != NULL) {
+        print(*_dump, format("{0}\t{1}\t{2}\t{3}\n", table, dec(index, 0), field, dec(value, 0)));
+    }
+}
+
+void ComputeChecksum(StateChecksum* checksum, String* dump) {
+    StateHash location(dump);
+    StateHash velocity(dump);
+    StateHash health(dump);
+    StateHash random(dump);
+    StateHash actions(dump);
+
+    // The seed behind Random() is left out.  Only presentation code uses it: the starfield, bolt
+    // jitter, and radar static.  It advances differently when nothing is drawn, without changing
+    // the simulation.
+    random.add("random", 0, "gRandomSeed", gRandomSeed);
+    for (int32_t i = 0; i < gMaxSpaceObject; ++i) {
+        const spaceObjectType& o = gSpaceObjectData[i];
+        if (o.active == kObjectAvailable) {
+            continue;
+        }
+        location.add("object", i, "active", o.active);
+        location.add("object", i, "id", o.id);
+        location.add("object", i, "whichBaseObject", o.whichBaseObject);
+        location.add("object", i, "location.h", o.location.h);
+        location.add("object", i, "location.v", o.location.v);
+        location.add("object", i, "direction", o.direction);
+
+        velocity.add("object", i, "velocity.h", o.velocity.h);
+        velocity.add("object", i, "velocity.v", o.velocity.v);
+        velocity.add("object", i, "motionFraction.h", o.motionFraction.h);
+        velocity.add("object", i, "motionFraction.v", o.motionFraction.v);
+        velocity.add("object", i, "thrust", o.thrust);
+        velocity.add("object", i, "turnVelocity", o.turnVelocity);
+        velocity.add("object", i, "turnFraction", o.turnFraction);
+
+        health.add("object", i, "health", o.health);
+        health.add("object", i, "energy", o.energy);
+        health.add("object", i, "battery", o.battery);
+
+        random.add("object", i, "randomSeed", o.randomSeed);
+    }
+    HashActionQueue(&actions);
+
+    checksum->game_time = globals()->gGameTime;
+    checksum->fields[CHECKSUM_LOCATION] = location.value();
+    checksum->fields[CHECKSUM_VELOCITY] = velocity.value();
+    checksum->fields[CHECKSUM_HEALTH] = health.value();
+    checksum->fields[CHECKSUM_RANDOM] = random.value();
+    checksum->fields[CHECKSUM_ACTIONS] = actions.value();
+}
+
+ChecksumLog* ChecksumLog::_log = NULL;
+
+ChecksumLog::ChecksumLog(const StringSlice& path)
+        : _fd(open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)),
+          _dump_scheduled(false),
+          _dump_at(0) { }
+
+ChecksumLog::~ChecksumLog() {
+    flush();
+}
+
+ChecksumLog* ChecksumLog::log() {
+    return _log;
+}
+
+void ChecksumLog::set_log(ChecksumLog* log) {
+    _log = log;
+}
+
+void ChecksumLog::record() {
+    StateChecksum checksum;
+    if (_dump_scheduled && (globals()->gGameTime >= _dump_at)) {
+        _dump_scheduled = false;
+        String dump;
+        ComputeChecksum(&checksum, &dump);
+        ScopedFd fd(open(_dump_path, O_WRONLY | O_CREAT | O_TRUNC, 0644));
+        write(fd, utf8::encode(dump));
+    } else {
+        ComputeChecksum(&checksum);
+    }
+
+    write(_buffer, checksum);
+    if (_buffer.size() >= kChecksumFlushSize) {
+        flush();
+    }
+}
+
+void ChecksumLog::schedule_dump(int64_t at, const StringSlice& path) {
+    _dump_scheduled = true;
+    _dump_at = at;
+    _dump_path.assign(path);
+}
+
+void ChecksumLog::flush() {
+    write(_fd, _buffer);
+    _buffer.clear();
+}
+
+void ReadChecksums(BytesSlice in, vector<StateChecksum>* checksums) {
+    while (!in.empty()) {
+        StateChecksum checksum;
+        read(in, checksum);
+        checksums->push_back(checksum);
+    }
+}
+
+}  // namespace antares
@@ -0,0 +1,95 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "game/free-slots.hpp"
+
+#include "game/snapshot.hpp"
+
+using sfz::Bytes;
+using sfz::BytesSlice;
+
+namespace antares {
+
+namespace {
+
+const int kWordBits = 64;
+
+inline int lowest_bit(uint64_t word) {
+    return __builtin_ctzll(word);
+}
+
+}  // namespace
+
+FreeSlots::FreeSlots()
+        : _capacity(0) { }
+
+void FreeSlots::reset(int32_t capacity) {
+    _capacity = capacity;
+    const int32_t word_count = (capacity + kWordBits - 1) / kWordBits;
+    _words.assign(word_count, ~uint64_t(0));
+    _summary.assign((word_count + kWordBits - 1) / kWordBits, 0);
+
+    // Clear the bits past the end of the table, so they are never handed out.
+    if (capacity % kWordBits) {
+        _words.back() = (uint64_t(1) << (capacity % kWordBits)) - 1;
+    }
+    for (int32_t w = 0; w < word_count; ++w) {
+        if (_words[w]) {
+            _summary[w / kWordBits] |= uint64_t(1) << (w % kWordBits);
+        }
+    }
+}
+
+int32_t FreeSlots::first() const {
+    for (size_t s = 0; s < _summary.size(); ++s) {
+        if (_summary[s]) {
+            const int32_t w = (s * kWordBits) + lowest_bit(_summary[s]);
+            return (w * kWordBits) + lowest_bit(_words[w]);
+        }
+    }
+    return -1;
+}
+
+void FreeSlots::acquire(int32_t slot) {
+    const int32_t w = slot / kWordBits;
+    _words[w] &= ~(uint64_t(1) << (slot % kWordBits));
+    if (_words[w] == 0) {
+        _summary[w / kWordBits] &= ~(uint64_t(1) << (w % kWordBits));
+    }
+}
+
+void FreeSlots::release(int32_t slot) {
+    const int32_t w = slot / kWordBits;
+    _words[w] |= uint64_t(1) << (slot % kWordBits);
+    _summary[w / kWordBits] |= uint64_t(1) << (w % kWordBits);
+}
+
+void FreeSlots::save(Bytes* out) const {
+    save_raw(out, &_capacity);
+    save_vector(out, _words);
+    save_vector(out, _summary);
+}
+
+void FreeSlots::restore(BytesSlice* in) {
+    restore_raw(in, &_capacity);
+    restore_vector(in, &_words);
+    restore_vector(in, &_summary);
+}
+
+}  // namespace antares
@@ -53,6 +53,7 @@ aresGlobalType::aresGlobalType() {
     gKeyMapBufferBottom = 0;
     gGameOver = 1;
     gGameTime = 0;
+    gScenarioCheckTime = 0;
     gClosestObject = 0;
     gFarthestObject = 0;
     gCenterScaleH = 0;
@@ -25,8 +25,10 @@
 #include "config/preferences.hpp"
 #include "data/replay.hpp"
 #include "game/globals.hpp"
+#include "game/snapshot.hpp"
 #include "video/driver.hpp"
 
+using sfz::Bytes;
 using sfz::BytesSlice;
 using sfz::read;
 
@@ -34,6 +36,10 @@ namespace antares {
 
 InputSource::~InputSource() { }
 
+void InputSource::save(Bytes* out) const { }
+
+void InputSource::restore(BytesSlice* in) { }
+
 UserInputSource::UserInputSource() { }
 
 bool UserInputSource::next(KeyMap& key_map) {
@@ -41,9 +47,8 @@ bool UserInputSource::next(KeyMap& key_map) {
     return true;
 }
 
-ReplayInputSource::ReplayInputSource(ReplayData* data):
-        _data(data),
-        _data_index(0),
+ReplayInputSource::ReplayInputSource(const ReplayReader& replay):
+        _replay(replay),
         _wait_ticks(0) {
     advance();
 }
@@ -60,9 +65,24 @@ bool ReplayInputSource::next(KeyMap& key_map) {
     return true;
 }
 
+void ReplayInputSource::save(Bytes* out) const {
+    const size_t position = _replay.position();
+    save_raw(out, &position);
+    save_raw(out, &_wait_ticks);
+    save_raw(out, &_key_map);
+}
+
+void ReplayInputSource::restore(BytesSlice* in) {
+    size_t position;
+    restore_raw(in, &position);
+    _replay.set_position(position);
+    restore_raw(in, &_wait_ticks);
+    restore_raw(in, &_key_map);
+}
+
 bool ReplayInputSource::advance() {
-    while (_data_index < _data->items.size()) {
-        const ReplayData::Item& item = _data->items[_data_index++];
+    ReplayData::Item item;
+    while (_replay.next(&item)) {
         switch (item.type) {
           case ReplayData::Item::WAIT:
             _wait_ticks += item.data.wait;
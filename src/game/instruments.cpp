@@ -20,6 +20,7 @@
 #include "game/instruments.hpp"
 
 #include <algorithm>
+#include <vector>
 
 #include "data/picture.hpp"
 #include "data/space-object.hpp"
@@ -46,6 +47,7 @@ using sfz::scoped_array;
 using sfz::scoped_ptr;
 using std::min;
 using std::max;
+using std::vector;
 
 namespace antares {
 
@@ -125,6 +127,8 @@ coordPointType          gLastGlobalCorner;
 namespace {
 
 scoped_array<Point> gRadarBlipData;
+int32_t gRadarBlipCount = 0;
+vector<int32_t> gRadarObjects;
 scoped_array<int32_t> gScaleList;
 scoped_array<int32_t> gSectorLineData;
 bool should_draw_sector_lines = false;
@@ -166,7 +170,6 @@ void InstrumentCleanup() {
 
 void ResetInstruments() {
     int32_t         *l, i;
-    Point           *lp;
 
     globals()->gRadarCount = 0;
     globals()->gRadarSpeed = 30;
@@ -196,12 +199,7 @@ void ResetInstruments() {
     globals()->gBarIndicator[kBatteryBar].top = 103 + globals()->gInstrumentTop;
     globals()->gBarIndicator[kBatteryBar].color = SALMON;
 
-    lp = gRadarBlipData.get();
-    for ( i = 0; i < kRadarBlipNum; i++)
-    {
-        lp->h = -1;
-        lp++;
-    }
+    gRadarBlipCount = 0;
 
     l = gSectorLineData.get();
     SFZ_FOREACH(int count, range(kMaxSectorLine), {
@@ -216,6 +214,88 @@ void ResetInstruments() {
     });
 }
 
+void UpdateScale(int32_t unitsDone) {
+    if ((gScrollStarObject == NULL) || !gScrollStarObject->active) {
+        return;
+    }
+    if (unitsDone < 0) {
+        unitsDone = 0;
+    }
+
+    uint32_t bestScale = MIN_SCALE;
+    switch (globals()->gZoomMode) {
+      case kNearestFoeZoom:
+      case kNearestAnythingZoom:
+        {
+            spaceObjectType* anObject = gSpaceObjectData.get() + globals()->gClosestObject;
+            uint64_t hugeDistance = anObject->distanceFromPlayer;
+            if (hugeDistance == 0) { // if this is true, then we haven't calced its distance
+                uint64_t x_distance = ABS<int32_t>(gScrollStarObject->location.h - anObject->location.h);
+                uint64_t y_distance = ABS<int32_t>(gScrollStarObject->location.v - anObject->location.v);
+
+                hugeDistance = y_distance * y_distance + x_distance * x_distance;
+            }
+            bestScale = wsqrt(hugeDistance);
+            if (bestScale == 0) bestScale = 1;
+            bestScale = globals()->gCenterScaleV / bestScale;
+            if (bestScale < SCALE_SCALE) bestScale = (bestScale >> 2L) + (bestScale >> 1L);
+            bestScale = clamp<uint32_t>(bestScale, kMinimumAutoScale, SCALE_SCALE);
+        }
+        break;
+
+      case kActualSizeZoom:
+        bestScale = SCALE_SCALE;
+        break;
+
+      case kEighthSizeZoom:
+        bestScale = kOneEighthScale;
+        break;
+
+      case kQuarterSizeZoom:
+        bestScale = kOneQuarterScale;
+        break;
+
+      case kHalfSizeZoom:
+        bestScale = kOneHalfScale;
+        break;
+
+      case kTimesTwoZoom:
+        bestScale = kTimesTwoScale;
+        break;
+
+      case kSmallestZoom:
+        {
+            spaceObjectType* anObject = gSpaceObjectData.get() + globals()->gFarthestObject;
+            uint64_t tempWide = anObject->distanceFromPlayer;
+            bestScale = wsqrt(tempWide);
+            if (bestScale == 0) bestScale = 1;
+            bestScale = globals()->gCenterScaleV / bestScale;
+            if (bestScale < SCALE_SCALE) bestScale = (bestScale >> 2L) + (bestScale >> 1L);
+            bestScale = clamp<uint32_t>(bestScale, kMinimumAutoScale, SCALE_SCALE);
+        }
+        break;
+    }
+
+    int32_t* scaleval;
+    for (int x = 0; x < unitsDone; x++) {
+        scaleval = gScaleList.get() + globals()->gWhichScaleNum;
+        *scaleval = bestScale;
+        globals()->gWhichScaleNum++;
+        if (globals()->gWhichScaleNum == kScaleListNum) {
+            globals()->gWhichScaleNum = 0;
+        }
+    }
+
+    scaleval = gScaleList.get();
+    int absolute_scale = 0;
+    for (int oCount = 0; oCount < kScaleListNum; oCount++) {
+        absolute_scale += *scaleval++;
+    }
+    absolute_scale >>= kScaleListShift;
+
+    gAbsoluteScale = absolute_scale;
+}
+
 void UpdateRadar(int32_t unitsDone) {
     bool radar_is_functioning;
     if (gScrollStarObject == NULL) {
@@ -242,12 +322,7 @@ void UpdateRadar(int32_t unitsDone) {
     }
 
     if (radar_is_functioning) {
-        for (int rcount = 0; rcount < kRadarBlipNum; rcount++) {
-            Point* lp = gRadarBlipData.get() + rcount;
-            if (lp->h >= 0) {
-                gRealWorld->set(lp->h, lp->v, color);
-            }
-        }
+        gRealWorld->set_points(gRadarBlipData.get(), gRadarBlipCount, color);
     }
 
     if ((gScrollStarObject == NULL) || !gScrollStarObject->active) {
@@ -277,26 +352,30 @@ void UpdateRadar(int32_t unitsDone) {
             view_range.clip_to(radar);
             gOffWorld->view(view_range).fill(very_dark);
 
-            for (int i = 0; i < kRadarBlipNum; ++i) {
-                Point* lp = gRadarBlipData.get() + i;
-                lp->h = -1;
-            }
-
-            Point* lp = gRadarBlipData.get();
-            Point* end = lp + kRadarBlipNum;
+            gRadarBlipCount = 0;
             globals()->gRadarCount = globals()->gRadarSpeed;
 
+            // Walk the objects in use instead of every slot.  They are taken in slot order, so
+            // that when there are more than kRadarBlipNum in range, the same ones get blips as
+            // when every slot was checked.
             const int32_t rrange = globals()->gRadarRange >> 1L;
-            for (int oCount = 0; oCount < kMaxSpaceObject; oCount++) {
-                spaceObjectType *anObject = gSpaceObjectData.get() + oCount;
-                if (!anObject->active || (anObject == gScrollStarObject)) {
+            gRadarObjects.clear();
+            for (spaceObjectType* o = gRootObject; o != NULL; o = o->nextObject) {
+                if (!o->active || (o == gScrollStarObject)) {
                     continue;
                 }
-                int x = anObject->location.h - gScrollStarObject->location.h;
-                int y = anObject->location.v - gScrollStarObject->location.v;
+                int x = o->location.h - gScrollStarObject->location.h;
+                int y = o->location.v - gScrollStarObject->location.v;
                 if ((x < -rrange) || (x >= rrange) || (y < -rrange) || (y >= rrange)) {
                     continue;
                 }
+                gRadarObjects.push_back(o->entryNumber);
+            }
+            std::sort(gRadarObjects.begin(), gRadarObjects.end());
+            for (size_t i = 0; i < gRadarObjects.size(); ++i) {
+                spaceObjectType *anObject = gSpaceObjectData.get() + gRadarObjects[i];
+                int x = anObject->location.h - gScrollStarObject->location.h;
+                int y = anObject->location.v - gScrollStarObject->location.v;
                 Point p(x * kRadarSize / globals()->gRadarRange,
                         y * kRadarSize / globals()->gRadarRange);
                 p.offset(kRadarCenter + kRadarLeft,
@@ -304,9 +383,9 @@ void UpdateRadar(int32_t unitsDone) {
                 if (!radar.contains(p)) {
                     continue;
                 }
-                *lp = p;
-                ++lp;
-                if (lp == end) {
+                gRadarBlipData[gRadarBlipCount] = p;
+                ++gRadarBlipCount;
+                if (gRadarBlipCount == kRadarBlipNum) {
                     break;
                 }
             }
@@ -315,78 +394,7 @@ void UpdateRadar(int32_t unitsDone) {
         gRealWorld->view(bounds).fill(darkest);
     }
 
-    uint32_t bestScale = MIN_SCALE;
-    switch (globals()->gZoomMode) {
-      case kNearestFoeZoom:
-      case kNearestAnythingZoom:
-        {
-            spaceObjectType* anObject = gSpaceObjectData.get() + globals()->gClosestObject;
-            uint64_t hugeDistance = anObject->distanceFromPlayer;
-            if (hugeDistance == 0) { // if this is true, then we haven't calced its distance
-                uint64_t x_distance = ABS<int32_t>(gScrollStarObject->location.h - anObject->location.h);
-                uint64_t y_distance = ABS<int32_t>(gScrollStarObject->location.v - anObject->location.v);
-
-                hugeDistance = y_distance * y_distance + x_distance * x_distance;
-            }
-            bestScale = wsqrt(hugeDistance);
-            if (bestScale == 0) bestScale = 1;
-            bestScale = globals()->gCenterScaleV / bestScale;
-            if (bestScale < SCALE_SCALE) bestScale = (bestScale >> 2L) + (bestScale >> 1L);
-            bestScale = clamp<uint32_t>(bestScale, kMinimumAutoScale, SCALE_SCALE);
-        }
-        break;
-
-      case kActualSizeZoom:
-        bestScale = SCALE_SCALE;
-        break;
-
-      case kEighthSizeZoom:
-        bestScale = kOneEighthScale;
-        break;
-
-      case kQuarterSizeZoom:
-        bestScale = kOneQuarterScale;
-        break;
-
-      case kHalfSizeZoom:
-        bestScale = kOneHalfScale;
-        break;
-
-      case kTimesTwoZoom:
-        bestScale = kTimesTwoScale;
-        break;
-
-      case kSmallestZoom:
-        {
-            spaceObjectType* anObject = gSpaceObjectData.get() + globals()->gFarthestObject;
-            uint64_t tempWide = anObject->distanceFromPlayer;
-            bestScale = wsqrt(tempWide);
-            if (bestScale == 0) bestScale = 1;
-            bestScale = globals()->gCenterScaleV / bestScale;
-            if (bestScale < SCALE_SCALE) bestScale = (bestScale >> 2L) + (bestScale >> 1L);
-            bestScale = clamp<uint32_t>(bestScale, kMinimumAutoScale, SCALE_SCALE);
-        }
-        break;
-    }
-
-    int32_t* scaleval;
-    for (int x = 0; x < unitsDone; x++) {
-        scaleval = gScaleList.get() + globals()->gWhichScaleNum;
-        *scaleval = bestScale;
-        globals()->gWhichScaleNum++;
-        if (globals()->gWhichScaleNum == kScaleListNum) {
-            globals()->gWhichScaleNum = 0;
-        }
-    }
-
-    scaleval = gScaleList.get();
-    int absolute_scale = 0;
-    for (int oCount = 0; oCount < kScaleListNum; oCount++) {
-        absolute_scale += *scaleval++;
-    }
-    absolute_scale >>= kScaleListShift;
-
-    gAbsoluteScale = absolute_scale;
+    UpdateScale(unitsDone);
 
     baseObjectType* base = gScrollStarObject->baseType;
     UpdateBarIndicator(kShieldBar, gScrollStarObject->health, base->health, gRealWorld);
@@ -613,9 +621,10 @@ void draw_site() {
 
         const RgbColor light = GetRGBTranslateColorShade(PALE_GREEN, MEDIUM);
         const RgbColor dark = GetRGBTranslateColorShade(PALE_GREEN, DARKER + kSlightlyDarkerColor);
-        VideoDriver::driver()->draw_line(site_data.a, site_data.b, light);
-        VideoDriver::driver()->draw_line(site_data.a, site_data.c, light);
-        VideoDriver::driver()->draw_line(site_data.b, site_data.c, dark);
+        PrimitiveBatch batch(VideoDriver::driver());
+        batch.draw_line(site_data.a, site_data.b, light);
+        batch.draw_line(site_data.a, site_data.c, light);
+        batch.draw_line(site_data.b, site_data.c, dark);
     }
 }
 
@@ -643,6 +652,7 @@ void draw_sector_lines() {
     RgbColor        color;
 
     Rect clipRect = viewport;
+    PrimitiveBatch batch(VideoDriver::driver());
 
     size = kSubSectorSize / 4;
     level = 1;
@@ -670,7 +680,7 @@ void draw_sector_lines() {
                 color = GetRGBTranslateColorShade(BLUE, kSectorLineBrightness);
             }
 
-            VideoDriver::driver()->draw_line(Point(x, viewport.top), Point(x, viewport.bottom), color);
+            batch.draw_line(Point(x, viewport.top), Point(x, viewport.bottom), color);
             *l = x;
             l += 2;
             division += level;
@@ -695,7 +705,7 @@ void draw_sector_lines() {
                 color = GetRGBTranslateColorShade(BLUE, kSectorLineBrightness);
             }
 
-            VideoDriver::driver()->draw_line(Point(viewport.left, x), Point(viewport.right, x), color);
+            batch.draw_line(Point(viewport.left, x), Point(viewport.right, x), color);
             *l = x;
             l += 2;
 
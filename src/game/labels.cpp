@@ -34,7 +34,6 @@ using sfz::Rune;
 using sfz::String;
 using sfz::StringSlice;
 using sfz::format;
-using sfz::quote;
 using sfz::scoped_ptr;
 using std::min;
 using std::max;
@@ -50,6 +49,7 @@ const int32_t kMaxLabelNum = 16;
 const int32_t kLabelBuffer = 4;
 const int32_t kLabelInnerSpace = 3;
 const int32_t kLabelTotalInnerSpace = kLabelInnerSpace << 1;
+const int32_t kLabelShadowOffset = 1;
 
 }  // namespace
 
@@ -58,6 +58,45 @@ static long String_Count_Lines(const StringSlice& s);
 static StringSlice String_Get_Nth_Line(const StringSlice& source, long nth);
 static void Auto_Animate_Line( Point *source, Point *dest);
 
+namespace {
+
+// Draws `label` into `pix`: its dithered background, and its text with a drop shadow.  The label's
+// rect starts kLabelShadowOffset pixels in from the corner of `pix`.  Its text used to be drawn
+// straight to the screen, so it isn't clipped to the rect: `pix` must be big enough for the whole
+// label and its shadows, even when the rect has been clipped to the viewport.
+void render_label(const screenLabelType& label, int parity, PixMap* pix) {
+    StringSlice text = label.text;
+    if (label.retroCount >= 0) {
+        text = text.slice(0, label.retroCount);
+    }
+    const RgbColor light = GetRGBTranslateColorShade(label.color, VERY_LIGHT);
+    const RgbColor dark = GetRGBTranslateColorShade(label.color, VERY_DARK);
+    const Rect bounds = pix->size().as_rect();
+    Rect background = label.thisRect.size().as_rect();
+    background.offset(kLabelShadowOffset, kLabelShadowOffset);
+    pix->fill(RgbColor::kClear);
+    DrawNateRectVScan(pix, background, dark, parity);
+
+    const int32_t s = kLabelShadowOffset;
+    Point at(s + kLabelInnerSpace, s + kLabelInnerSpace + gDirectText->ascent);
+    if (label.lineNum > 1) {
+        for (int j = 1; j <= label.lineNum; j++) {
+            StringSlice line = String_Get_Nth_Line(text, j);
+
+            gDirectText->draw(Point(at.h + s, at.v + s), line, RgbColor::kBlack, pix, bounds);
+            gDirectText->draw(Point(at.h - s, at.v - s), line, RgbColor::kBlack, pix, bounds);
+            gDirectText->draw(at, line, light, pix, bounds);
+
+            at.offset(0, label.lineHeight);
+        }
+    } else {
+        gDirectText->draw(Point(at.h + s, at.v + s), text, RgbColor::kBlack, pix, bounds);
+        gDirectText->draw(at, text, light, pix, bounds);
+    }
+}
+
+}  // namespace
+
 void ScreenLabelInit() {
     globals()->gScreenLabelData.reset(new screenLabelType[kMaxLabelNum]);
 }
@@ -72,6 +111,8 @@ screenLabelType::screenLabelType() {
     zero(*this);
 }
 
+screenLabelType::~screenLabelType() { }
+
 void zero(screenLabelType& label) {
     label.thisRect = Rect(0, 0, -1, -1);
     label.text.clear();
@@ -86,6 +127,12 @@ void zero(screenLabelType& label) {
     label.keepOnScreenAnyway = false;
     label.attachedHintLine = false;
     label.retroCount = -1;
+    label.sprites[0].reset();
+    label.sprites[1].reset();
+    label.spriteCurrent[0] = label.spriteCurrent[1] = false;
+    label.spriteSize = Size(0, 0);
+    label.backgroundSize = Size(0, 0);
+    label.dirty = true;
 }
 
 short AddScreenLabel(
@@ -125,6 +172,7 @@ short AddScreenLabel(
     }
     label->text.clear();
     label->lineNum = label->lineHeight = label->width = label->height = 0;
+    label->dirty = true;
 
     return label_num;
 }
@@ -137,6 +185,7 @@ void RemoveScreenLabel(long which) {
     label->killMe = false;
     label->object = NULL;
     label->width = label->height = label->lineNum = label->lineHeight = 0;
+    label->dirty = true;
 }
 
 void draw_labels() {
@@ -159,35 +208,39 @@ void draw_labels() {
                 || (label->thisRect.height() <= 0)) {
             continue;
         }
-        StringSlice text = label->text;
-        if (label->retroCount >= 0) {
-            text = text.slice(0, label->retroCount);
+
+        // Only render the label again if it has changed since it was last drawn.  A sprite can
+        // only be updated with an image of its own size, so a label which changes size needs new
+        // ones.  They are not packed, since they may come and go every frame.  The sprites are
+        // padded for the shadows, and hold the whole label even where its background is clipped.
+        const Size size(
+                max<int32_t>(label->width, label->thisRect.width()) + (2 * kLabelShadowOffset),
+                max<int32_t>(label->height, label->thisRect.height()) + (2 * kLabelShadowOffset));
+        if (label->spriteSize != size) {
+            label->sprites[0].reset();
+            label->sprites[1].reset();
+            label->spriteCurrent[0] = label->spriteCurrent[1] = false;
+            label->spriteSize = size;
+        }
+        if (label->dirty || (label->backgroundSize != label->thisRect.size())) {
+            label->backgroundSize = label->thisRect.size();
+            label->spriteCurrent[0] = label->spriteCurrent[1] = false;
+            label->dirty = false;
         }
-        const RgbColor light = GetRGBTranslateColorShade(label->color, VERY_LIGHT);
-        const RgbColor dark = GetRGBTranslateColorShade(label->color, VERY_DARK);
-        ArrayPixMap pix(label->thisRect.width(), label->thisRect.height());
-        pix.fill(RgbColor::kClear);
-        DrawNateRectVScan(&pix, pix.size().as_rect(), dark, (at.h ^ at.v) & 0x1);
-
-        scoped_ptr<Sprite> sprite(VideoDriver::driver()->new_sprite(
-                    format("/x/screen_label: {0}", quote(text)), pix));
-        sprite->draw(at.h, at.v);
-        at.offset(kLabelInnerSpace, kLabelInnerSpace + gDirectText->ascent);
-
-        if (label->lineNum > 1) {
-            for (int j = 1; j <= label->lineNum; j++) {
-                StringSlice line = String_Get_Nth_Line(text, j);
-
-                gDirectText->draw_sprite(Point(at.h + 1, at.v + 1), line, RgbColor::kBlack);
-                gDirectText->draw_sprite(Point(at.h - 1, at.v - 1), line, RgbColor::kBlack);
-                gDirectText->draw_sprite(at, line, light);
-
-                at.offset(0, label->lineHeight);
+        const int parity = (at.h ^ at.v) & 0x1;
+        scoped_ptr<Sprite>& sprite = label->sprites[parity];
+        if (!label->spriteCurrent[parity]) {
+            ArrayPixMap pix(size.width, size.height);
+            render_label(*label, parity, &pix);
+            if (sprite.get() == NULL) {
+                sprite.reset(VideoDriver::driver()->new_sprite(
+                            format("/x/screen_label/{0}/{1}", i, parity), pix));
+            } else {
+                sprite->update(pix, pix.size().as_rect());
             }
-        } else {
-            gDirectText->draw_sprite(Point(at.h + 1, at.v + 1), text, RgbColor::kBlack);
-            gDirectText->draw_sprite(at, text, light);
+            label->spriteCurrent[parity] = true;
         }
+        sprite->draw(at.h - kLabelShadowOffset, at.v - kLabelShadowOffset);
     }
 }
 
@@ -215,6 +268,7 @@ void update_all_label_contents(int32_t units_done) {
             // per tick, so this would be equivalent to the old code at 20 FPS.  The question is,
             // does it feel equivalent?  It only comes up in the tutorial.
             label->retroCount += units_done;
+            label->dirty = true;
             if (static_cast<size_t>(label->retroCount) > label->text.size()) {
                 label->retroCount = -1;
             } else {
@@ -382,17 +436,20 @@ void ClearScreenLabelString(long which) {
     screenLabelType *label = globals()->gScreenLabelData.get() + which;
     label->text.clear();
     label->width = label->height = 0;
+    label->dirty = true;
 }
 
 void SetScreenLabelColor(long which, unsigned char color) {
     screenLabelType *label = globals()->gScreenLabelData.get() + which;
     label->color = color;
+    label->dirty = true;
 }
 
 void SetScreenLabelKeepOnScreenAnyway(long which, bool keepOnScreenAnyway) {
     screenLabelType *label = globals()->gScreenLabelData.get() + which;
     label->keepOnScreenAnyway = keepOnScreenAnyway;
     label->retroCount = 0;
+    label->dirty = true;
 }
 
 void SetScreenLabelAttachedHintLine(long which, bool attachedHintLine, Point toWhere) {
@@ -403,6 +460,7 @@ void SetScreenLabelAttachedHintLine(long which, bool attachedHintLine, Point toW
     label->attachedHintLine = attachedHintLine;
     label->attachedToWhere = toWhere;
     label->retroCount = 0;
+    label->dirty = true;
 }
 
 void SetScreenLabelOffset(long which, long hoff, long voff) {
@@ -418,6 +476,7 @@ long GetScreenLabelWidth(long which) {
 
 String* GetScreenLabelStringPtr( long which) {
     screenLabelType *label = globals()->gScreenLabelData.get() + which;
+    label->dirty = true;
     return &label->text;
 }
 
@@ -426,6 +485,7 @@ void RecalcScreenLabelSize(long which) {
     mSetDirectFont(kTacticalFontNum);
 
     screenLabelType *label = globals()->gScreenLabelData.get() + which;
+    label->dirty = true;
     int lineNum = String_Count_Lines(label->text);
 
     if (lineNum > 1) {
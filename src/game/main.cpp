@@ -21,6 +21,7 @@
 
 #include <math.h>
 #include <algorithm>
+#include <vector>
 
 #include "config/keys.hpp"
 #include "config/preferences.hpp"
@@ -32,6 +33,7 @@
 #include "drawing/text.hpp"
 #include "game/admiral.hpp"
 #include "game/beam.hpp"
+#include "game/checksum.hpp"
 #include "game/cursor.hpp"
 #include "game/globals.hpp"
 #include "game/input-source.hpp"
@@ -42,7 +44,10 @@
 #include "game/motion.hpp"
 #include "game/non-player-ship.hpp"
 #include "game/player-ship.hpp"
+#include "game/profiler.hpp"
 #include "game/scenario-maker.hpp"
+#include "game/snapshot.hpp"
+#include "game/space-object.hpp"
 #include "game/starfield.hpp"
 #include "game/time.hpp"
 #include "math/units.hpp"
@@ -65,6 +70,7 @@ using sfz::scoped_ptr;
 using sfz::scoped_array;
 using std::min;
 using std::max;
+using std::vector;
 
 namespace antares {
 
@@ -74,7 +80,7 @@ Rect viewport;
 
 class GamePlay : public Card {
   public:
-    GamePlay(bool replay, GameResult* game_result);
+    GamePlay(bool replay, bool simulate_only, GameResult* game_result);
 
     virtual void become_front();
 
@@ -96,6 +102,7 @@ class GamePlay : public Card {
     State _state;
 
     const bool _replay;
+    const bool _simulate_only;
     GameResult* const _game_result;
     int64_t _next_timer;
     long _seconds;
@@ -109,18 +116,23 @@ class GamePlay : public Card {
     KeyMap _last_key_map;
     uint32_t _decide_cycle;
     int _last_click_time;
-    int _scenario_check_time;
     PlayAgainScreen::Item _play_again;
+
+    // gRealWorld, as of the last frame drawn.
+    mutable scoped_ptr<Sprite> _real_world;
+    mutable vector<Rect> _real_world_changes;
 };
 
 Card* AresInit() {
     return new Master;
 }
 
-MainPlay::MainPlay(const Scenario* scenario, bool replay, GameResult* game_result)
+MainPlay::MainPlay(
+        const Scenario* scenario, bool replay, bool simulate_only, GameResult* game_result)
         : _state(NEW),
           _scenario(scenario),
           _replay(replay),
+          _simulate_only(simulate_only),
           _cancelled(false),
           _game_result(game_result) { }
 
@@ -131,6 +143,9 @@ void MainPlay::become_front() {
             _state = LOADING;
             RemoveAllSpaceObjects();
             globals()->gGameOver = 0;
+            // Every replay that can be played back was recorded by the original game, so it
+            // expects that game's limit on delayed actions.
+            SetLegacyActionQueueLimit(_replay);
 
             if (Preferences::preferences()->play_idle_music()) {
                 LoadSong(3000);
@@ -179,7 +194,7 @@ void MainPlay::become_front() {
             globals()->gLastTime = now_usecs();
 
             VideoDriver::driver()->set_game_state(PLAY_GAME);
-            stack()->push(new GamePlay(_replay, _game_result));
+            stack()->push(new GamePlay(_replay, _simulate_only, _game_result));
         }
         break;
 
@@ -195,9 +210,10 @@ void MainPlay::become_front() {
     }
 }
 
-GamePlay::GamePlay(bool replay, GameResult* game_result)
+GamePlay::GamePlay(bool replay, bool simulate_only, GameResult* game_result)
         : _state(PLAYING),
           _replay(replay),
+          _simulate_only(simulate_only),
           _game_result(game_result),
           _next_timer(now_usecs() + kTimeUnit),
           _seconds(0),
@@ -209,8 +225,9 @@ GamePlay::GamePlay(bool replay, GameResult* game_result)
           _entering_message(false),
           _player_paused(false),
           _decide_cycle(0),
-          _last_click_time(0),
-          _scenario_check_time(0) { }
+          _last_click_time(0) {
+    globals()->gScenarioCheckTime = 0;
+}
 
 class PauseScreen : public Card {
   public:
@@ -362,8 +379,17 @@ void GamePlay::become_front() {
 }
 
 void GamePlay::draw() const {
-    scoped_ptr<Sprite> sprite(VideoDriver::driver()->new_sprite("/x/real_world", *gRealWorld));
-    sprite->draw(0, 0);
+    ProfileScope profile(PROFILE_DRAW);
+    _real_world_changes.clear();
+    gRealWorld->take_changes(&_real_world_changes);
+    if (_real_world.get() == NULL) {
+        _real_world.reset(VideoDriver::driver()->new_sprite("/x/real_world", *gRealWorld));
+    } else {
+        for (size_t i = 0; i < _real_world_changes.size(); ++i) {
+            _real_world->update(*gRealWorld, _real_world_changes[i]);
+        }
+    }
+    _real_world->draw(0, 0);
 
     {
         Rect clip = viewport;
@@ -419,9 +445,11 @@ void GamePlay::fire_timer() {
         return;
     }
 
-    gOffWorld->view(clip_rect).fill(RgbColor::kBlack);
-    globals()->starfield.prepare_to_move();
-    EraseSite();
+    if (!_simulate_only) {
+        gOffWorld->view(clip_rect).fill(RgbColor::kBlack);
+        globals()->starfield.prepare_to_move();
+        EraseSite();
+    }
 
     if (_player_paused) {
         _player_paused = false;
@@ -449,8 +477,14 @@ void GamePlay::fire_timer() {
 
         if (unitsToDo > 0) {
             // executed arbitrarily, but at least once every kDecideEveryCycles
-            globals()->starfield.move(unitsToDo);
-            MoveSpaceObjects(gSpaceObjectData.get(), kMaxSpaceObject, unitsToDo);
+            if (!_simulate_only) {
+                ProfileScope profile(PROFILE_STARFIELD);
+                globals()->starfield.move(unitsToDo);
+            }
+            {
+                ProfileScope profile(PROFILE_MOVE);
+                MoveSpaceObjects(gSpaceObjectData.get(), gMaxSpaceObject, unitsToDo);
+            }
         }
 
         globals()->gGameTime += unitsToDo;
@@ -459,13 +493,25 @@ void GamePlay::fire_timer() {
             // everything in here gets executed once every kDecideEveryCycles
             _player_paused = false;
 
-            NonplayerShipThink( kDecideEveryCycles);
-            AdmiralThink();
-            ExecuteActionQueue( kDecideEveryCycles);
+            {
+                ProfileScope profile(PROFILE_NONPLAYER_THINK);
+                NonplayerShipThink( kDecideEveryCycles);
+            }
+            {
+                ProfileScope profile(PROFILE_ADMIRAL_THINK);
+                AdmiralThink();
+            }
+            {
+                ProfileScope profile(PROFILE_ACTION_QUEUE);
+                ExecuteActionQueue( kDecideEveryCycles);
+            }
 
-            if (!PlayerShipGetKeys(
-                        kDecideEveryCycles, *globals()->gInputSource, &_entering_message)) {
-                globals()->gGameOver = 1;
+            {
+                ProfileScope profile(PROFILE_PLAYER_KEYS);
+                if (!PlayerShipGetKeys(
+                            kDecideEveryCycles, *globals()->gInputSource, &_entering_message)) {
+                    globals()->gGameOver = 1;
+                }
             }
 
             if (VideoDriver::driver()->button()) {
@@ -494,13 +540,35 @@ void GamePlay::fire_timer() {
                 InstrumentsHandleMouseUp();
             }
 
-            CollideSpaceObjects(gSpaceObjectData.get(), kMaxSpaceObject);
+            {
+                ProfileScope profile(PROFILE_COLLIDE);
+                CollideSpaceObjects(gSpaceObjectData.get(), gMaxSpaceObject);
+            }
             _decide_cycle = 0;
-            _scenario_check_time++;
-            if (_scenario_check_time == 30) {
-                _scenario_check_time = 0;
+            globals()->gScenarioCheckTime++;
+            if (globals()->gScenarioCheckTime == 30) {
+                ProfileScope profile(PROFILE_SCENARIO);
+                globals()->gScenarioCheckTime = 0;
                 CheckScenarioConditions( 0);
             }
+            Profiler::end_cycle(globals()->gGameTime);
+
+            ChecksumLog* checksums = ChecksumLog::log();
+            if (checksums != NULL) {
+                checksums->record();
+            }
+
+            SnapshotRing* ring = SnapshotRing::ring();
+            if (ring != NULL) {
+                ring->record();
+                int64_t seek_to;
+                if (ring->take_seek(&seek_to) && ring->restore(seek_to)) {
+                    // Carry on from the restored time, as after a pause.
+                    thisTime = (globals()->gGameTime - _scenario_start_time) * kTimeUnit;
+                    globals()->gLastTime = scrapTime - thisTime;
+                    break;
+                }
+            }
         }
         unitsPassed -= unitsToDo;
     }
@@ -533,26 +601,46 @@ void GamePlay::fire_timer() {
         }
     }
 
+    ProfileScope profile(PROFILE_UPDATE);
+    // Besides drawing, this marks which lines of the mini-computer can be selected, and replayed
+    // keys move through and accept those lines, so it runs even when nothing is drawn.
     MiniComputerHandleNull(unitsDone);
 
+    // Besides drawing, these move a long message through its stages, and a new one checks the
+    // scenario's conditions, which the tutorial depends on.
     ClipToCurrentLongMessage();
     DrawCurrentLongMessage( unitsDone);
 
-    update_sector_lines();
-    update_beams();
-    update_all_label_positions(unitsDone);
-    update_all_label_contents(unitsDone);
-    update_site();
-
-    CullSprites();
-    ShowAllLabels();
-    ShowAllBeams();
-    globals()->starfield.show();
-    copy_world(*gRealWorld, *gOffWorld, world);
-
-    DrawMessageScreen(unitsDone);
-    UpdateRadar(unitsDone);
-    globals()->transitions.update_boolean(unitsDone);
+    // Short messages time out whether or not they are shown, so that the queue doesn't grow.
+    AdvanceMessageQueue(unitsDone);
+
+    if (_simulate_only) {
+        // Killed sprites, labels and beams must still be freed, or their tables would fill up,
+        // and that can change what gets created later on.  These do only the freeing.
+        CullSprites();
+        ShowAllLabels();
+        CullBeams();
+
+        // The zoom scale feeds gGlobalCorner, and through it the distances of new objects from
+        // the player, so it must keep up even though nothing is drawn.
+        UpdateScale(unitsDone);
+    } else {
+        update_sector_lines();
+        update_beams();
+        update_all_label_positions(unitsDone);
+        update_all_label_contents(unitsDone);
+        update_site();
+
+        CullSprites();
+        ShowAllLabels();
+        ShowAllBeams();
+        globals()->starfield.show();
+        copy_world(*gRealWorld, *gOffWorld, world);
+
+        DrawMessageScreen();
+        UpdateRadar(unitsDone);
+        globals()->transitions.update_boolean(unitsDone);
+    }
 
     VideoDriver::driver()->main_loop_iteration_complete(globals()->gGameTime);
 
@@ -33,7 +33,6 @@
 #include "ui/interface-handling.hpp"
 
 using sfz::Bytes;
-using sfz::BytesSlice;
 using sfz::Exception;
 using sfz::String;
 using sfz::StringSlice;
@@ -99,11 +98,7 @@ inline int mHexDigitValue(char c) {
 namespace {
 
 int mac_roman_char_width(uint8_t ch) {
-    BytesSlice bytes(&ch, 1);
-    String str(macroman::decode(bytes));
-    uint8_t width;
-    mDirectCharWidth(width, str.at(0));
-    return width;
+    return gDirectText->mac_roman_width(ch);
 }
 
 template <typename T>
@@ -521,7 +516,7 @@ void ReplayLastLongMessage( void)
 
 // WARNING: RELIES ON kMessageNullCharacter (SPACE CHARACTER #32) >> NOT WORLD-READY <<
 
-void DrawMessageScreen(int32_t by_units) {
+void AdvanceMessageQueue(int32_t by_units) {
     // increase the amount of time current message has been shown
     globals()->gMessageTimeCount += by_units;
 
@@ -531,6 +526,12 @@ void DrawMessageScreen(int32_t by_units) {
         globals()->gMessageData.pop();
     }
 
+    if (globals()->gMessageData.empty()) {
+        globals()->gMessageTimeCount = 0;
+    }
+}
+
+void DrawMessageScreen() {
     mSetDirectFont( kTacticalFontNum);
 
     if (!globals()->gMessageData.empty()) {
@@ -549,7 +550,6 @@ void DrawMessageScreen(int32_t by_units) {
         SetScreenLabelString(globals()->gMessageLabelNum, message);
     } else {
         ClearScreenLabelString(globals()->gMessageLabelNum);
-        globals()->gMessageTimeCount = 0;
     }
 }
 
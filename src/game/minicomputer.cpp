@@ -34,12 +34,14 @@
 #include "game/messages.hpp"
 #include "game/player-ship.hpp"
 #include "game/scenario-maker.hpp"
+#include "game/snapshot.hpp"
 #include "game/space-object.hpp"
 #include "game/starfield.hpp"
 #include "math/fixed.hpp"
 #include "sound/fx.hpp"
 
 using sfz::Bytes;
+using sfz::BytesSlice;
 using sfz::Rune;
 using sfz::String;
 using sfz::StringSlice;
@@ -273,6 +275,70 @@ void MiniScreenCleanup() {
     globals()->gMiniScreenData.objectData.reset();
 }
 
+// The minicomputer's screens and selection decide what the player builds and commands, so they
+// are part of the state of the game.
+void SaveMiniComputer(Bytes* out) {
+    miniComputerDataType* const data = &globals()->gMiniScreenData;
+    for (int32_t i = 0; i < kMiniScreenTrueLineNum; ++i) {
+        const miniScreenLineType& line = data->lineData[i];
+        save_string(out, line.string);
+        save_string(out, line.statusFalse);
+        save_string(out, line.statusTrue);
+        save_string(out, line.statusString);
+        save_string(out, line.postString);
+        save_raw(out, &line.hiliteLeft);
+        save_raw(out, &line.hiliteRight);
+        save_raw(out, &line.whichButton);
+        save_raw(out, &line.selectable);
+        save_raw(out, &line.underline);
+        save_raw(out, &line.lineKind);
+        save_raw(out, &line.value);
+        save_raw(out, &line.statusType);
+        save_raw(out, &line.whichStatus);
+        save_raw(out, &line.statusPlayer);
+        save_raw(out, &line.negativeValue);
+        save_raw(out, &line.sourceData);
+    }
+    save_raw(out, data->objectData.get(), kMiniObjectDataNum);
+    save_raw(out, &data->selectLine);
+    save_raw(out, &data->pollTime);
+    save_raw(out, &data->buildTimeBarValue);
+    save_raw(out, &data->currentScreen);
+    save_raw(out, &data->clickLine);
+    save_raw(out, &globals()->gLastSelectedBuildPrice);
+}
+
+void RestoreMiniComputer(BytesSlice* in) {
+    miniComputerDataType* const data = &globals()->gMiniScreenData;
+    for (int32_t i = 0; i < kMiniScreenTrueLineNum; ++i) {
+        miniScreenLineType* line = &data->lineData[i];
+        restore_string(in, &line->string);
+        restore_string(in, &line->statusFalse);
+        restore_string(in, &line->statusTrue);
+        restore_string(in, &line->statusString);
+        restore_string(in, &line->postString);
+        restore_raw(in, &line->hiliteLeft);
+        restore_raw(in, &line->hiliteRight);
+        restore_raw(in, &line->whichButton);
+        restore_raw(in, &line->selectable);
+        restore_raw(in, &line->underline);
+        restore_raw(in, &line->lineKind);
+        restore_raw(in, &line->value);
+        restore_raw(in, &line->statusType);
+        restore_raw(in, &line->whichStatus);
+        restore_raw(in, &line->statusPlayer);
+        restore_raw(in, &line->negativeValue);
+        restore_raw(in, &line->sourceData);
+    }
+    restore_raw(in, data->objectData.get(), kMiniObjectDataNum);
+    restore_raw(in, &data->selectLine);
+    restore_raw(in, &data->pollTime);
+    restore_raw(in, &data->buildTimeBarValue);
+    restore_raw(in, &data->currentScreen);
+    restore_raw(in, &data->clickLine);
+    restore_raw(in, &globals()->gLastSelectedBuildPrice);
+}
+
 #pragma mark -
 
 void SetMiniScreenStatusStrList(short strID) {
@@ -1607,7 +1673,7 @@ void MiniComputerExecute( long whichPage, long whichLine, long whichAdmiral)
             if ( whichLine != kMiniScreenNoLineSelected)
             {
                 if ( CountObjectsOfBaseType( -1, -1) <
-                    (kMaxSpaceObject - kMaxShipBuffer))
+                    (gMaxSpaceObject - kMaxShipBuffer))
                 {
                     if (AdmiralScheduleBuild( whichAdmiral,
                         whichLine - kBuildScreenFirstTypeLine) == false)
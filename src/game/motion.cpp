@@ -19,6 +19,7 @@
 
 #include "game/motion.hpp"
 
+#include <string.h>
 #include <sfz/sfz.hpp>
 
 #include "data/space-object.hpp"
@@ -31,6 +32,8 @@
 #include "game/non-player-ship.hpp"
 #include "game/player-ship.hpp"
 #include "game/space-object.hpp"
+#include "game/spatial-hash.hpp"
+#include "math/fixed.hpp"
 #include "math/macros.hpp"
 #include "math/random.hpp"
 #include "math/rotation.hpp"
@@ -40,22 +43,14 @@
 
 using sfz::Exception;
 using sfz::scoped_array;
+using sfz::scoped_ptr;
 
 namespace antares {
 
-const int32_t kProximitySuperSize           = 16;   // number of cUnits in cSuperUnits
-const int32_t kProximityGridDataLength      = kProximitySuperSize * kProximitySuperSize;
-const int32_t kProximityUnitAndModulo       = kProximitySuperSize - 1;  // & a long with this and get modulo kCollisionSuperSize
-const int32_t kProximityWidthMultiply       = 4;    // for speed = * kCollisionSuperSize
+const int32_t kProximitySizeShift           = 4;    // grids are 16x16 buckets, wrapping
 
 const int32_t kCollisionUnitBitShift        = 7;    // >> 7 = / 128
-const int32_t kCollisionSuperUnitBitShift   = 11;   // >> 11 = / 2048
-const int32_t kCollisionSuperExtraShift     = kCollisionSuperUnitBitShift - kCollisionUnitBitShift;
-
-const int32_t kDistanceUnitBitShift         = 11;   // >> 14L = / 2048
-const int32_t kDistanceSuperUnitBitShift    = 15;   // >> 18L = / 262144
-const int32_t kDistanceSuperExtraShift      = kDistanceSuperUnitBitShift - kDistanceUnitBitShift;
-const int32_t kDistanceUnitExtraShift       = 0;    // speed from kCollisionSuperUnitBitShift to kDistanceUnitBitShift
+const int32_t kDistanceUnitBitShift         = 11;   // >> 11 = / 2048
 
 const int32_t kNoDir = -1;
 
@@ -66,16 +61,9 @@ const int32_t kConsiderDistanceAttributes = (
 const uint32_t kThinkiverseTopLeft       = (kUniversalCenter - (2 * 65534)); // universe for thinking or owned objects
 const uint32_t kThinkiverseBottomRight   = (kUniversalCenter + (2 * 65534));
 
-static Point            cAdjacentUnits[] = {
-    Point(0, 0),
-    Point(1, 0),
-    Point(-1, 1),
-    Point(0, 1),
-    Point(1, 1)
-};
-
 coordPointType          gGlobalCorner;
-scoped_array<proximityUnitType> gProximityGrid;
+scoped_ptr<SpatialHash> gCollisionGrid;     // for collision checking
+scoped_ptr<SpatialHash> gDistanceGrid;      // for distance checking
 
 // for the macro mRanged, time is assumed to be a long game ticks, velocity a fixed, result long, scratch fixed
 inline void mRange(long& result, long time, Fixed velocity, Fixed& scratch) {
@@ -84,417 +72,543 @@ inline void mRange(long& result, long time, Fixed velocity, Fixed& scratch) {
     result = mFixedToLong( scratch);
 }
 
-void InitMotion() {
-    short                   x, y, i;
-    proximityUnitType       *p;
-    long                    adjacentAdd = 0, ux, uy, sx, sy;
+namespace {
 
-    globals()->gCenterScaleH = (play_screen.width() / 2) * SCALE_SCALE;
-    globals()->gCenterScaleV = (play_screen.height() / 2) * SCALE_SCALE;
-
-    gProximityGrid.reset(new proximityUnitType[kProximityGridDataLength]);
-
-    // initialize the proximityGrid & set up the needed lookups (see Notebook 2 p.34)
-    p = gProximityGrid.get();
-    for ( y = 0; y < kProximitySuperSize; y++)
-    {
-        for ( x = 0; x < kProximitySuperSize; x++)
-        {
-            p->nearObject = p->farObject = NULL;
-            adjacentAdd = 0;
-            for ( i = 0; i < kUnitsToCheckNumber; i++)
-            {
-                ux = x;
-                uy = y;
-                sx = sy = 0;
+// The fields of spaceObjectType which MoveSpaceObjects() updates on every sub-step, gathered into
+// parallel arrays.  spaceObjectType is large, and mixes these fields with a great deal of state
+// which isn't touched while moving, so walking the arrays instead of gRootObject touches far less
+// memory per sub-step.  The objects themselves remain authoritative: fields are gathered at the
+// start of MoveSpaceObjects() and scattered back at the end.
+//
+// Entry `i` belongs to `object[i]`.  Entries are in gRootObject order, and only objects which
+// were in use when MoveSpaceObjects() was called have one; `entry[n]` is the entry for the object
+// in slot `n` of the space object table, or -1 if it has none.
+struct MotionState {
+    int32_t                         count;
+    scoped_array<int32_t>           entry;
+    scoped_array<spaceObjectType*>  object;
+    scoped_array<unsigned long>     attributes;
+    scoped_array<short>             active;
+    scoped_array<long>              direction;
+    scoped_array<Fixed>             turnVelocity;
+    scoped_array<Fixed>             turnFraction;
+    scoped_array<Fixed>             thrust;
+    scoped_array<Fixed>             maxVelocity;
+    scoped_array<Fixed>             speed;              // multiplier for goal velocity
+    scoped_array<coordPointType>    location;
+    scoped_array<coordPointType>    lastLocation;       // location at start of sub-step
+    scoped_array<fixedPointType>    velocity;
+    scoped_array<fixedPointType>    motionFraction;
+
+    // Entries which are still in use in the current sub-step.
+    int32_t                         liveCount;
+    scoped_array<int32_t>           live;
+
+    // Entries which animate or follow beams, and are still in use in the current sub-step.
+    int32_t                         specialCount;
+    scoped_array<int32_t>           special;
+    bool                            hasBeams;
+
+    // The entry of gScrollStarObject, or -1 if it isn't being moved.
+    int32_t                         scrollStar;
+
+    // Entries which move in the current sub-step.
+    scoped_array<int32_t>           moving;
+
+    explicit MotionState(int32_t capacity):
+            count(0),
+            entry(new int32_t[capacity]),
+            object(new spaceObjectType*[capacity]),
+            attributes(new unsigned long[capacity]),
+            active(new short[capacity]),
+            direction(new long[capacity]),
+            turnVelocity(new Fixed[capacity]),
+            turnFraction(new Fixed[capacity]),
+            thrust(new Fixed[capacity]),
+            maxVelocity(new Fixed[capacity]),
+            speed(new Fixed[capacity]),
+            location(new coordPointType[capacity]),
+            lastLocation(new coordPointType[capacity]),
+            velocity(new fixedPointType[capacity]),
+            motionFraction(new fixedPointType[capacity]),
+            liveCount(0),
+            live(new int32_t[capacity]),
+            specialCount(0),
+            special(new int32_t[capacity]),
+            hasBeams(false),
+            scrollStar(-1),
+            moving(new int32_t[capacity]),
+            _capacity(capacity) {
+        for (int32_t n = 0; n < capacity; ++n) {
+            entry[n] = -1;
+        }
+    }
 
-                ux += cAdjacentUnits[i].h;
-                if ( ux < 0)
-                {
-                    ux += kProximitySuperSize;
-                    sx--;
-                } else if ( ux >= kProximitySuperSize)
-                {
-                    ux -= kProximitySuperSize;
-                    sx++;
-                }
+    int32_t capacity() const { return _capacity; }
 
-                uy += cAdjacentUnits[i].v;
-                if ( uy < 0)
-                {
-                    uy += kProximitySuperSize;
-                    sy--;
-                } else if ( uy >= kProximitySuperSize)
-                {
-                    uy -= kProximitySuperSize;
-                    sy++;
-                }
-                p->unitsToCheck[i].adjacentUnit = (uy << kProximityWidthMultiply) + ux;
-                p->unitsToCheck[i].adjacentUnit -= adjacentAdd;
+  private:
+    const int32_t _capacity;
 
+    DISALLOW_COPY_AND_ASSIGN(MotionState);
+};
 
-                adjacentAdd += p->unitsToCheck[i].adjacentUnit;
+scoped_ptr<MotionState> gMotionState;
 
-                p->unitsToCheck[i].superOffset.h = sx;
-                p->unitsToCheck[i].superOffset.v = sy;
-            }
-            p++;
+void GatherMotionState(MotionState* state, spaceObjectType* table, long tableLength) {
+    if (tableLength > state->capacity()) {
+        throw Exception("space object table is larger than motion state");
+    }
+    state->count = 0;
+    state->specialCount = 0;
+    state->hasBeams = false;
+    state->scrollStar = -1;
+    for (spaceObjectType* o = gRootObject; o != NULL; o = o->nextObject) {
+        if (o->active != kObjectInUse) {
+            continue;
+        }
+        const int32_t i = state->count++;
+        state->entry[o - table] = i;
+        state->object[i] = o;
+        state->attributes[i] = o->attributes;
+        state->active[i] = o->active;
+        state->direction[i] = o->direction;
+        state->turnVelocity[i] = o->turnVelocity;
+        state->turnFraction[i] = o->turnFraction;
+        state->thrust[i] = o->thrust;
+        state->maxVelocity[i] = o->maxVelocity;
+        if (/*( o->presenceState == kWarpInPresence) ||*/
+                (o->presenceState == kWarpingPresence) ||
+                (o->presenceState == kWarpOutPresence)) {
+            state->speed[i] = o->presenceData;
+        } else {
+            state->speed[i] = o->maxVelocity;
+        }
+        state->location[i] = o->location;
+        state->velocity[i] = o->velocity;
+        state->motionFraction[i] = o->motionFraction;
+        state->live[i] = i;
+        if (o->attributes & (kIsSelfAnimated | kIsBeam)) {
+            state->special[state->specialCount++] = i;
+            state->hasBeams = state->hasBeams || !(o->attributes & kIsSelfAnimated);
+        }
+        if (o == gScrollStarObject) {
+            state->scrollStar = i;
         }
     }
+    state->liveCount = state->count;
 }
 
-void ResetMotionGlobals( void)
-{
-    proximityUnitType   *proximityObject;
-    long                i;
-
-    gGlobalCorner.h = gGlobalCorner.v = 0;
-    globals()->gClosestObject = 0;
-    globals()->gFarthestObject = 0;
+void ScatterMotionState(MotionState* state, spaceObjectType* table) {
+    for (int32_t i = 0; i < state->count; ++i) {
+        spaceObjectType* o = state->object[i];
+        o->active = state->active[i];
+        o->direction = state->direction[i];
+        o->turnFraction = state->turnFraction[i];
+        o->location = state->location[i];
+        o->velocity = state->velocity[i];
+        o->motionFraction = state->motionFraction[i];
+        state->entry[o - table] = -1;
+    }
+    state->count = state->liveCount = state->specialCount = 0;
+}
 
-    proximityObject = gProximityGrid.get();
-    for ( i = 0; i < kProximityGridDataLength; i++)
-    {
-        proximityObject->nearObject = proximityObject->farObject = NULL;
-        proximityObject++;
+// The location of `target`, as seen by entry `i` while following it as a beam.  Objects are
+// moved in gRootObject order, so a target which comes before `i` has already been moved in this
+// sub-step, and a target which comes after it has not.
+const coordPointType& BeamTargetLocation(
+        const MotionState& state, spaceObjectType* table, int32_t i, spaceObjectType* target) {
+    const int32_t j = state.entry[target - table];
+    if (j < 0) {
+        return target->location;
+    } else if (j <= i) {
+        return state.location[j];
+    } else {
+        return state.lastLocation[j];
     }
 }
 
-void MotionCleanup() {
-    gProximityGrid.reset();
+short BeamTargetActive(const MotionState& state, spaceObjectType* table, spaceObjectType* target) {
+    const int32_t j = state.entry[target - table];
+    return (j < 0) ? target->active : state.active[j];
 }
 
-void MoveSpaceObjects( spaceObjectType *table, const long tableLength, const long unitsToDo)
+// Rounds a fixed-point fraction to the nearest whole number, with halves rounded away from zero.
+inline long RoundFraction(Fixed fraction) {
+    if (fraction >= 0) {
+        return more_evil_fixed_to_long(fraction + mFloatToFixed(0.5));
+    } else {
+        return more_evil_fixed_to_long(fraction - mFloatToFixed(0.5)) + 1;
+    }
+}
 
-{
-    long                    i, h, v, jl;
-    Fixed                   fh, fv, fa, fb, useThrust;
-    Fixed                   aFixed;
-    short                   angle;
-    unsigned long           shortDist, thisDist, longDist;
-    spaceObjectType         *anObject;
-    baseObjectType          *baseObject;
+// Turns and accelerates the first `count` entries in `state->moving`, and moves them by their
+// velocities.
+void MoveEntries(MotionState* state, int32_t count) {
+    const int32_t* moving = state->moving.get();
+
+    for (int32_t n = 0; n < count; ++n) {
+        const int32_t i = moving[n];
+        if (state->attributes[i] & kCanTurn) {
+            state->turnFraction[i] += state->turnVelocity[i];
+            const long h = RoundFraction(state->turnFraction[i]);
+            state->direction[i] += h;
+            state->turnFraction[i] -= mLongToFixed(h);
+
+            while (state->direction[i] >= ROT_POS) {
+                state->direction[i] -= ROT_POS;
+            }
+            while (state->direction[i] < 0) {
+                state->direction[i] += ROT_POS;
+            }
+        }
+    }
+
+    for (int32_t n = 0; n < count; ++n) {
+        const int32_t i = moving[n];
+        const Fixed thrust = state->thrust[i];
+        if (thrust == 0) {
+            continue;
+        }
+        fixedPointType& velocity = state->velocity[i];
+
+        // Find the difference between the velocity and the goal velocity: full speed ahead if
+        // thrust is positive, or a standstill if it is negative.
+        Fixed fa, fb;
+        Fixed useThrust;
+        if (thrust > 0) {
+            GetRotPoint(&fa, &fb, state->direction[i]);
+            fa = mMultiplyFixed(state->speed[i], fa);
+            fb = mMultiplyFixed(state->speed[i], fb);
+            useThrust = thrust;
+        } else {
+            fa = fb = 0;
+            useThrust = -thrust;
+        }
+        fa -= velocity.h;
+        fb -= velocity.v;
+
+        // Find the angle of the difference, and the most thrust possible at that angle.
+        int32_t angle;
+        if (fa == 0) {
+            angle = (fb < 0) ? 180 : 0;
+        } else {
+            // MyFixRatio() takes 16-bit arguments, and always has.  AngleFromSlopeBatch() searches
+            // the table where AngleFromSlope() scans it, so it is faster even for one slope.
+            const Fixed slope = MyFixRatio(fa, fb);
+            AngleFromSlopeBatch(&slope, &angle, 1);
+            if (fa > 0) {
+                angle += 180;
+            }
+            if (angle >= 360) {
+                angle -= 360;
+            }
+        }
+        Fixed fh, fv;
+        GetRotPoint(&fh, &fv, angle);
+        fh = mMultiplyFixed(useThrust, fh);
+        fv = mMultiplyFixed(useThrust, fv);
+
+        // If the difference exceeds the thrust possible, it must be limited.
+        if (fh < 0) {
+            if (fa < fh) {
+                fa = fh;
+            }
+        } else if (fa > fh) {
+            fa = fh;
+        }
+        if (fv < 0) {
+            if (fb < fv) {
+                fb = fv;
+            }
+        } else if (fb > fv) {
+            fb = fv;
+        }
+        velocity.h += fa;
+        velocity.v += fb;
+    }
 
-#pragma unused( table, tableLength)
+    for (int32_t n = 0; n < count; ++n) {
+        const int32_t i = moving[n];
+        fixedPointType& motionFraction = state->motionFraction[i];
+        coordPointType& location = state->location[i];
+        motionFraction.h += state->velocity[i].h;
+        motionFraction.v += state->velocity[i].v;
 
-    if ( unitsToDo == 0) return;
+        const long h = RoundFraction(motionFraction.h);
+        location.h -= h;
+        motionFraction.h -= mLongToFixed(h);
 
-    for ( jl = 0; jl < unitsToDo; jl++)
+        const long v = RoundFraction(motionFraction.v);
+        location.v -= v;
+        motionFraction.v -= mLongToFixed(v);
+    }
+}
+
+// Keeps entry `i` within the thinkiverse, either by bouncing it off the edge or by freeing it.
+inline void BoundEntry(MotionState* state, int32_t i) {
+    coordPointType& location = state->location[i];
+    fixedPointType& velocity = state->velocity[i];
+    if ( !(state->attributes[i] & kDoesBounce))
     {
-        anObject = gRootObject;
-        while ( anObject != NULL)
+        if (( location.h < kThinkiverseTopLeft) ||
+            ( location.v < kThinkiverseTopLeft) ||
+            ( location.h > kThinkiverseBottomRight) ||
+            ( location.v > kThinkiverseBottomRight))
         {
-            if ( anObject->active == kObjectInUse)
-            {
-                baseObject = anObject->baseType;
+            state->active[i] = kObjectToBeFreed;
+        }
+    } else
+    {
+        if ( location.h < kThinkiverseTopLeft)
+        {
+            location.h = kThinkiverseTopLeft;
+            velocity.h = -velocity.h;
+        } else if ( location.h > kThinkiverseBottomRight)
+        {
+            location.h = kThinkiverseBottomRight;
+            velocity.h = -velocity.h;
+        }
+        if ( location.v < kThinkiverseTopLeft)
+        {
+            location.v = kThinkiverseTopLeft;
+            velocity.v = -velocity.v;
+        } else if ( location.v > kThinkiverseBottomRight)
+        {
+            location.v = kThinkiverseBottomRight;
+            velocity.v = -velocity.v;
+        }
+    }
+}
 
-//              if  ( !( anObject->attributes & kIsStationary))
-                if (( anObject->maxVelocity != 0) || ( anObject->attributes & kCanTurn))
-                {
-                    if ( anObject->attributes & kCanTurn)
-                    {
-                        anObject->turnFraction += anObject->turnVelocity;
+void AnimateEntry(MotionState* state, int32_t i) {
+    spaceObjectType* anObject = state->object[i];
+    baseObjectType* baseObject = anObject->baseType;
+    long going;
 
-                        if ( anObject->turnFraction >= 0)
-                            h = more_evil_fixed_to_long(anObject->turnFraction + mFloatToFixed(0.5));
-                        else
-                            h = more_evil_fixed_to_long(anObject->turnFraction - mFloatToFixed(0.5)) + 1;
-                        anObject->direction += h;
-                        anObject->turnFraction -= mLongToFixed(h);
-
-                        while ( anObject->direction >= ROT_POS)
-                            anObject->direction -= ROT_POS;
-                        while ( anObject->direction < 0)
-                            anObject->direction += ROT_POS;
-                    }
+    if ( baseObject->frame.animation.frameSpeed != 0)
+    {
+        anObject->frame.animation.thisShape +=
+            anObject->frame.animation.frameDirection *
+            anObject->frame.animation.frameSpeed;// * unitsToDo;
+
+        going = 1;
+        while (( anObject->frame.animation.thisShape >
+            baseObject->frame.animation.lastShape) &&
+            ( anObject->frame.animation.frameDirection > 0) &&
+            ( going))
+        {
+            if ( state->attributes[i] & kAnimationCycle)
+            {
+                anObject->frame.animation.thisShape -=
+                    ( baseObject->frame.animation.lastShape -
+                    baseObject->frame.animation.firstShape) +
+                    1;
 
-                    if ( anObject->thrust != 0)
-                    {
-                        if ( anObject->thrust > 0)
-                        {
-                            // get the goal dh & dv
+            } else
+            {
+                going = 0;
+                state->active[i] = kObjectToBeFreed;
+                anObject->frame.animation.thisShape =
+                    baseObject->frame.animation.lastShape;
+            }
+        }
 
-                            GetRotPoint(&fa, &fb, anObject->direction);
+        while (( anObject->frame.animation.thisShape <
+            baseObject->frame.animation.firstShape) &&
+            ( anObject->frame.animation.frameDirection < 0) &&
+            ( going))
+        {
+            if ( state->attributes[i] & kAnimationCycle)
+            {
+                anObject->frame.animation.thisShape +=
+                    ( baseObject->frame.animation.lastShape -
+                    baseObject->frame.animation.firstShape) + 1;
 
-                            // multiply by max velocity
+            } else
+            {
+                going = 0;
+                state->active[i] = kObjectToBeFreed;
+                anObject->frame.animation.thisShape = baseObject->frame.animation.lastShape;
+            }
+        }
+    }
+}
 
-                            if (/*( anObject->presenceState == kWarpInPresence) ||*/
-                                ( anObject->presenceState == kWarpingPresence) ||
-                                ( anObject->presenceState == kWarpOutPresence))
-                            {
-                                fa = mMultiplyFixed( fa, anObject->presenceData);
-                                fb = mMultiplyFixed( fb, anObject->presenceData);
-                            } else
-                            {
-                                fa = mMultiplyFixed( anObject->maxVelocity, fa);
-                                fb = mMultiplyFixed( anObject->maxVelocity, fb);
-                            }
+void FollowBeamEntry(MotionState* state, spaceObjectType* table, int32_t i) {
+    spaceObjectType* anObject = state->object[i];
+    coordPointType& location = state->location[i];
+    if ( anObject->frame.beam.beam == NULL) {
+        throw Exception( "Unexpected error: a beam appears to be missing.");
+    }
+    beamType* beam = anObject->frame.beam.beam;
 
-                            // the difference between our actual vector and our goal vector is our new vector
+    beam->objectLocation = location;
+    if (( beam->beamKind == eStaticObjectToObjectKind) ||
+            ( beam->beamKind == eBoltObjectToObjectKind))
+    {
+        if ( beam->toObject != NULL)
+        {
+            spaceObjectType *target = beam->toObject;
 
-                            fa = fa - anObject->velocity.h;
-                            fb = fb - anObject->velocity.v;
+            if ((BeamTargetActive(*state, table, target)) &&
+                (target->id == beam->toObjectID))
+            {
+                location = beam->objectLocation =
+                    BeamTargetLocation(*state, table, i, target);
+            } else
+            {
+                state->active[i] = kObjectToBeFreed;
+            }
+        }
 
-                            useThrust = anObject->thrust;
-                        } else
-                        {
-                            fa = -anObject->velocity.h;
-                            fb = -anObject->velocity.v;
-//                              useThrust = -(anObject->thrust>>1L);
-                            useThrust = -anObject->thrust;
-                        }
+        if ( beam->fromObject != NULL)
+        {
+            spaceObjectType *target = beam->fromObject;
 
-                        // get the angle of our new vector
+            if ((BeamTargetActive(*state, table, target)) &&
+                ( target->id == beam->fromObjectID))
 
-                        if ( fa == 0)
-                        {
-                            if ( fb < 0)
-                                angle = 180;
-                            else angle = 0;
-                        } else
-                        {
-                            aFixed = MyFixRatio(fa, fb);
+            {
+                beam->lastGlobalLocation = beam->lastApparentLocation =
+                    BeamTargetLocation(*state, table, i, target);
+            } else
+            {
+                state->active[i] = kObjectToBeFreed;
+            }
+        }
+    } else if (( beam->beamKind == eStaticObjectToRelativeCoordKind) ||
+            ( beam->beamKind == eBoltObjectToRelativeCoordKind))
+    {
+        if ( beam->fromObject != NULL)
+        {
+            spaceObjectType *target = beam->fromObject;
 
-                            angle = AngleFromSlope( aFixed);
-                            if ( fa > 0) angle += 180;
-                            if ( angle >= 360) angle -= 360;
-                        }
+            if (( BeamTargetActive(*state, table, target)) &&
+                ( target->id == beam->fromObjectID))
+            {
+                const coordPointType& targetLocation =
+                    BeamTargetLocation(*state, table, i, target);
+                beam->lastGlobalLocation = beam->lastApparentLocation = targetLocation;
 
-                        // get the maxthrust of new vector
+                location.h = beam->objectLocation.h =
+                    targetLocation.h + beam->toRelativeCoord.h;
 
-                        GetRotPoint(&fh, &fv, angle);
+                location.v = beam->objectLocation.v =
+                    targetLocation.v + beam->toRelativeCoord.v;
+            } else
+            {
+                state->active[i] = kObjectToBeFreed;
+            }
+        }
+    } else
+    {
+//      beam->endLocation
+    }
+}
 
-                        fh = mMultiplyFixed( useThrust, fh);
-                        fv = mMultiplyFixed( useThrust, fv);
+}  // namespace
 
-                        // if our new vector excedes our max thrust, it must be limited
+void InitMotion() {
+    globals()->gCenterScaleH = (play_screen.width() / 2) * SCALE_SCALE;
+    globals()->gCenterScaleV = (play_screen.height() / 2) * SCALE_SCALE;
 
-                        if ( fh < 0)
-                        {
-                            if ( fa < fh)
-                                fa = fh;
-                        } else
-                        {
-                            if ( fa > fh)
-                                fa = fh;
-                        }
+    gCollisionGrid.reset(new SpatialHash(kCollisionUnitBitShift, kProximitySizeShift));
+    gDistanceGrid.reset(new SpatialHash(kDistanceUnitBitShift, kProximitySizeShift));
+    gMotionState.reset(new MotionState(gMaxSpaceObject));
+}
 
-                        if ( fv < 0)
-                        {
-                            if ( fb < fv)
-                                fb = fv;
-                        } else
-                        {
-                            if ( fb > fv)
-                                fb = fv;
-                        }
+void ResetMotionGlobals( void)
+{
+    gGlobalCorner.h = gGlobalCorner.v = 0;
+    globals()->gClosestObject = 0;
+    globals()->gFarthestObject = 0;
 
-                        anObject->velocity.h += fa;
-                        anObject->velocity.v += fb;
+    gCollisionGrid->clear();
+    gDistanceGrid->clear();
+}
 
-                    }
+void MotionCleanup() {
+    gCollisionGrid.reset();
+    gDistanceGrid.reset();
+    gMotionState.reset();
+}
 
-                    anObject->motionFraction.h += anObject->velocity.h;
-                    anObject->motionFraction.v += anObject->velocity.v;
+void MoveSpaceObjects( spaceObjectType *table, const long tableLength, const long unitsToDo)
 
-                    if ( anObject->motionFraction.h >= 0)
-                        h = more_evil_fixed_to_long(anObject->motionFraction.h + mFloatToFixed(0.5));
-                    else
-                        h = more_evil_fixed_to_long(anObject->motionFraction.h - mFloatToFixed(0.5)) + 1;
-                    anObject->location.h -= h;
-                    anObject->motionFraction.h -= mLongToFixed(h);
+{
+    long                    h, jl;
+    short                   angle;
+    unsigned long           shortDist, thisDist, longDist;
+    spaceObjectType         *anObject;
+    baseObjectType          *baseObject;
 
-                    if ( anObject->motionFraction.v >= 0)
-                        v = more_evil_fixed_to_long(anObject->motionFraction.v + mFloatToFixed(0.5));
-                    else
-                        v = more_evil_fixed_to_long(anObject->motionFraction.v - mFloatToFixed(0.5)) + 1;
-                    anObject->location.v -= v;
-                    anObject->motionFraction.v -= mLongToFixed(v);
+    if ( unitsToDo == 0) return;
 
-                } // if ( object is not stationary)
+    MotionState* state = gMotionState.get();
+    GatherMotionState(state, table, tableLength);
 
-//              if ( anObject->attributes & kIsPlayerShip)
-                if ( anObject == gScrollStarObject)
+    for ( jl = 0; jl < unitsToDo; jl++)
+    {
+        // Drop entries which were freed in the last sub-step, and pick out the ones which move.
+        int32_t liveCount = 0;
+        int32_t movingCount = 0;
+        for (int32_t n = 0; n < state->liveCount; ++n) {
+            const int32_t i = state->live[n];
+            if (state->active[i] == kObjectInUse) {
+                state->live[liveCount++] = i;
+//              if  ( !( anObject->attributes & kIsStationary))
+                if (( state->maxVelocity[i] != 0) || ( state->attributes[i] & kCanTurn))
                 {
-                    gGlobalCorner.h = anObject->location.h - (globals()->gCenterScaleH / gAbsoluteScale);
-                    gGlobalCorner.v = anObject->location.v - (globals()->gCenterScaleV / gAbsoluteScale);
+                    state->moving[movingCount++] = i;
                 }
+            }
+        }
+        state->liveCount = liveCount;
+        int32_t specialCount = 0;
+        for (int32_t n = 0; n < state->specialCount; ++n) {
+            const int32_t i = state->special[n];
+            if (state->active[i] == kObjectInUse) {
+                state->special[specialCount++] = i;
+            }
+        }
+        state->specialCount = specialCount;
 
-                // check to see if it's out of bounds
-
-                {
-                    if ( !(anObject->attributes & kDoesBounce))
-                    {
-                        if (( anObject->location.h < kThinkiverseTopLeft) ||
-                            ( anObject->location.v < kThinkiverseTopLeft) ||
-                            ( anObject->location.h > kThinkiverseBottomRight) ||
-                            ( anObject->location.v > kThinkiverseBottomRight))
-                        {
-                            anObject->active = kObjectToBeFreed;
-                        }
-                    } else
-                    {
-                        if ( anObject->location.h < kThinkiverseTopLeft)
-                        {
-                            anObject->location.h = kThinkiverseTopLeft;
-                            anObject->velocity.h = -anObject->velocity.h;
-                        } else if ( anObject->location.h > kThinkiverseBottomRight)
-                        {
-                            anObject->location.h = kThinkiverseBottomRight;
-                            anObject->velocity.h = -anObject->velocity.h;
-                        }
-                        if ( anObject->location.v < kThinkiverseTopLeft)
-                        {
-                            anObject->location.v = kThinkiverseTopLeft;
-                            anObject->velocity.v = -anObject->velocity.v;
-                        } else if ( anObject->location.v > kThinkiverseBottomRight)
-                        {
-                            anObject->location.v = kThinkiverseBottomRight;
-                            anObject->velocity.v = -anObject->velocity.v;
-                        }
-
-                    }
-                }
-
-                // deal with self-animating shapes
-                if ( anObject->attributes & kIsSelfAnimated)
-                {
-                    if ( baseObject->frame.animation.frameSpeed != 0)
-                    {
-                        anObject->frame.animation.thisShape +=
-                            anObject->frame.animation.frameDirection *
-                            anObject->frame.animation.frameSpeed;// * unitsToDo;
-
-                        i = 1;
-                        while (( anObject->frame.animation.thisShape >
-                            baseObject->frame.animation.lastShape) &&
-                            ( anObject->frame.animation.frameDirection > 0) &&
-                            ( i))
-                        {
-                            if ( anObject->attributes & kAnimationCycle)
-                            {
-                                anObject->frame.animation.thisShape -=
-                                    ( baseObject->frame.animation.lastShape -
-                                    baseObject->frame.animation.firstShape) +
-                                    1;
-
-                            } else
-                            {
-                                i = 0;
-                                anObject->active = kObjectToBeFreed;
-                                anObject->frame.animation.thisShape =
-                                    baseObject->frame.animation.lastShape;
-                            }
-                        }
-
-                        while (( anObject->frame.animation.thisShape <
-                            baseObject->frame.animation.firstShape) &&
-                            ( anObject->frame.animation.frameDirection < 0) &&
-                            ( i))
-                        {
-                            if ( anObject->attributes & kAnimationCycle)
-                            {
-                                anObject->frame.animation.thisShape +=
-                                    ( baseObject->frame.animation.lastShape -
-                                    baseObject->frame.animation.firstShape) + 1;
-
-                            } else
-                            {
-                                i = 0;
-                                anObject->active = kObjectToBeFreed;
-                                anObject->frame.animation.thisShape = baseObject->frame.animation.lastShape;
-                            }
-                        }
-                    }
-                } else if ( anObject->attributes & kIsBeam)
-                {
-                    if ( anObject->frame.beam.beam != NULL)
-                    {
-                        anObject->frame.beam.beam->objectLocation =
-                            anObject->location;
-                        if (( anObject->frame.beam.beam->beamKind ==
-                                eStaticObjectToObjectKind) ||
-                                ( anObject->frame.beam.beam->beamKind ==
-                                eBoltObjectToObjectKind))
-                        {
-                            if ( anObject->frame.beam.beam->toObject != NULL)
-                            {
-                                spaceObjectType *target =
-                                    anObject->frame.beam.beam->toObject;
-
-                                if ((target->active) &&
-                                    (target->id == anObject->frame.beam.beam->toObjectID))
-                                {
-                                    anObject->location =
-                                        anObject->frame.beam.beam->objectLocation =
-                                            target->location;
-                                } else
-                                {
-                                    anObject->active = kObjectToBeFreed;
-                                }
-                            }
-
-                            if ( anObject->frame.beam.beam->fromObject != NULL)
-                            {
-                                spaceObjectType *target =
-                                    anObject->frame.beam.beam->fromObject;
+        // Only beams look at where other entries were at the start of the sub-step.
+        if (state->hasBeams) {
+            memcpy(state->lastLocation.get(), state->location.get(),
+                    state->count * sizeof(coordPointType));
+        }
 
-                                if ((target->active) &&
-                                    ( target->id == anObject->frame.beam.beam->fromObjectID))
+        // Motion and bounds only involve the entry itself, so they can be done for all entries
+        // at once.
+        MoveEntries(state, movingCount);
 
-                                {
-                                    anObject->frame.beam.beam->lastGlobalLocation =
-                                        anObject->frame.beam.beam->lastApparentLocation =
-                                            target->location;
-                                } else
-                                {
-                                    anObject->active = kObjectToBeFreed;
-                                }
-                            }
-                        } else if (( anObject->frame.beam.beam->beamKind ==
-                                eStaticObjectToRelativeCoordKind) ||
-                                ( anObject->frame.beam.beam->beamKind ==
-                                eBoltObjectToRelativeCoordKind))
-                        {
-                            if ( anObject->frame.beam.beam->fromObject != NULL)
-                            {
-                                spaceObjectType *target =
-                                    anObject->frame.beam.beam->fromObject;
+        const int32_t scrollStar = state->scrollStar;
+        if ((scrollStar >= 0) && (state->active[scrollStar] == kObjectInUse)) {
+            const coordPointType& location = state->location[scrollStar];
+            gGlobalCorner.h = location.h - (globals()->gCenterScaleH / gAbsoluteScale);
+            gGlobalCorner.v = location.v - (globals()->gCenterScaleV / gAbsoluteScale);
+        }
+        for (int32_t n = 0; n < liveCount; ++n) {
+            BoundEntry(state, state->live[n]);
+        }
 
-                                if (( target->active) &&
-                                    ( target->id == anObject->frame.beam.beam->fromObjectID))
-                                {
-                                    anObject->frame.beam.beam->lastGlobalLocation =
-                                        anObject->frame.beam.beam->lastApparentLocation =
-                                            target->location;
-
-                                    anObject->location.h =
-                                        anObject->frame.beam.beam->objectLocation.h =
-                                        target->location.h +
-                                        anObject->frame.beam.beam->toRelativeCoord.h;
-
-                                    anObject->location.v =
-                                        anObject->frame.beam.beam->objectLocation.v =
-                                        target->location.v +
-                                        anObject->frame.beam.beam->toRelativeCoord.v;
-                                } else
-                                {
-                                    anObject->active = kObjectToBeFreed;
-                                }
-                            }
-                        } else
-                        {
-    //                      anObject->frame.beam.beam->endLocation
-                        }
-                    } else {
-                        throw Exception( "Unexpected error: a beam appears to be missing.");
-                    }
-                }
-            } // if (anObject->active)
-            anObject = anObject->nextObject;
+        // Animations and beams need the objects themselves, and beams look at the locations of
+        // other objects, so they are done in a second pass in gRootObject order.
+        for (int32_t n = 0; n < specialCount; ++n) {
+            const int32_t i = state->special[n];
+            if ( state->attributes[i] & kIsSelfAnimated)
+            {
+                AnimateEntry(state, i);
+            } else
+            {
+                FollowBeamEntry(state, table, i);
+            }
         }
     }
 
+    ScatterMotionState(state, table);
+
 // !!!!!!!!
 // nothing below can effect any object actions (expire actions get executed)
 // (but they can effect objects thinking)
@@ -599,17 +713,40 @@ void MoveSpaceObjects( spaceObjectType *table, const long tableLength, const lon
     }
 }
 
+// Threads the objects in each bucket of `grid` into a list through `next`, in bucket order.  The
+// admirals walk these lists (see HackGetObjectStrength()) to find the object in a cell which has
+// accumulated the cell's local strengths.
+static void LinkProximityLists(
+        spaceObjectType* table, const SpatialHash& grid,
+        spaceObjectTypePtr spaceObjectType::*next) {
+    for (int32_t bucket = 0; bucket < grid.bucket_count(); ++bucket) {
+        spaceObjectType* previous = NULL;
+        for (const SpatialHash::Entry* e = grid.begin(bucket); e != grid.end(bucket); ++e) {
+            spaceObjectType* object = table + e->index;
+            if (previous != NULL) {
+                previous->*next = object;
+            }
+            previous = object;
+        }
+        if (previous != NULL) {
+            previous->*next = NULL;
+        }
+    }
+}
+
 void CollideSpaceObjects( spaceObjectType *table, const long tableLength)
 
 {
     spaceObjectType         *sObject = NULL, *dObject = NULL, *aObject = NULL, *bObject = NULL,
-                            *player = NULL, *taObject, *tbObject;
-    long                    i = 0, j = 0, k, xs, xe, ys, ye, xd, yd, superx, supery, scaleCalc, difference;
+                            *player = NULL;
+    long                    i = 0, k, xs, xe, ys, ye, xd, yd, scaleCalc, difference;
     short                   cs, ce;
     bool                 beamHit;
     unsigned long           distance, dcalc/*,
                             closestDist = kMaximumRelevantDistanceSquared + kMaximumRelevantDistanceSquared*/;
-    proximityUnitType       *proximityObject, *currentProximity;
+    int32_t                 bucket, bBucket;
+    Point                   cell;
+    const SpatialHash::Entry *aEntry, *bEntry, *bEnd;
 
     long                    magicHack1 = 0, magicHack2 = 0, magicHack3 = 0;
     uint64_t                farthestDist, hugeDistance, wideScrap, closestDist;
@@ -624,12 +761,8 @@ void CollideSpaceObjects( spaceObjectType *table, const long tableLength)
     globals()->gFarthestObject = 0;
 
     // reset the collision grid
-    proximityObject = gProximityGrid.get();
-    for ( i = 0; i < kProximityGridDataLength; i++)
-    {
-        proximityObject->nearObject = proximityObject->farObject = NULL;
-        proximityObject++;
-    }
+    gCollisionGrid->clear();
+    gDistanceGrid->clear();
 
     aObject = gRootObject;
     if ( aObject == NULL) {
@@ -737,36 +870,13 @@ void CollideSpaceObjects( spaceObjectType *table, const long tableLength)
             aObject->closestDistance = kMaximumRelevantDistanceSquared;
             aObject->absoluteBounds.right = aObject->absoluteBounds.left = 0;
 
-            // xs = collision unit, xe = super unit
-            xs = aObject->location.h;
-            xs >>= kCollisionUnitBitShift;
-            xe = xs >> kCollisionSuperExtraShift;
-            xs &= kProximityUnitAndModulo;
-
-            ys = aObject->location.v;
-            ys >>= kCollisionUnitBitShift;
-            ye = ys >> kCollisionSuperExtraShift;
-            ys &= kProximityUnitAndModulo;
-
-            proximityObject = gProximityGrid.get() + (ys << kProximityWidthMultiply) + xs;
-            aObject->nextNearObject = proximityObject->nearObject;
-            proximityObject->nearObject = aObject;
-            aObject->collisionGrid.h = xe;
-            aObject->collisionGrid.v = ye;
-
-            xe >>= kDistanceUnitExtraShift;
-            xs = xe >> kDistanceSuperExtraShift;
-            xe &= kProximityUnitAndModulo;
-
-            ye >>= kDistanceUnitExtraShift;
-            ys = ye >> kDistanceSuperExtraShift;
-            ye &= kProximityUnitAndModulo;
-
-            proximityObject = gProximityGrid.get() + (ye << kProximityWidthMultiply) + xe;
-            aObject->nextFarObject = proximityObject->farObject;
-            proximityObject->farObject = aObject;
-            aObject->distanceGrid.h = xs;
-            aObject->distanceGrid.v = ys;
+            gCollisionGrid->add(aObject->entryNumber, aObject->location.h, aObject->location.v);
+            aObject->collisionGrid = gCollisionGrid->super_cell(
+                    gCollisionGrid->cell(aObject->location.h, aObject->location.v));
+
+            gDistanceGrid->add(aObject->entryNumber, aObject->location.h, aObject->location.v);
+            aObject->distanceGrid = gDistanceGrid->super_cell(
+                    gDistanceGrid->cell(aObject->location.h, aObject->location.v));
 
             if ( !(aObject->attributes & kIsDestination))
                 aObject->seenByPlayerFlags = 0x80000000;
@@ -795,399 +905,353 @@ void CollideSpaceObjects( spaceObjectType *table, const long tableLength)
         aObject = aObject->nextObject;
     }
 
-    proximityObject = gProximityGrid.get();
-    for ( j = 0; j < kProximitySuperSize; j++)
+    gCollisionGrid->sort();
+    gDistanceGrid->sort();
+    LinkProximityLists(table, *gCollisionGrid, &spaceObjectType::nextNearObject);
+    LinkProximityLists(table, *gDistanceGrid, &spaceObjectType::nextFarObject);
+
+    for ( bucket = 0; bucket < gCollisionGrid->bucket_count(); bucket++)
     {
-        for ( i = 0; i < kProximitySuperSize; i++)
+        for ( aEntry = gCollisionGrid->begin( bucket); aEntry != gCollisionGrid->end( bucket); aEntry++)
         {
-            aObject = proximityObject->nearObject;
-            while ( aObject != NULL)
-            {
-                taObject = aObject->nextNearObject;
-
-                // this hack is to get the current bounds of the object in question
-                // it could be sped up by accessing the sprite table directly
-                if ((aObject->absoluteBounds.left >= aObject->absoluteBounds.right)
-                        && (aObject->sprite != NULL)) {
-                    const NatePixTable::Frame& frame
-                        = aObject->sprite->table->at(aObject->sprite->whichShape);
-
-                    scaleCalc = (frame.width() * aObject->naturalScale);
-                    scaleCalc >>= SHIFT_SCALE;
-                    aObject->scaledSize.h = scaleCalc;
-                    scaleCalc = (frame.height() * aObject->naturalScale);
-                    scaleCalc >>= SHIFT_SCALE;
-                    aObject->scaledSize.v = scaleCalc;
-
-                    scaleCalc = frame.center().h * aObject->naturalScale;
-                    scaleCalc >>= SHIFT_SCALE;
-                    aObject->scaledCornerOffset.h = -scaleCalc;
-                    scaleCalc = frame.center().v * aObject->naturalScale;
-                    scaleCalc >>= SHIFT_SCALE;
-                    aObject->scaledCornerOffset.v = -scaleCalc;
-
-                    aObject->absoluteBounds.left = aObject->location.h +
-                                                aObject->scaledCornerOffset.h;
-                    aObject->absoluteBounds.right = aObject->absoluteBounds.left +
-                                                aObject->scaledSize.h;
-                    aObject->absoluteBounds.top = aObject->location.v +
-                                                aObject->scaledCornerOffset.v;
-                    aObject->absoluteBounds.bottom = aObject->absoluteBounds.top +
-                                                aObject->scaledSize.v;
-                }
+            aObject = table + aEntry->index;
+
+            // this hack is to get the current bounds of the object in question
+            // it could be sped up by accessing the sprite table directly
+            if ((aObject->absoluteBounds.left >= aObject->absoluteBounds.right)
+                    && (aObject->sprite != NULL)) {
+                const NatePixTable::Frame& frame
+                    = aObject->sprite->table->at(aObject->sprite->whichShape);
+
+                scaleCalc = (frame.width() * aObject->naturalScale);
+                scaleCalc >>= SHIFT_SCALE;
+                aObject->scaledSize.h = scaleCalc;
+                scaleCalc = (frame.height() * aObject->naturalScale);
+                scaleCalc >>= SHIFT_SCALE;
+                aObject->scaledSize.v = scaleCalc;
+
+                scaleCalc = frame.center().h * aObject->naturalScale;
+                scaleCalc >>= SHIFT_SCALE;
+                aObject->scaledCornerOffset.h = -scaleCalc;
+                scaleCalc = frame.center().v * aObject->naturalScale;
+                scaleCalc >>= SHIFT_SCALE;
+                aObject->scaledCornerOffset.v = -scaleCalc;
+
+                aObject->absoluteBounds.left = aObject->location.h +
+                                            aObject->scaledCornerOffset.h;
+                aObject->absoluteBounds.right = aObject->absoluteBounds.left +
+                                            aObject->scaledSize.h;
+                aObject->absoluteBounds.top = aObject->location.v +
+                                            aObject->scaledCornerOffset.v;
+                aObject->absoluteBounds.bottom = aObject->absoluteBounds.top +
+                                            aObject->scaledSize.v;
+            }
 
-                currentProximity = proximityObject;
-                for ( k = 0; k < kUnitsToCheckNumber; k++)
+            for ( k = 0; k < SpatialHash::kNeighborCount; k++)
+            {
+                cell = SpatialHash::neighbor_cell( aEntry->cell, k);
+                bBucket = gCollisionGrid->neighbor_bucket( bucket, k);
+                bEntry = ( k == 0) ? aEntry + 1 : gCollisionGrid->begin( bBucket);
+                bEnd = gCollisionGrid->end( bBucket);
+                if (( cell.h >= 0) && ( cell.v >= 0))
                 {
-                    if ( k == 0)
+                    for ( ; bEntry != bEnd; bEntry++)
                     {
-                        bObject = aObject->nextNearObject;
-                        superx = aObject->collisionGrid.h;
-                        supery = aObject->collisionGrid.v;
-                    }
-                    else
-                    {
-                        if (( proximityObject->unitsToCheck[k].adjacentUnit > 256) ||
-                            ( proximityObject->unitsToCheck[k].adjacentUnit < -256))
-                        {
-                            throw Exception(
-                                    "Internal error occurred during processing of adjacent "
-                                    "proximity units");
-                        }
-                        currentProximity += proximityObject->unitsToCheck[k].adjacentUnit;
-                        bObject = currentProximity->nearObject;
-                        superx = aObject->collisionGrid.h + proximityObject->unitsToCheck[k].superOffset.h;
-                        supery = aObject->collisionGrid.v + proximityObject->unitsToCheck[k].superOffset.v;
-                    }
-                    if (( superx >= 0) && ( supery >= 0))
-                    {
-                        while ( bObject != NULL)
+                        // cells which merely hash to the same bucket aren't neighbors
+                        if (( bEntry->cell.h != cell.h) || ( bEntry->cell.v != cell.v))
+                            continue;
+                        bObject = table + bEntry->index;
+
+                        // this'll be true even ONLY if BOTH objects are not non-physical dest object
+                        if ((( (bObject->attributes | aObject->attributes) & kCanCollide) &&
+                            (( bObject->attributes | aObject->attributes) & kCanBeHit))
+                            /*&& ( bObject->owner != aObject->owner)*/)
                         {
-
-                            tbObject = bObject->nextNearObject;
-                            // this'll be true even ONLY if BOTH objects are not non-physical dest object
-                            if ((( (bObject->attributes | aObject->attributes) & kCanCollide) &&
-                                (( bObject->attributes | aObject->attributes) & kCanBeHit)) &&
-                                /*( bObject->owner != aObject->owner) &&*/ ( bObject->collisionGrid.h ==
-                                superx) && ( bObject->collisionGrid.v == supery))
+                            // this hack is to get the current bounds of the object in question
+                            // it could be sped up by accessing the sprite table directly
+                            if ((bObject->absoluteBounds.left >= bObject->absoluteBounds.right)
+                                    && (bObject->sprite != NULL)) {
+                                const NatePixTable::Frame& frame
+                                    = bObject->sprite->table->at(bObject->sprite->whichShape);
+
+                                scaleCalc = (frame.width() * bObject->naturalScale);
+                                scaleCalc >>= SHIFT_SCALE;
+                                bObject->scaledSize.h = scaleCalc;
+                                scaleCalc = (frame.height() * bObject->naturalScale);
+                                scaleCalc >>= SHIFT_SCALE;
+                                bObject->scaledSize.v = scaleCalc;
+
+                                scaleCalc = frame.center().h * bObject->naturalScale;
+                                scaleCalc >>= SHIFT_SCALE;
+                                bObject->scaledCornerOffset.h = -scaleCalc;
+                                scaleCalc = frame.center().v * bObject->naturalScale;
+                                scaleCalc >>= SHIFT_SCALE;
+                                bObject->scaledCornerOffset.v = -scaleCalc;
+
+                                bObject->absoluteBounds.left = bObject->location.h +
+                                                            bObject->scaledCornerOffset.h;
+                                bObject->absoluteBounds.right = bObject->absoluteBounds.left +
+                                                            bObject->scaledSize.h;
+                                bObject->absoluteBounds.top = bObject->location.v +
+                                                            bObject->scaledCornerOffset.v;
+                                bObject->absoluteBounds.bottom = bObject->absoluteBounds.top +
+                                                            bObject->scaledSize.v;
+                            }
+                            if ( aObject->owner != bObject->owner)
                             {
-                                // this hack is to get the current bounds of the object in question
-                                // it could be sped up by accessing the sprite table directly
-                                if ((bObject->absoluteBounds.left >= bObject->absoluteBounds.right)
-                                        && (bObject->sprite != NULL)) {
-                                    const NatePixTable::Frame& frame
-                                        = bObject->sprite->table->at(bObject->sprite->whichShape);
-
-                                    scaleCalc = (frame.width() * bObject->naturalScale);
-                                    scaleCalc >>= SHIFT_SCALE;
-                                    bObject->scaledSize.h = scaleCalc;
-                                    scaleCalc = (frame.height() * bObject->naturalScale);
-                                    scaleCalc >>= SHIFT_SCALE;
-                                    bObject->scaledSize.v = scaleCalc;
-
-                                    scaleCalc = frame.center().h * bObject->naturalScale;
-                                    scaleCalc >>= SHIFT_SCALE;
-                                    bObject->scaledCornerOffset.h = -scaleCalc;
-                                    scaleCalc = frame.center().v * bObject->naturalScale;
-                                    scaleCalc >>= SHIFT_SCALE;
-                                    bObject->scaledCornerOffset.v = -scaleCalc;
-
-                                    bObject->absoluteBounds.left = bObject->location.h +
-                                                                bObject->scaledCornerOffset.h;
-                                    bObject->absoluteBounds.right = bObject->absoluteBounds.left +
-                                                                bObject->scaledSize.h;
-                                    bObject->absoluteBounds.top = bObject->location.v +
-                                                                bObject->scaledCornerOffset.v;
-                                    bObject->absoluteBounds.bottom = bObject->absoluteBounds.top +
-                                                                bObject->scaledSize.v;
-                                }
-                                if ( aObject->owner != bObject->owner)
-                                {
 //                                  bObject->foeStrength  += aObject->baseType->offenseValue;
-                                    if  (!(( bObject->attributes | aObject->attributes) & kIsBeam))
+                                if  (!(( bObject->attributes | aObject->attributes) & kIsBeam))
+                                {
+                                    dObject = aObject;
+                                    sObject = bObject;
+                                    if (!(( sObject->absoluteBounds.right < dObject->absoluteBounds.left) ||
+                                        ( sObject->absoluteBounds.left > dObject->absoluteBounds.right) ||
+                                        ( sObject->absoluteBounds.bottom < dObject->absoluteBounds.top) ||
+                                        ( sObject->absoluteBounds.top > dObject->absoluteBounds.bottom)))
+//                                  if ( aObject->entryNumber != 0)
+                                    {
+                                        if (( dObject->attributes & kCanBeHit) && ( sObject->attributes & kCanCollide))
+                                            HitObject( dObject, sObject);
+                                        if (( sObject->attributes & kCanBeHit) && ( dObject->attributes & kCanCollide))
+                                            HitObject( sObject, dObject);
+                                    }
+                                } else
+                                {
+                                    if ( bObject->attributes & kIsBeam)
                                     {
-                                        dObject = aObject;
                                         sObject = bObject;
-                                        if (!(( sObject->absoluteBounds.right < dObject->absoluteBounds.left) ||
-                                            ( sObject->absoluteBounds.left > dObject->absoluteBounds.right) ||
-                                            ( sObject->absoluteBounds.bottom < dObject->absoluteBounds.top) ||
-                                            ( sObject->absoluteBounds.top > dObject->absoluteBounds.bottom)))
-    //                                  if ( aObject->entryNumber != 0)
-                                        {
-                                            if (( dObject->attributes & kCanBeHit) && ( sObject->attributes & kCanCollide))
-                                                HitObject( dObject, sObject);
-                                            if (( sObject->attributes & kCanBeHit) && ( dObject->attributes & kCanCollide))
-                                                HitObject( sObject, dObject);
-                                        }
+                                        dObject = aObject;
                                     } else
                                     {
-                                        if ( bObject->attributes & kIsBeam)
-                                        {
-                                            sObject = bObject;
-                                            dObject = aObject;
-                                        } else
-                                        {
-                                            sObject = aObject;
-                                            dObject = bObject;
-                                        }
+                                        sObject = aObject;
+                                        dObject = bObject;
+                                    }
+
+                                    xs = sObject->location.h;
+                                    ys = sObject->location.v;
+                                    xe = sObject->frame.beam.beam->lastGlobalLocation.h;
+                                    ye = sObject->frame.beam.beam->lastGlobalLocation.v;
 
-                                        xs = sObject->location.h;
-                                        ys = sObject->location.v;
-                                        xe = sObject->frame.beam.beam->lastGlobalLocation.h;
-                                        ye = sObject->frame.beam.beam->lastGlobalLocation.v;
+                                    cs = mClipCode( xs, ys, dObject->absoluteBounds);
+                                    ce = mClipCode( xe, ye, dObject->absoluteBounds);
+                                    beamHit = true;
+                                    if ( sObject->active == kObjectToBeFreed)
+                                    {
+                                        cs = ce = 1;
+                                        beamHit = false;
+                                    }
 
-                                        cs = mClipCode( xs, ys, dObject->absoluteBounds);
-                                        ce = mClipCode( xe, ye, dObject->absoluteBounds);
-                                        beamHit = true;
-                                        if ( sObject->active == kObjectToBeFreed)
+                                    while ( cs | ce)
+                                    {
+                                        if ( cs & ce)
                                         {
-                                            cs = ce = 1;
                                             beamHit = false;
+                                            break;
                                         }
-
-                                        while ( cs | ce)
+                                        xd = xe - xs;
+                                        yd = ye - ys;
+                                        if ( cs)
                                         {
-                                            if ( cs & ce)
+                                            if ( cs & 8)
                                             {
-                                                beamHit = false;
-                                                break;
-                                            }
-                                            xd = xe - xs;
-                                            yd = ye - ys;
-                                            if ( cs)
+                                                ys += yd * ( dObject->absoluteBounds.left - xs) / xd;
+                                                xs = dObject->absoluteBounds.left;
+                                            } else
+                                            if ( cs & 4)
                                             {
-                                                if ( cs & 8)
-                                                {
-                                                    ys += yd * ( dObject->absoluteBounds.left - xs) / xd;
-                                                    xs = dObject->absoluteBounds.left;
-                                                } else
-                                                if ( cs & 4)
-                                                {
-                                                    ys += yd * ( dObject->absoluteBounds.right - 1 - xs) / xd;
-                                                    xs = dObject->absoluteBounds.right - 1;
-                                                } else
-                                                if ( cs & 2)
-                                                {
-                                                    xs += xd * ( dObject->absoluteBounds.top - ys) / yd;
-                                                    ys = dObject->absoluteBounds.top;
-                                                } else
-                                                if ( cs & 1)
-                                                {
-                                                    xs += xd * ( dObject->absoluteBounds.bottom - 1 - ys) / yd;
-                                                    ys = dObject->absoluteBounds.bottom - 1;
-                                                }
-                                                cs = mClipCode( xs, ys, dObject->absoluteBounds);
-                                            } else if ( ce)
+                                                ys += yd * ( dObject->absoluteBounds.right - 1 - xs) / xd;
+                                                xs = dObject->absoluteBounds.right - 1;
+                                            } else
+                                            if ( cs & 2)
                                             {
-                                                if ( ce & 8)
-                                                {
-                                                    ye += yd * ( dObject->absoluteBounds.left - xe) / xd;
-                                                    xe = dObject->absoluteBounds.left;
-                                                } else
-                                                if ( ce & 4)
-                                                {
-                                                    ye += yd * ( dObject->absoluteBounds.right - 1 - xe) / xd;
-                                                    xe = dObject->absoluteBounds.right - 1;
-                                                } else
-                                                if ( ce & 2)
-                                                {
-                                                    xe += xd * ( dObject->absoluteBounds.top - ye) / yd;
-                                                    ye = dObject->absoluteBounds.top;
-                                                } else
-                                                if ( ce & 1)
-                                                {
-                                                    xe += xd * ( dObject->absoluteBounds.bottom - 1 - ye) / yd;
-                                                    ye = dObject->absoluteBounds.bottom - 1;
-                                                }
-                                                ce = mClipCode( xe, ye, dObject->absoluteBounds);
+                                                xs += xd * ( dObject->absoluteBounds.top - ys) / yd;
+                                                ys = dObject->absoluteBounds.top;
+                                            } else
+                                            if ( cs & 1)
+                                            {
+                                                xs += xd * ( dObject->absoluteBounds.bottom - 1 - ys) / yd;
+                                                ys = dObject->absoluteBounds.bottom - 1;
                                             }
-                                        }
-                                        if ( beamHit)
+                                            cs = mClipCode( xs, ys, dObject->absoluteBounds);
+                                        } else if ( ce)
                                         {
-                                            HitObject( dObject, sObject);
+                                            if ( ce & 8)
+                                            {
+                                                ye += yd * ( dObject->absoluteBounds.left - xe) / xd;
+                                                xe = dObject->absoluteBounds.left;
+                                            } else
+                                            if ( ce & 4)
+                                            {
+                                                ye += yd * ( dObject->absoluteBounds.right - 1 - xe) / xd;
+                                                xe = dObject->absoluteBounds.right - 1;
+                                            } else
+                                            if ( ce & 2)
+                                            {
+                                                xe += xd * ( dObject->absoluteBounds.top - ye) / yd;
+                                                ye = dObject->absoluteBounds.top;
+                                            } else
+                                            if ( ce & 1)
+                                            {
+                                                xe += xd * ( dObject->absoluteBounds.bottom - 1 - ye) / yd;
+                                                ye = dObject->absoluteBounds.bottom - 1;
+                                            }
+                                            ce = mClipCode( xe, ye, dObject->absoluteBounds);
                                         }
                                     }
-                                } else
-                                {
-//                                  bObject->friendStrength += aObject->baseType->offenseValue;
-//                                  bObject->friendStrength += kFixedOne;
-                                }
-
-                                // check to see if the 2 objects occupy same physical space
-                                if  (((bObject->attributes & aObject->attributes) & kOccupiesSpace) &&
-                                    ( bObject->owner != aObject->owner))
-                                {
-                                    dObject = aObject;
-                                    sObject = bObject;
-                                    if (!(( sObject->absoluteBounds.right < dObject->absoluteBounds.left) ||
-                                        ( sObject->absoluteBounds.left > dObject->absoluteBounds.right) ||
-                                        ( sObject->absoluteBounds.bottom < dObject->absoluteBounds.top) ||
-                                        ( sObject->absoluteBounds.top > dObject->absoluteBounds.bottom)))
-                                    {
-                                        CorrectPhysicalSpace( aObject, bObject); // move them back till they don't touch
-                                    } else
+                                    if ( beamHit)
                                     {
-                                        aObject->collideObject = bObject->collideObject = NULL;
+                                        HitObject( dObject, sObject);
                                     }
                                 }
-                            // one or both objects is non-physical
-                            } else if (( bObject->collisionGrid.h ==
-                                superx) && ( bObject->collisionGrid.v == supery))
+                            } else
                             {
-                                if ( aObject->owner != bObject->owner)
+//                                  bObject->friendStrength += aObject->baseType->offenseValue;
+//                                  bObject->friendStrength += kFixedOne;
+                            }
+
+                            // check to see if the 2 objects occupy same physical space
+                            if  (((bObject->attributes & aObject->attributes) & kOccupiesSpace) &&
+                                ( bObject->owner != aObject->owner))
+                            {
+                                dObject = aObject;
+                                sObject = bObject;
+                                if (!(( sObject->absoluteBounds.right < dObject->absoluteBounds.left) ||
+                                    ( sObject->absoluteBounds.left > dObject->absoluteBounds.right) ||
+                                    ( sObject->absoluteBounds.bottom < dObject->absoluteBounds.top) ||
+                                    ( sObject->absoluteBounds.top > dObject->absoluteBounds.bottom)))
                                 {
-//                                  bObject->foeStrength  += aObject->baseType->offenseValue;
+                                    CorrectPhysicalSpace( aObject, bObject); // move them back till they don't touch
                                 } else
                                 {
-//                                  bObject->friendStrength += aObject->baseType->offenseValue;
-//                                  bObject->friendStrength += kFixedOne;
+                                    aObject->collideObject = bObject->collideObject = NULL;
                                 }
                             }
-                            bObject = tbObject;
                         }
                     }
                 }
-                aObject = taObject;
             }
-            proximityObject++;
         }
     }
 
-    proximityObject = gProximityGrid.get();
-    for ( j = 0; j < kProximitySuperSize; j++)
+    for ( bucket = 0; bucket < gDistanceGrid->bucket_count(); bucket++)
     {
-        for ( i = 0; i < kProximitySuperSize; i++)
+        for ( aEntry = gDistanceGrid->begin( bucket); aEntry != gDistanceGrid->end( bucket); aEntry++)
         {
-            aObject = proximityObject->farObject;
-            while ( aObject != NULL)
+            aObject = table + aEntry->index;
+//          aObject->friendStrength += aObject->baseType->offenseValue;
+//          aObject->friendStrength += kFixedOne;
+            for ( k = 0; k < SpatialHash::kNeighborCount; k++)
             {
-//              aObject->friendStrength += aObject->baseType->offenseValue;
-//              aObject->friendStrength += kFixedOne;
-                taObject = aObject->nextFarObject;
-                currentProximity = proximityObject;
-                for ( k = 0; k < kUnitsToCheckNumber; k++)
+                cell = SpatialHash::neighbor_cell( aEntry->cell, k);
+                bBucket = gDistanceGrid->neighbor_bucket( bucket, k);
+                bEntry = ( k == 0) ? aEntry + 1 : gDistanceGrid->begin( bBucket);
+                bEnd = gDistanceGrid->end( bBucket);
+                if (( cell.h >= 0) && ( cell.v >= 0))
                 {
-                    if ( k == 0)
-                    {
-                        bObject = aObject->nextFarObject;
-                        superx = aObject->distanceGrid.h;
-                        supery = aObject->distanceGrid.v;
-                    }
-                    else
-                    {
-                        currentProximity += proximityObject->unitsToCheck[k].adjacentUnit;
-                        bObject = currentProximity->farObject;
-                        superx = aObject->distanceGrid.h + proximityObject->unitsToCheck[k].superOffset.h;
-                        supery = aObject->distanceGrid.v + proximityObject->unitsToCheck[k].superOffset.v;
-                    }
-                    if (( superx >= 0) && ( supery >= 0))
+                    for ( ; bEntry != bEnd; bEntry++)
                     {
-                        while ( bObject != NULL)
+                        // cells which merely hash to the same bucket aren't neighbors
+                        if (( bEntry->cell.h != cell.h) || ( bEntry->cell.v != cell.v))
+                            continue;
+                        bObject = table + bEntry->index;
+
+                        if (( bObject->owner != aObject->owner) &&
+                            (( bObject->attributes & kCanThink) ||
+                            ( bObject->attributes & kRemoteOrHuman) ||
+                            ( bObject->attributes & kHated)) &&
+                            (( aObject->attributes & kCanThink) ||
+                            ( aObject->attributes & kRemoteOrHuman) ||
+                            ( aObject->attributes & kHated)) /*&&
+                            ( !(( aObject->attributes & bObject->attributes) & kIsGuided))*/)
                         {
-                            tbObject = bObject->nextFarObject;
-                            if (( bObject->owner != aObject->owner) && ( bObject->distanceGrid.h ==
-                                superx) && ( bObject->distanceGrid.v == supery) &&
-                                (( bObject->attributes & kCanThink) ||
-                                ( bObject->attributes & kRemoteOrHuman) ||
-                                ( bObject->attributes & kHated)) &&
-                                (( aObject->attributes & kCanThink) ||
-                                ( aObject->attributes & kRemoteOrHuman) ||
-                                ( aObject->attributes & kHated)) /*&&
-                                ( !(( aObject->attributes & bObject->attributes) & kIsGuided))*/)
+                            difference = ABS<int>( bObject->location.h - aObject->location.h);
+                            dcalc = difference;
+                            difference =  ABS<int>( bObject->location.v - aObject->location.v);
+                            distance = difference;
+                            if (( dcalc > kMaximumRelevantDistance) ||
+                                ( distance > kMaximumRelevantDistance))
+                                distance = kMaximumRelevantDistanceSquared;
+                            else distance = distance * distance + dcalc * dcalc;
+
+                            if ( distance < kMaximumRelevantDistanceSquared)
                             {
-                                difference = ABS<int>( bObject->location.h - aObject->location.h);
-                                dcalc = difference;
-                                difference =  ABS<int>( bObject->location.v - aObject->location.v);
-                                distance = difference;
-                                if (( dcalc > kMaximumRelevantDistance) ||
-                                    ( distance > kMaximumRelevantDistance))
-                                    distance = kMaximumRelevantDistanceSquared;
-                                else distance = distance * distance + dcalc * dcalc;
-
-                                if ( distance < kMaximumRelevantDistanceSquared)
-                                {
-                                    aObject->seenByPlayerFlags |= bObject->myPlayerFlag;
-                                    bObject->seenByPlayerFlags |= aObject->myPlayerFlag;
+                                aObject->seenByPlayerFlags |= bObject->myPlayerFlag;
+                                bObject->seenByPlayerFlags |= aObject->myPlayerFlag;
 
-                                    if ( bObject->attributes & kHideEffect)
-                                    {
-                                        aObject->runTimeFlags |= kIsHidden;
-                                    }
+                                if ( bObject->attributes & kHideEffect)
+                                {
+                                    aObject->runTimeFlags |= kIsHidden;
+                                }
 
-                                    if ( aObject->attributes & kHideEffect)
-                                    {
-                                        bObject->runTimeFlags |= kIsHidden;
-                                    }
+                                if ( aObject->attributes & kHideEffect)
+                                {
+                                    bObject->runTimeFlags |= kIsHidden;
                                 }
+                            }
 
-                                if  (
+                            if  (
+                                    (
+                                        (aObject->baseType->buildFlags & kCanOnlyEngage) ||
+                                        (bObject->baseType->buildFlags & kOnlyEngagedBy)
+                                    ) &&
+                                    (
                                         (
-                                            (aObject->baseType->buildFlags & kCanOnlyEngage) ||
-                                            (bObject->baseType->buildFlags & kOnlyEngagedBy)
-                                        ) &&
+                                            (aObject->baseType->buildFlags & kEngageKeyTagMask)
+                                            << kEngageKeyTagShift
+                                        ) !=
                                         (
-                                            (
-                                                (aObject->baseType->buildFlags & kEngageKeyTagMask)
-                                                << kEngageKeyTagShift
-                                            ) !=
-                                            (
-                                                bObject->baseType->buildFlags & kLevelKeyTagMask
-                                            )
+                                            bObject->baseType->buildFlags & kLevelKeyTagMask
                                         )
-                                    ) goto hackANoEngageMatch;
+                                    )
+                                ) goto hackANoEngageMatch;
 
-                                if (( distance < aObject->closestDistance) && (bObject->attributes & kPotentialTarget))
-                                {
-                                    aObject->closestDistance = distance;
-                                    aObject->closestObject = bObject->entryNumber;
-                                }
+                            if (( distance < aObject->closestDistance) && (bObject->attributes & kPotentialTarget))
+                            {
+                                aObject->closestDistance = distance;
+                                aObject->closestObject = bObject->entryNumber;
+                            }
 
-                            hackANoEngageMatch:
-                                if  (
+                        hackANoEngageMatch:
+                            if  (
+                                    (
+                                        (bObject->baseType->buildFlags & kCanOnlyEngage) ||
+                                        (aObject->baseType->buildFlags & kOnlyEngagedBy)
+                                    ) &&
+                                    (
                                         (
-                                            (bObject->baseType->buildFlags & kCanOnlyEngage) ||
-                                            (aObject->baseType->buildFlags & kOnlyEngagedBy)
-                                        ) &&
+                                            (bObject->baseType->buildFlags & kEngageKeyTagMask)
+                                            << kEngageKeyTagShift
+                                        ) !=
                                         (
-                                            (
-                                                (bObject->baseType->buildFlags & kEngageKeyTagMask)
-                                                << kEngageKeyTagShift
-                                            ) !=
-                                            (
-                                                aObject->baseType->buildFlags & kLevelKeyTagMask
-                                            )
+                                            aObject->baseType->buildFlags & kLevelKeyTagMask
                                         )
-                                    ) goto hackBNoEngageMatch;
+                                    )
+                                ) goto hackBNoEngageMatch;
 
-                                if (( distance < bObject->closestDistance) && ( aObject->attributes & kPotentialTarget))
-                                {
-                                    bObject->closestDistance = distance;
-                                    bObject->closestObject = aObject->entryNumber;
-                                }
-                            hackBNoEngageMatch:
+                            if (( distance < bObject->closestDistance) && ( aObject->attributes & kPotentialTarget))
+                            {
+                                bObject->closestDistance = distance;
+                                bObject->closestObject = aObject->entryNumber;
+                            }
+                        hackBNoEngageMatch:
+                            bObject->localFoeStrength += aObject->localFriendStrength;
+                            bObject->localFriendStrength += aObject->localFoeStrength;
+
+                        } else if ( k == 0)
+                        {
+                            if ( aObject->owner != bObject->owner)
+                            {
                                 bObject->localFoeStrength += aObject->localFriendStrength;
                                 bObject->localFriendStrength += aObject->localFoeStrength;
-
-                            } else if (( bObject->distanceGrid.h ==
-                                superx) && ( bObject->distanceGrid.v == supery) && ( k == 0))
+                            } else
                             {
-                                if ( aObject->owner != bObject->owner)
-                                {
-                                    bObject->localFoeStrength += aObject->localFriendStrength;
-                                    bObject->localFriendStrength += aObject->localFoeStrength;
-                                } else
-                                {
-                                    bObject->localFoeStrength += aObject->localFoeStrength;
-                                    bObject->localFriendStrength += aObject->localFriendStrength;
-                                }
+                                bObject->localFoeStrength += aObject->localFoeStrength;
+                                bObject->localFriendStrength += aObject->localFriendStrength;
                             }
-                            bObject = tbObject;
                         }
                     }
                 }
-                aObject = taObject;
             }
-            proximityObject++;
         }
     }
 
@@ -1205,7 +1269,7 @@ void CollideSpaceObjects( spaceObjectType *table, const long tableLength)
                 {
                     aObject->frame.beam.beam->killMe = true;
                 }
-                aObject->active = kObjectAvailable;
+                ReleaseSpaceObjectSlot( aObject);
                 aObject->attributes = 0;
                 aObject->nextNearObject = aObject->nextFarObject = NULL;
                 if ( aObject->previousObject != NULL)
@@ -1231,7 +1295,7 @@ void CollideSpaceObjects( spaceObjectType *table, const long tableLength)
                 aObject->previousObjectNumber = -1;
             }else
             {
-                aObject->active = kObjectAvailable;
+                ReleaseSpaceObjectSlot( aObject);
                 if ( aObject->sprite != NULL)
                 {
                     aObject->sprite->killMe = true;
@@ -2338,7 +2338,7 @@ long GetSpritePointSelectObject( Rect *bounds, spaceObjectType *sourceObject, un
 
     anObject = gSpaceObjectData.get();
 
-    for ( whichShip = 0; whichShip < kMaxSpaceObject; whichShip++)
+    for ( whichShip = 0; whichShip < gMaxSpaceObject; whichShip++)
     {
         if (( anObject->active) && ( anObject->sprite != NULL) &&
             ( anObject->seenByPlayerFlags & myOwnerFlag) &&
@@ -36,6 +36,7 @@
 #include "game/minicomputer.hpp"
 #include "game/non-player-ship.hpp"
 #include "game/scenario-maker.hpp"
+#include "game/snapshot.hpp"
 #include "game/space-object.hpp"
 #include "game/starfield.hpp"
 #include "math/macros.hpp"
@@ -44,8 +45,9 @@
 #include "math/units.hpp"
 #include "sound/fx.hpp"
 
-using sfz::Exception;
+using sfz::Bytes;
 using sfz::BytesSlice;
+using sfz::Exception;
 using sfz::PrintTarget;
 using sfz::String;
 using sfz::StringSlice;
@@ -130,6 +132,54 @@ void ResetPlayerShip(long which) {
     globals()->hotKey_target = false;
 }
 
+void SavePlayerShip(Bytes* out) {
+    aresGlobalType* const g = globals();
+    save_raw(out, &g->gPlayerShipNumber);
+    save_raw(out, &g->gAutoPilotOff);
+    save_raw(out, &g->keyMask);
+    save_raw(out, &g->gLastMessageKeyMap);
+    save_raw(out, &g->gZoomMode);
+    save_raw(out, g->gKeyMapBuffer, kKeyMapBufferNum);
+    save_raw(out, &g->gKeyMapBufferTop);
+    save_raw(out, &g->gKeyMapBufferBottom);
+    save_raw(out, g->hotKey, kHotKeyNum);
+    save_raw(out, &g->hotKeyDownTime);
+    save_raw(out, &g->lastHotKey);
+    save_raw(out, &g->lastSelectedObject);
+    save_raw(out, &g->lastSelectedObjectID);
+    save_raw(out, &g->destKeyUsedForSelection);
+    save_raw(out, &g->hotKey_target);
+    save_raw(out, &gLastKeyMap);
+    save_raw(out, &gLastKeys);
+    save_raw(out, &gTheseKeys);
+    save_raw(out, &gDestKeyTime);
+    save_raw(out, &gAlarmCount);
+}
+
+void RestorePlayerShip(BytesSlice* in) {
+    aresGlobalType* const g = globals();
+    restore_raw(in, &g->gPlayerShipNumber);
+    restore_raw(in, &g->gAutoPilotOff);
+    restore_raw(in, &g->keyMask);
+    restore_raw(in, &g->gLastMessageKeyMap);
+    restore_raw(in, &g->gZoomMode);
+    restore_raw(in, g->gKeyMapBuffer, kKeyMapBufferNum);
+    restore_raw(in, &g->gKeyMapBufferTop);
+    restore_raw(in, &g->gKeyMapBufferBottom);
+    restore_raw(in, g->hotKey, kHotKeyNum);
+    restore_raw(in, &g->hotKeyDownTime);
+    restore_raw(in, &g->lastHotKey);
+    restore_raw(in, &g->lastSelectedObject);
+    restore_raw(in, &g->lastSelectedObjectID);
+    restore_raw(in, &g->destKeyUsedForSelection);
+    restore_raw(in, &g->hotKey_target);
+    restore_raw(in, &gLastKeyMap);
+    restore_raw(in, &gLastKeys);
+    restore_raw(in, &gTheseKeys);
+    restore_raw(in, &gDestKeyTime);
+    restore_raw(in, &gAlarmCount);
+}
+
 bool PlayerShipGetKeys(int32_t timePass, InputSource& input_source, bool *enterMessage) {
     KeyMap          keyMap, *bufMap;
     short           friendOrFoe;
@@ -0,0 +1,183 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "game/profiler.hpp"
+
+#include <fcntl.h>
+#include <time.h>
+#include <sfz/sfz.hpp>
+
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#endif
+
+using sfz::ScopedFd;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::dec;
+using sfz::format;
+using sfz::print;
+using sfz::scoped_array;
+
+namespace utf8 = sfz::utf8;
+
+namespace antares {
+
+namespace {
+
+const char* const kPhaseNames[PROFILE_PHASE_COUNT] = {
+    "starfield",
+    "move",
+    "nonplayer-think",
+    "admiral-think",
+    "action-queue",
+    "player-keys",
+    "collide",
+    "scenario",
+    "update",
+    "draw",
+};
+
+struct ProfileCycle {
+    int64_t game_time;
+    int64_t nsecs[PROFILE_PHASE_COUNT];
+};
+
+scoped_array<ProfileCycle> gCycles;
+int64_t gCycleCount;                        // cycles recorded since reset()
+ProfileCycle gCurrent;
+ProfileCycle gEnded;                        // ended, but still taking frame phases
+bool gHaveEnded;
+int64_t gTotals[PROFILE_PHASE_COUNT];
+
+void clear_cycle(ProfileCycle* cycle) {
+    cycle->game_time = 0;
+    for (int i = 0; i < PROFILE_PHASE_COUNT; ++i) {
+        cycle->nsecs[i] = 0;
+    }
+}
+
+bool is_frame_phase(ProfilePhase phase) {
+    return (phase == PROFILE_UPDATE) || (phase == PROFILE_DRAW);
+}
+
+void record_ended() {
+    if (!gHaveEnded) {
+        return;
+    }
+    for (int i = 0; i < PROFILE_PHASE_COUNT; ++i) {
+        gTotals[i] += gEnded.nsecs[i];
+    }
+    gCycles[gCycleCount % Profiler::kProfileCycleCount] = gEnded;
+    ++gCycleCount;
+    gHaveEnded = false;
+}
+
+void write_text(const StringSlice& path, const String& text) {
+    ScopedFd fd(open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    write(fd, utf8::encode(text));
+}
+
+}  // namespace
+
+bool Profiler::_enabled = false;
+
+void Profiler::set_enabled(bool enabled) {
+    if (enabled && !gCycles.get()) {
+        gCycles.reset(new ProfileCycle[kProfileCycleCount]);
+        reset();
+    }
+    _enabled = enabled;
+}
+
+void Profiler::reset() {
+    gCycleCount = 0;
+    clear_cycle(&gCurrent);
+    gHaveEnded = false;
+    for (int i = 0; i < PROFILE_PHASE_COUNT; ++i) {
+        gTotals[i] = 0;
+    }
+}
+
+void Profiler::add(ProfilePhase phase, int64_t nsecs) {
+    if (gHaveEnded && is_frame_phase(phase)) {
+        gEnded.nsecs[phase] += nsecs;
+    } else {
+        gCurrent.nsecs[phase] += nsecs;
+    }
+}
+
+void Profiler::end_cycle(int64_t game_time) {
+    if (!_enabled) {
+        return;
+    }
+    record_ended();
+    gCurrent.game_time = game_time;
+    gEnded = gCurrent;
+    gHaveEnded = true;
+    clear_cycle(&gCurrent);
+}
+
+void Profiler::write_csv(const StringSlice& path) {
+    record_ended();
+    String text("cycle,game_time");
+    for (int i = 0; i < PROFILE_PHASE_COUNT; ++i) {
+        print(text, format(",{0}", kPhaseNames[i]));
+    }
+    text.append(1, '\n');
+
+    const int64_t first = (gCycleCount > kProfileCycleCount)
+        ? (gCycleCount - kProfileCycleCount) : 0;
+    for (int64_t n = first; n < gCycleCount; ++n) {
+        const ProfileCycle& cycle = gCycles[n % kProfileCycleCount];
+        print(text, format("{0},{1}", dec(n, 0), dec(cycle.game_time, 0)));
+        for (int i = 0; i < PROFILE_PHASE_COUNT; ++i) {
+            print(text, format(",{0}", dec(cycle.nsecs[i], 0)));
+        }
+        text.append(1, '\n');
+    }
+    write_text(path, text);
+}
+
+void Profiler::write_folded(const StringSlice& path) {
+    record_ended();
+    String text;
+    for (int i = 0; i < PROFILE_PHASE_COUNT; ++i) {
+        if (gTotals[i] > 0) {
+            print(text, format("GamePlay;{0} {1}\n", kPhaseNames[i], dec(gTotals[i], 0)));
+        }
+    }
+    write_text(path, text);
+}
+
+int64_t Profiler::now_nsecs() {
+#ifdef __APPLE__
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return (mach_absolute_time() * timebase.numer) / timebase.denom;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ll) + ts.tv_nsec;
+#endif
+}
+
+}  // namespace antares
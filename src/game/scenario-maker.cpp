@@ -38,6 +38,8 @@
 #include "game/motion.hpp"
 #include "game/non-player-ship.hpp"
 #include "game/player-ship.hpp"
+#include "game/profiler.hpp"
+#include "game/snapshot.hpp"
 #include "game/space-object.hpp"
 #include "game/starfield.hpp"
 #include "lang/casts.hpp"
@@ -81,6 +83,11 @@ vector<Scenario::Condition> gScenarioConditionData;
 vector<Scenario::BriefPoint> gScenarioBriefData;
 int32_t gScenarioRotation = 0;
 int32_t gAdmiralNumbers[kMaxPlayerNum];
+int64_t gScenarioLoadNsecs = 0;
+
+// The pix tables found to be needed by AddBaseObjectMedia() and friends.  ConstructScenario() loads
+// them all at once when it has found them all, since they can be decoded in parallel.
+vector<int16_t> gNeededPixTables;
 
 void CheckActionMedia(int32_t whichAction, int32_t actionNum, uint8_t color);
 void AddBaseObjectActionMedia(int32_t whichBase, int32_t whichType, uint8_t color);
@@ -225,11 +232,11 @@ void AddBaseObjectMedia(int32_t whichBase, uint8_t color) {
         {
             if ( aBase->attributes & kCanThink)
             {
-                AddPixTable( aBase->pixResID +
+                gNeededPixTables.push_back( aBase->pixResID +
                     (color << kSpriteTableColorShift));
             } else
             {
-                AddPixTable( aBase->pixResID);      // moves mem
+                gNeededPixTables.push_back( aBase->pixResID);
             }
             aBase = mGetBaseObjectPtr( whichBase);
         }
@@ -408,6 +415,26 @@ int32_t mGetRealAdmiralNum(int32_t mplayernum) {
     return gAdmiralNumbers[mplayernum];
 }
 
+// Initial objects record which objects they became, and conditions whether they have been true
+// yet, so the current scenario's are part of the state of the game.
+void SaveScenarioState(Bytes* out) {
+    if (gThisScenario->initialNum > 0) {
+        save_raw(out, gThisScenario->initial(0), gThisScenario->initialNum);
+    }
+    if (gThisScenario->conditionNum > 0) {
+        save_raw(out, gThisScenario->condition(0), gThisScenario->conditionNum);
+    }
+}
+
+void RestoreScenarioState(BytesSlice* in) {
+    if (gThisScenario->initialNum > 0) {
+        restore_raw(in, gThisScenario->initial(0), gThisScenario->initialNum);
+    }
+    if (gThisScenario->conditionNum > 0) {
+        restore_raw(in, gThisScenario->condition(0), gThisScenario->conditionNum);
+    }
+}
+
 Scenario::InitialObject* Scenario::initial(size_t at) const {
     return &gScenarioInitialData[initialFirst + at];
 }
@@ -543,6 +570,7 @@ bool ConstructScenario(const Scenario* scenario) {
     objectActionType        *action;
     Rect                    loadingRect;
     long                    stepNumber, currentStep = 0;
+    const int64_t           start = Profiler::now_nsecs();
 
     v.h = 0; v.v = 0;
 
@@ -672,6 +700,7 @@ bool ConstructScenario(const Scenario* scenario) {
     // uncheck all sounds
     SetAllSoundsNoKeep();
     SetAllPixTablesNoKeep();
+    gNeededPixTables.clear();
 
     stepNumber = gThisScenario->initialNum * 4L + (gThisScenario->startTime & kScenario_StartTimeMask); // for each run through the initial num
     StringList strings(kLevelNameID);
@@ -847,11 +876,11 @@ bool ConstructScenario(const Scenario* scenario) {
         {
             if ( baseObject->attributes & kCanThink)
             {
-                AddPixTable( initial->spriteIDOverride +
+                gNeededPixTables.push_back( initial->spriteIDOverride +
                     (GetAdmiralColor( initial->owner) << kSpriteTableColorShift));
             } else
             {
-                AddPixTable( initial->spriteIDOverride);
+                gNeededPixTables.push_back( initial->spriteIDOverride);
             }
         }
 
@@ -904,6 +933,8 @@ bool ConstructScenario(const Scenario* scenario) {
         }
     }
 
+    AddPixTables(gNeededPixTables);
+
     SetAllBaseObjectsUnchecked();
 
     // begin init admirals used to be here
@@ -1067,13 +1098,13 @@ bool ConstructScenario(const Scenario* scenario) {
                 anObject = gSpaceObjectData.get();
                 count = 0;
                 while ((((anObject->attributes & kCanThink) != kCanThink) ||
-                    (anObject->owner != c2)) && ( count < kMaxSpaceObject))
+                    (anObject->owner != c2)) && ( count < gMaxSpaceObject))
                 {
                     count++;
                     anObject++;
                 }
 
-                if ( count < kMaxSpaceObject)
+                if ( count < gMaxSpaceObject)
                 {
                     SetAdmiralFlagship( c2, count);
                     anObject->attributes |= kIsPlayerShip;
@@ -1095,12 +1126,12 @@ bool ConstructScenario(const Scenario* scenario) {
     for ( count = 0; count < ((gThisScenario->startTime & kScenario_StartTimeMask) * 20); count++)
     {
         globals()->gGameTime = count;
-        MoveSpaceObjects( gSpaceObjectData.get(), kMaxSpaceObject,
+        MoveSpaceObjects( gSpaceObjectData.get(), gMaxSpaceObject,
                     kDecideEveryCycles);
         NonplayerShipThink( kDecideEveryCycles);
         AdmiralThink();
         ExecuteActionQueue( kDecideEveryCycles);
-        CollideSpaceObjects( gSpaceObjectData.get(), kMaxSpaceObject);
+        CollideSpaceObjects( gSpaceObjectData.get(), gMaxSpaceObject);
         c2++;
         if ( c2 == 30)
         {
@@ -1117,9 +1148,14 @@ bool ConstructScenario(const Scenario* scenario) {
     }
     globals()->gGameTime = (gThisScenario->startTime & kScenario_StartTimeMask) * kScenarioTimeMultiple;
 
+    gScenarioLoadNsecs = Profiler::now_nsecs() - start;
     return( true);
 }
 
+int64_t ScenarioLoadNsecs() {
+    return gScenarioLoadNsecs;
+}
+
 void CheckScenarioConditions(int32_t timePass) {
     Scenario::Condition     *condition = NULL;
     spaceObjectType         *sObject = NULL, *dObject = NULL;
@@ -0,0 +1,320 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "game/snapshot.hpp"
+
+#include <sfz/sfz.hpp>
+
+#include "drawing/sprite-handling.hpp"
+#include "game/admiral.hpp"
+#include "game/beam.hpp"
+#include "game/globals.hpp"
+#include "game/input-source.hpp"
+#include "game/minicomputer.hpp"
+#include "game/player-ship.hpp"
+#include "game/scenario-maker.hpp"
+#include "game/space-object.hpp"
+#include "math/random.hpp"
+
+using sfz::Bytes;
+using sfz::BytesSlice;
+using sfz::Exception;
+using sfz::Rune;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::make_linked_ptr;
+
+namespace antares {
+
+namespace {
+
+// Runs of fewer unchanged bytes than this are kept in the literal around them, since a run costs
+// eight bytes to describe.
+const size_t kMinZeroRun = 8;
+
+void save_globals(Bytes* out) {
+    const aresGlobalType* g = globals();
+    save_raw(out, &g->gGameTime);
+    save_raw(out, &g->gGameOver);
+    save_raw(out, &g->gSynchValue);
+    save_raw(out, g->gActiveCheats, kMaxPlayerNum);
+    save_raw(out, &g->gClosestObject);
+    save_raw(out, &g->gFarthestObject);
+    save_raw(out, &g->gCenterScaleH);
+    save_raw(out, &g->gCenterScaleV);
+    save_raw(out, &g->gPlayerAdmiralNumber);
+    save_raw(out, &g->gScenarioWinner);
+    save_raw(out, &g->gScenarioCheckTime);
+}
+
+void restore_globals(BytesSlice* in) {
+    aresGlobalType* g = globals();
+    restore_raw(in, &g->gGameTime);
+    restore_raw(in, &g->gGameOver);
+    restore_raw(in, &g->gSynchValue);
+    restore_raw(in, g->gActiveCheats, kMaxPlayerNum);
+    restore_raw(in, &g->gClosestObject);
+    restore_raw(in, &g->gFarthestObject);
+    restore_raw(in, &g->gCenterScaleH);
+    restore_raw(in, &g->gCenterScaleV);
+    restore_raw(in, &g->gPlayerAdmiralNumber);
+    restore_raw(in, &g->gScenarioWinner);
+    restore_raw(in, &g->gScenarioCheckTime);
+}
+
+void save_random_seeds(Bytes* out) {
+    const int32_t global_seed = GetRandomGlobalSeed();
+    save_raw(out, &gRandomSeed);
+    save_raw(out, &global_seed);
+}
+
+void restore_random_seeds(BytesSlice* in) {
+    int32_t global_seed;
+    restore_raw(in, &gRandomSeed);
+    restore_raw(in, &global_seed);
+    SetRandomGlobalSeed(global_seed);
+}
+
+// Appends to `out` the difference between images `from` and `to`: the size of `to`, then
+// alternating counts of unchanged bytes and changed bytes, each count of changed bytes followed by
+// those bytes XORed with the bytes of `from`.  Bytes past the end of `from` are always changed,
+// and are XORed with zero.
+void encode_delta(const BytesSlice& from, const BytesSlice& to, Bytes* out) {
+    const uint32_t size = to.size();
+    save_raw(out, &size);
+    size_t i = 0;
+    while (i < size) {
+        const size_t zero_start = i;
+        while ((i < size) && (i < from.size()) && (from.at(i) == to.at(i))) {
+            ++i;
+        }
+
+        // Extend the literal until it reaches a run of unchanged bytes long enough to be worth
+        // breaking it for, or the end.
+        const size_t literal_start = i;
+        size_t zeroes = 0;
+        while ((i < size) && (zeroes < kMinZeroRun)) {
+            if ((i < from.size()) && (from.at(i) == to.at(i))) {
+                ++zeroes;
+            } else {
+                zeroes = 0;
+            }
+            ++i;
+        }
+        if (zeroes == kMinZeroRun) {
+            i -= zeroes;
+        }
+
+        const uint32_t zero_count = literal_start - zero_start;
+        const uint32_t literal_count = i - literal_start;
+        save_raw(out, &zero_count);
+        save_raw(out, &literal_count);
+        for (size_t j = literal_start; j < i; ++j) {
+            out->push(1, to.at(j) ^ ((j < from.size()) ? from.at(j) : 0));
+        }
+    }
+}
+
+// Rebuilds in `to` the image which `delta` was encoded against `from` to give.
+void apply_delta(const BytesSlice& from, BytesSlice delta, Bytes* to) {
+    to->clear();
+    uint32_t size;
+    restore_raw(&delta, &size);
+    while (to->size() < size) {
+        uint32_t zero_count;
+        uint32_t literal_count;
+        restore_raw(&delta, &zero_count);
+        restore_raw(&delta, &literal_count);
+        if ((to->size() + zero_count + literal_count > size) || (delta.size() < literal_count)) {
+            throw Exception("corrupt snapshot delta");
+        }
+        to->push(from.slice(to->size(), zero_count));
+        for (uint32_t j = 0; j < literal_count; ++j) {
+            const size_t k = to->size();
+            to->push(1, delta.at(j) ^ ((k < from.size()) ? from.at(k) : 0));
+        }
+        delta.shift(literal_count);
+    }
+    if (!delta.empty()) {
+        throw Exception("corrupt snapshot delta");
+    }
+}
+
+}  // namespace
+
+void save_string(Bytes* out, const StringSlice& string) {
+    const uint32_t size = string.size();
+    save_raw(out, &size);
+    for (size_t i = 0; i < string.size(); ++i) {
+        const Rune rune = string.at(i);
+        save_raw(out, &rune);
+    }
+}
+
+void restore_string(BytesSlice* in, String* string) {
+    uint32_t size;
+    restore_raw(in, &size);
+    string->clear();
+    for (uint32_t i = 0; i < size; ++i) {
+        Rune rune;
+        restore_raw(in, &rune);
+        string->append(1, rune);
+    }
+}
+
+Snapshot::Snapshot() { }
+
+void Snapshot::save() {
+    _data.clear();
+    save_globals(&_data);
+    save_random_seeds(&_data);
+    SaveSpaceObjects(&_data);
+    SaveSprites(&_data);
+    SaveAdmirals(&_data);
+    SaveBeams(&_data);
+    SaveScenarioState(&_data);
+    SavePlayerShip(&_data);
+    SaveMiniComputer(&_data);
+    if (globals()->gInputSource.get() != NULL) {
+        globals()->gInputSource->save(&_data);
+    }
+}
+
+void Snapshot::restore() const {
+    BytesSlice in(_data);
+    restore_globals(&in);
+    restore_random_seeds(&in);
+    RestoreSpaceObjects(&in);
+    RestoreSprites(&in);
+    RestoreAdmirals(&in);
+    RestoreBeams(&in);
+    RestoreScenarioState(&in);
+    RestorePlayerShip(&in);
+    RestoreMiniComputer(&in);
+    if (globals()->gInputSource.get() != NULL) {
+        globals()->gInputSource->restore(&in);
+    }
+    if (!in.empty()) {
+        throw Exception("didn't consume all of snapshot");
+    }
+}
+
+SnapshotRing* SnapshotRing::_ring = NULL;
+
+SnapshotRing::SnapshotRing(int32_t interval, int32_t keyframe_interval, size_t capacity)
+        : _interval(interval),
+          _keyframe_interval(keyframe_interval),
+          _capacity(capacity),
+          _bytes(0),
+          _since_keyframe(0),
+          _seek_scheduled(false),
+          _seek_at(0),
+          _seek_to(0) { }
+
+SnapshotRing* SnapshotRing::ring() {
+    return _ring;
+}
+
+void SnapshotRing::set_ring(SnapshotRing* ring) {
+    _ring = ring;
+}
+
+void SnapshotRing::record() {
+    const int64_t now = globals()->gGameTime;
+    if (!_entries.empty() && (now < (_entries.back().game_time + _interval))) {
+        return;
+    }
+
+    Entry entry;
+    entry.game_time = now;
+    entry.keyframe = _entries.empty() || (_since_keyframe >= _keyframe_interval - 1);
+    entry.data = make_linked_ptr(new Bytes);
+    _scratch.save();
+    if (entry.keyframe) {
+        entry.data->push(BytesSlice(_scratch.data()));
+        _since_keyframe = 0;
+    } else {
+        encode_delta(_last.data(), _scratch.data(), entry.data.get());
+        ++_since_keyframe;
+    }
+    _last.data().clear();
+    _last.data().push(BytesSlice(_scratch.data()));
+
+    _bytes += entry.data->size();
+    _entries.push_back(entry);
+    while (_entries.size() > _capacity) {
+        drop_oldest();
+    }
+}
+
+bool SnapshotRing::restore(int64_t game_time) {
+    // Find the last entry at or before `game_time`, and the keyframe it depends on.
+    size_t end = 0;
+    while ((end < _entries.size()) && (_entries[end].game_time <= game_time)) {
+        ++end;
+    }
+    if (end == 0) {
+        return false;
+    }
+    size_t keyframe = end - 1;
+    while (!_entries[keyframe].keyframe) {
+        --keyframe;
+    }
+
+    _last.data().clear();
+    _last.data().push(BytesSlice(*_entries[keyframe].data));
+    for (size_t i = keyframe + 1; i < end; ++i) {
+        apply_delta(_last.data(), *_entries[i].data, &_scratch.data());
+        _last.data().clear();
+        _last.data().push(BytesSlice(_scratch.data()));
+    }
+    _last.restore();
+
+    // Later entries describe a future which may not happen again, if the game is not a replay.
+    while (_entries.size() > end) {
+        _bytes -= _entries.back().data->size();
+        _entries.pop_back();
+    }
+    _since_keyframe = (end - 1) - keyframe;
+    return true;
+}
+
+void SnapshotRing::schedule_seek(int64_t at, int64_t to) {
+    _seek_scheduled = true;
+    _seek_at = at;
+    _seek_to = to;
+}
+
+bool SnapshotRing::take_seek(int64_t* to) {
+    if (!_seek_scheduled || (globals()->gGameTime < _seek_at)) {
+        return false;
+    }
+    _seek_scheduled = false;
+    *to = _seek_to;
+    return true;
+}
+
+void SnapshotRing::drop_oldest() {
+    do {
+        _bytes -= _entries.front().data->size();
+        _entries.pop_front();
+    } while (!_entries.empty() && !_entries.front().keyframe);
+}
+
+}  // namespace antares
@@ -19,6 +19,7 @@
 
 #include "game/space-object.hpp"
 
+#include <vector>
 #include <sfz/sfz.hpp>
 
 #include "data/resource.hpp"
@@ -29,6 +30,8 @@
 #include "drawing/sprite-handling.hpp"
 #include "game/admiral.hpp"
 #include "game/beam.hpp"
+#include "game/checksum.hpp"
+#include "game/free-slots.hpp"
 #include "game/globals.hpp"
 #include "game/labels.hpp"
 #include "game/messages.hpp"
@@ -36,7 +39,9 @@
 #include "game/motion.hpp"
 #include "game/player-ship.hpp"
 #include "game/scenario-maker.hpp"
+#include "game/snapshot.hpp"
 #include "game/starfield.hpp"
+#include "game/timer-wheel.hpp"
 #include "math/macros.hpp"
 #include "math/random.hpp"
 #include "math/rotation.hpp"
@@ -44,6 +49,7 @@
 #include "math/units.hpp"
 #include "video/transitions.hpp"
 
+using sfz::Bytes;
 using sfz::BytesSlice;
 using sfz::Exception;
 using sfz::ReadSource;
@@ -51,11 +57,12 @@ using sfz::String;
 using sfz::StringSlice;
 using sfz::read;
 using sfz::scoped_array;
+using std::vector;
 namespace macroman = sfz::macroman;
 
 namespace antares {
 
-const size_t kActionQueueLength     = 120;
+const size_t kLegacyActionQueueLength = 120;
 
 const uint8_t kFriendlyColor        = GREEN;
 const uint8_t kHostileColor         = RED;
@@ -67,9 +74,6 @@ struct actionQueueType {
     objectActionType            *action;
     long                            actionNum;
     long                            actionToDo;
-    long                            scheduledTime;
-    actionQueueType         *nextActionQueue;
-    long                            nextActionQueueNum;
     spaceObjectType         *subjectObject;
     long                            subjectObjectNum;
     long                            subjectObjectID;
@@ -79,22 +83,34 @@ struct actionQueueType {
     Point                       offset;
 };
 
+int32_t gMaxSpaceObject = kMaxSpaceObject;
 spaceObjectType* gRootObject = NULL;
 long gRootObjectNumber = -1;
-actionQueueType* gFirstActionQueue = NULL;
-long gFirstActionQueueNumber = -1;
 baseObjectType kZeroBaseObject;
 spaceObjectType kZeroSpaceObject = {0, &kZeroBaseObject};
 
 scoped_array<spaceObjectType> gSpaceObjectData;
+FreeSlots gFreeSpaceObjects;
 scoped_array<baseObjectType> gBaseObjectData;
 scoped_array<objectActionType> gObjectActionData;
-scoped_array<actionQueueType> gActionQueueData;
+
+// Delayed actions.  Entries are allocated from `gActionQueueData`, which grows as needed, and
+// reused through `gFreeActionQueue`; `gActionQueueWheel` holds the numbers of the pending ones,
+// keyed on the time they are due.
+vector<actionQueueType> gActionQueueData;
+vector<int32_t> gFreeActionQueue;
+vector<int32_t> gActionQueueDue;
+TimerWheel gActionQueueWheel;
+
+// Whether to drop delayed actions once kLegacyActionQueueLength are pending, as the original game
+// did, and how many have been dropped since the queue was last reset.
+bool gLegacyActionQueueLimit = false;
+int64_t gDroppedActionCount = 0;
 
 void SpaceObjectHandlingInit() {
     bool correctBaseObjectColor = false;
 
-    gSpaceObjectData.reset(new spaceObjectType[kMaxSpaceObject]);
+    gSpaceObjectData.reset(new spaceObjectType[gMaxSpaceObject]);
     if (gBaseObjectData.get() == NULL) {
         Resource rsrc("objects", "bsob", kBaseObjectResID);
         BytesSlice in(rsrc.data());
@@ -124,7 +140,6 @@ void SpaceObjectHandlingInit() {
         }
     }
 
-    gActionQueueData.reset(new actionQueueType[kActionQueueLength]);
     if (correctBaseObjectColor) {
         CorrectAllBaseObjectColor();
     }
@@ -136,17 +151,18 @@ void CleanupSpaceObjectHandling() {
     gBaseObjectData.reset();
     gSpaceObjectData.reset();
     gObjectActionData.reset();
-    gActionQueueData.reset();
+    ResetActionQueueData();
 }
 
 void ResetAllSpaceObjects() {
     spaceObjectType *anObject = NULL;
-    short           i;
+    int             i;
 
     gRootObject = NULL;
     gRootObjectNumber = -1;
+    gFreeSpaceObjects.reset(gMaxSpaceObject);
     anObject = gSpaceObjectData.get();
-    for (i = 0; i < kMaxSpaceObject; i++) {
+    for (i = 0; i < gMaxSpaceObject; i++) {
 //      anObject->attributes = 0;
         anObject->active = kObjectAvailable;
         anObject->sprite = NULL;
@@ -238,28 +254,72 @@ void ResetAllSpaceObjects() {
 
 void ResetActionQueueData( void)
 {
-    actionQueueType *action = gActionQueueData.get();
-    long            i;
-
-    gFirstActionQueueNumber = -1;
-    gFirstActionQueue = NULL;
-
-    for ( i = 0; i < kActionQueueLength; i++)
-    {
-        action->actionNum = -1;
-        action->actionToDo = 0;
-        action->action = NULL;
-        action->nextActionQueueNum = -1;
-        action->nextActionQueue = NULL;
-        action->scheduledTime = -1;
-        action->subjectObject = NULL;
-        action->subjectObjectNum = -1;
-        action->subjectObjectID = -1;
-        action->directObject = NULL;
-        action->directObjectNum = -1;
-        action->directObjectID = -1;
-        action->offset.h = action->offset.v = 0;
-        action++;
+    gActionQueueData.clear();
+    gFreeActionQueue.clear();
+    gActionQueueWheel.clear();
+    gDroppedActionCount = 0;
+}
+
+void SetLegacyActionQueueLimit(bool enabled) {
+    gLegacyActionQueueLimit = enabled;
+}
+
+int64_t DroppedActionCount() {
+    return gDroppedActionCount;
+}
+
+void SaveSpaceObjects(Bytes* out) {
+    save_raw(out, gSpaceObjectData.get(), gMaxSpaceObject);
+    save_raw(out, &gRootObject);
+    save_raw(out, &gRootObjectNumber);
+    gFreeSpaceObjects.save(out);
+
+    save_vector(out, gActionQueueData);
+    save_vector(out, gFreeActionQueue);
+    vector<int32_t> pending;
+    vector<int64_t> due;
+    gActionQueueWheel.list(&pending, &due);
+    const int64_t now = gActionQueueWheel.now();
+    save_raw(out, &now);
+    save_vector(out, pending);
+    save_vector(out, due);
+}
+
+void RestoreSpaceObjects(BytesSlice* in) {
+    restore_raw(in, gSpaceObjectData.get(), gMaxSpaceObject);
+    restore_raw(in, &gRootObject);
+    restore_raw(in, &gRootObjectNumber);
+    gFreeSpaceObjects.restore(in);
+
+    restore_vector(in, &gActionQueueData);
+    restore_vector(in, &gFreeActionQueue);
+    vector<int32_t> pending;
+    vector<int64_t> due;
+    int64_t now;
+    restore_raw(in, &now);
+    restore_vector(in, &pending);
+    restore_vector(in, &due);
+    gActionQueueWheel.reset(now);
+    for (size_t i = pending.size(); i > 0; --i) {
+        gActionQueueWheel.add(pending[i - 1], due[i - 1]);
+    }
+}
+
+void HashActionQueue(StateHash* hash) {
+    vector<int32_t> pending;
+    vector<int64_t> due;
+    gActionQueueWheel.list(&pending, &due);
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const actionQueueType& action = gActionQueueData[pending[i]];
+        hash->add("action", i, "due", due[i]);
+        hash->add("action", i, "actionNum", action.actionNum);
+        hash->add("action", i, "actionToDo", action.actionToDo);
+        hash->add("action", i, "subjectObjectNum", action.subjectObjectNum);
+        hash->add("action", i, "subjectObjectID", action.subjectObjectID);
+        hash->add("action", i, "directObjectNum", action.directObjectNum);
+        hash->add("action", i, "directObjectID", action.directObjectID);
+        hash->add("action", i, "offset.h", action.offset.h);
+        hash->add("action", i, "offset.v", action.offset.v);
     }
 }
 
@@ -282,17 +342,12 @@ int AddSpaceObject( spaceObjectType *sourceObject)
     unsigned char   tinyShade;
     short           whichShape = 0, angle;
 
-    destObject = gSpaceObjectData.get();
-
-    while (( destObject->active) && ( whichObject < kMaxSpaceObject))
-    {
-        whichObject++;
-        destObject++;
-    }
-    if ( whichObject == kMaxSpaceObject)
+    whichObject = gFreeSpaceObjects.first();
+    if ( whichObject < 0)
     {
         return( -1);
     }
+    destObject = gSpaceObjectData.get() + whichObject;
 
     if ( sourceObject->pixResID != kNoSpriteTable)
     {
@@ -431,6 +486,7 @@ int AddSpaceObject( spaceObjectType *sourceObject)
     gRootObjectNumber = whichObject;
 
     destObject->active = kObjectInUse;
+    gFreeSpaceObjects.acquire(whichObject);
     destObject->nextNearObject = destObject->nextFarObject = NULL;
     destObject->whichLabel = kNoLabel;
     destObject->entryNumber = whichObject;
@@ -513,6 +569,14 @@ int AddNumberedSpaceObject( spaceObjectType *sourceObject, long whichObject)
 */  return ( 0);
 }
 
+// Marks `object` as available, and returns its slot to gFreeSpaceObjects, so that AddSpaceObject()
+// can reuse it.  This is the only way a slot should be freed while a scenario is running.
+void ReleaseSpaceObjectSlot( spaceObjectType *object)
+{
+    object->active = kObjectAvailable;
+    gFreeSpaceObjects.release( object - gSpaceObjectData.get());
+}
+
 void RemoveAllSpaceObjects( void)
 
 {
@@ -520,7 +584,7 @@ void RemoveAllSpaceObjects( void)
     int             i;
 
     anObject = gSpaceObjectData.get();
-    for ( i = 0; i < kMaxSpaceObject; i++)
+    for ( i = 0; i < gMaxSpaceObject; i++)
     {
         if ( anObject->sprite != NULL)
         {
@@ -533,6 +597,7 @@ void RemoveAllSpaceObjects( void)
         anObject->attributes = 0;
         anObject++;
     }
+    gFreeSpaceObjects.reset(gMaxSpaceObject);
 }
 
 void CorrectAllBaseObjectColor( void)
@@ -989,7 +1054,7 @@ void ChangeObjectBaseType( spaceObjectType *dObject, long whichBaseObject,
 
         dObject->sprite->table = spriteTable;
         dObject->sprite->tinySize = sObject->tinySize;
-        dObject->sprite->whichLayer = sObject->pixLayer;
+        SetSpriteLayer(dObject->sprite, sObject->pixLayer);
         dObject->sprite->scale = sObject->naturalScale;
 
         if ( dObject->attributes & kIsSelfAnimated)
@@ -1012,21 +1077,28 @@ void AddActionToQueue( objectActionType *action, long actionNumber, long actionT
                         long delayTime, spaceObjectType *subjectObject,
                         spaceObjectType *directObject, Point* offset)
 {
-    long                queueNumber = 0;
-    actionQueueType     *actionQueue = gActionQueueData.get(),
-                        *nextQueue = gFirstActionQueue, *previousQueue = NULL;
+    int32_t             queueNumber;
+    actionQueueType     *actionQueue;
+
+    if (gLegacyActionQueueLimit
+            && ((gActionQueueData.size() - gFreeActionQueue.size()) >= kLegacyActionQueueLength)) {
+        ++gDroppedActionCount;
+        return;
+    }
 
-    while (( actionQueue->action != NULL) && ( queueNumber < kActionQueueLength))
+    if ( gFreeActionQueue.empty())
+    {
+        queueNumber = gActionQueueData.size();
+        gActionQueueData.push_back(actionQueueType());
+    } else
     {
-        actionQueue++;
-        queueNumber++;
+        queueNumber = gFreeActionQueue.back();
+        gFreeActionQueue.pop_back();
     }
+    actionQueue = &gActionQueueData[queueNumber];
 
-    if ( queueNumber == kActionQueueLength) return;
-//  delayTime += globals()->gGameTime;
     actionQueue->action = action;
     actionQueue->actionNum = actionNumber;
-    actionQueue->scheduledTime = delayTime;
     actionQueue->subjectObject = subjectObject;
     actionQueue->actionToDo = actionToDo;
 
@@ -1059,88 +1131,50 @@ void AddActionToQueue( objectActionType *action, long actionNumber, long actionT
         actionQueue->directObjectID = -1;
     }
 
-    while (( nextQueue != NULL) && ( nextQueue->scheduledTime < delayTime))
-    {
-        previousQueue = nextQueue;
-        nextQueue = nextQueue->nextActionQueue;
-    }
-    if ( previousQueue == NULL)
-    {
-        actionQueue->nextActionQueue = gFirstActionQueue;
-        actionQueue->nextActionQueueNum = gFirstActionQueueNumber;
-        gFirstActionQueue = actionQueue;
-        gFirstActionQueueNumber = queueNumber;
-    } else
-    {
-        actionQueue->nextActionQueue = previousQueue->nextActionQueue;
-        actionQueue->nextActionQueueNum = previousQueue->nextActionQueueNum;
-
-        previousQueue->nextActionQueue = actionQueue;
-        previousQueue->nextActionQueueNum = queueNumber;
-    }
+    // The wheel's clock advances with each call to ExecuteActionQueue(), so this comes due on the
+    // first call after `delayTime` units have been executed, as it did when each entry's time was
+    // counted down instead.
+    gActionQueueWheel.add( queueNumber, gActionQueueWheel.now() + delayTime);
 }
 
 void ExecuteActionQueue( long unitsToDo)
 
 {
-//  actionQueueType     *actionQueue = gFirstActionQueue;
-    actionQueueType     *actionQueue = gActionQueueData.get();
-    long                        subjectid, directid, i;
+    actionQueueType     *actionQueue;
+    long                        subjectid, directid;
 
-    for ( i = 0; i < kActionQueueLength; i++)
-    {
-        if ( actionQueue->action != NULL)
-        {
-            actionQueue->scheduledTime -= unitsToDo;
-        }
-        actionQueue++;
-    }
+    gActionQueueDue.clear();
+    gActionQueueWheel.advance( gActionQueueWheel.now() + unitsToDo, &gActionQueueDue);
 
-    actionQueue = gFirstActionQueue;
-    while (( gFirstActionQueue != NULL) &&
-        ( gFirstActionQueue->action != NULL) &&
-        ( gFirstActionQueue->scheduledTime <= 0))
-//      ( gFirstActionQueue->scheduledTime <= globals()->gGameTime))
+    // Actions executed here may queue more, which can grow gActionQueueData, so look each entry up
+    // again rather than holding on to a pointer across ExecuteObjectActions().  Anything they queue
+    // has a positive delay, so it can't come due in this call.
+    for ( size_t i = 0; i < gActionQueueDue.size(); i++)
     {
+        const int32_t queueNumber = gActionQueueDue[i];
+        actionQueue = &gActionQueueData[queueNumber];
         subjectid = -1;
         directid = -1;
-        if ( gFirstActionQueue->subjectObject != NULL)
+        if ( actionQueue->subjectObject != NULL)
         {
-            if ( gFirstActionQueue->subjectObject->active)
-                subjectid = gFirstActionQueue->subjectObject->id;
+            if ( actionQueue->subjectObject->active)
+                subjectid = actionQueue->subjectObject->id;
         }
 
-        if ( gFirstActionQueue->directObject != NULL)
+        if ( actionQueue->directObject != NULL)
         {
-            if ( gFirstActionQueue->directObject->active)
-                directid = gFirstActionQueue->directObject->id;
+            if ( actionQueue->directObject->active)
+                directid = actionQueue->directObject->id;
         }
-        if (( subjectid == gFirstActionQueue->subjectObjectID) &&
-            ( directid == gFirstActionQueue->directObjectID))
+        if (( subjectid == actionQueue->subjectObjectID) &&
+            ( directid == actionQueue->directObjectID))
         {
-            ExecuteObjectActions( gFirstActionQueue->actionNum, gFirstActionQueue->actionToDo,
-                gFirstActionQueue->subjectObject, gFirstActionQueue->directObject,
-                &(gFirstActionQueue->offset), false);
+            Point offset = actionQueue->offset;
+            ExecuteObjectActions( actionQueue->actionNum, actionQueue->actionToDo,
+                actionQueue->subjectObject, actionQueue->directObject,
+                &offset, false);
         }
-        gFirstActionQueue->actionNum = -1;
-        gFirstActionQueue->actionToDo = 0;
-        gFirstActionQueue->action = NULL;
-        gFirstActionQueue->scheduledTime = -1;
-        gFirstActionQueue->subjectObject = NULL;
-        gFirstActionQueue->subjectObjectNum = -1;
-        gFirstActionQueue->subjectObjectID = -1;
-        gFirstActionQueue->directObject = NULL;
-        gFirstActionQueue->directObjectNum = -1;
-        gFirstActionQueue->directObjectID = -1;
-        gFirstActionQueue->offset.h = gFirstActionQueue->offset.v = 0;
-
-        actionQueue = gFirstActionQueue;
-
-        gFirstActionQueueNumber = gFirstActionQueue->nextActionQueueNum;
-        gFirstActionQueue = gFirstActionQueue->nextActionQueue;
-
-        actionQueue->nextActionQueueNum = -1;
-        actionQueue->nextActionQueue = NULL;
+        gFreeActionQueue.push_back( queueNumber);
     }
 }
 
@@ -2172,7 +2206,7 @@ long CountObjectsOfBaseType( long whichType, long owner)
     spaceObjectType *anObject;
 
     anObject = gSpaceObjectData.get();
-    for ( count = 0; count < kMaxSpaceObject; count++)
+    for ( count = 0; count < gMaxSpaceObject; count++)
     {
         if (( anObject->active) &&
             (( anObject->whichBaseObject == whichType) || ( whichType == -1)) &&
@@ -2374,7 +2408,7 @@ void AlterObjectOwner( spaceObjectType *anObject, long owner, bool message)
         anObject->bestConsideredTargetNumber = -1;
 
         fixObject = gSpaceObjectData.get();
-        for ( i = 0; i < kMaxSpaceObject; i++)
+        for ( i = 0; i < gMaxSpaceObject; i++)
         {
             if (( fixObject->destinationObject == anObject->entryNumber) && ( fixObject->active !=
                 kObjectAvailable) && ( fixObject->attributes & kCanThink))
@@ -2469,7 +2503,7 @@ void DestroyObject( spaceObjectType *anObject)
             anObject->health = anObject->baseType->health;
             // if anyone is targeting it, they should stop
             fixObject = gSpaceObjectData.get();
-            for ( i = 0; i < kMaxSpaceObject; i++)
+            for ( i = 0; i < gMaxSpaceObject; i++)
             {
                 if (( fixObject->attributes & kCanAcceptDestination) && ( fixObject->active !=
                     kObjectAvailable))
@@ -2511,7 +2545,7 @@ void DestroyObject( spaceObjectType *anObject)
             {
                 RemoveDestination( anObject->destinationObject);
                 fixObject = gSpaceObjectData.get();
-                for ( i = 0; i < kMaxSpaceObject; i++)
+                for ( i = 0; i < gMaxSpaceObject; i++)
                 {
                     if (( fixObject->attributes & kCanAcceptDestination) && ( fixObject->active !=
                         kObjectAvailable))
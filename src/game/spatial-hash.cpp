@@ -0,0 +1,112 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "game/spatial-hash.hpp"
+
+#include <algorithm>
+#include <sfz/sfz.hpp>
+
+using std::max;
+using std::vector;
+
+namespace antares {
+
+namespace {
+
+// The offsets of the neighbors of a cell (see Notebook 2 p.34).
+const Point kNeighborOffsets[SpatialHash::kNeighborCount] = {
+    Point(0, 0),
+    Point(1, 0),
+    Point(-1, 1),
+    Point(0, 1),
+    Point(1, 1),
+};
+
+}  // namespace
+
+SpatialHash::SpatialHash(int unit_shift, int size_shift)
+        : _unit_shift(unit_shift),
+          _size_shift(size_shift),
+          _mask((1 << size_shift) - 1),
+          _bucket_count(1 << (2 * size_shift)),
+          _neighbors(_bucket_count * kNeighborCount),
+          _sorted(1),
+          _starts(_bucket_count + 1, 0) {
+    for (int32_t b = 0; b < _bucket_count; ++b) {
+        const Point cell(b & _mask, b >> _size_shift);
+        for (int k = 0; k < kNeighborCount; ++k) {
+            _neighbors[(b * kNeighborCount) + k] = bucket(neighbor_cell(cell, k));
+        }
+    }
+}
+
+void SpatialHash::clear() {
+    _entries.clear();
+}
+
+void SpatialHash::add(int32_t index, uint32_t h, uint32_t v) {
+    Entry entry;
+    entry.cell = cell(h, v);
+    entry.index = index;
+    _entries.push_back(entry);
+}
+
+void SpatialHash::sort() {
+    // Count the entries in each bucket, and take the prefix sum so that `_starts[b]` is the start
+    // of bucket `b` in `_sorted`.
+    std::fill(_starts.begin(), _starts.end(), 0);
+    _buckets.resize(_entries.size());
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        _buckets[i] = bucket(_entries[i].cell);
+        ++_starts[_buckets[i] + 1];
+    }
+    for (int32_t b = 0; b < _bucket_count; ++b) {
+        _starts[b + 1] += _starts[b];
+    }
+
+    // Scatter the entries, last-added first, using `_starts[b]` as the fill pointer for bucket
+    // `b`.  Afterwards, each `_starts[b]` has advanced to the start of bucket `b + 1`, so move
+    // each one up to the following slot.
+    _sorted.resize(max<size_t>(_entries.size(), 1));
+    for (size_t i = _entries.size(); i > 0; --i) {
+        _sorted[_starts[_buckets[i - 1]]++] = _entries[i - 1];
+    }
+    for (int32_t b = _bucket_count; b > 0; --b) {
+        _starts[b] = _starts[b - 1];
+    }
+    _starts[0] = 0;
+}
+
+Point SpatialHash::neighbor_cell(const Point& cell, int k) {
+    return Point(cell.h + kNeighborOffsets[k].h, cell.v + kNeighborOffsets[k].v);
+}
+
+Point SpatialHash::cell(uint32_t h, uint32_t v) const {
+    return Point(h >> _unit_shift, v >> _unit_shift);
+}
+
+Point SpatialHash::super_cell(const Point& cell) const {
+    return Point(cell.h >> _size_shift, cell.v >> _size_shift);
+}
+
+int32_t SpatialHash::bucket(const Point& cell) const {
+    return ((cell.v & _mask) << _size_shift) | (cell.h & _mask);
+}
+
+}  // namespace antares
@@ -273,6 +273,7 @@ void Starfield::draw() const {
     const RgbColor mediumColor = GetRGBTranslateColorShade(kStarColor, LIGHT);
     const RgbColor fastColor = GetRGBTranslateColorShade(kStarColor, LIGHTER);
 
+    PrimitiveBatch batch(VideoDriver::driver());
     switch (gScrollStarObject->presenceState) {
       default:
         if (!_warp_stars) {
@@ -286,7 +287,7 @@ void Starfield::draw() const {
                         color = &fastColor;
                     }
 
-                    VideoDriver::driver()->draw_point(star->location, *color);
+                    batch.draw_point(star->location, *color);
                 }
             });
         }
@@ -305,8 +306,7 @@ void Starfield::draw() const {
                 }
 
                 if (star->age > 1) {
-                    VideoDriver::driver()->draw_line(
-                            star->location, star->oldLocation, *color);
+                    batch.draw_line(star->location, star->oldLocation, *color);
                 }
             }
         });
@@ -318,7 +318,7 @@ void Starfield::draw() const {
         if ((star->speed != kNoStar) && (star->age > 0)) {
             const RgbColor color = GetRGBTranslateColorShade(
                     star->color, (star->age >> kSparkAgeToShadeShift) + 1);
-            VideoDriver::driver()->draw_point(star->location, color);
+            batch.draw_point(star->location, color);
         }
     });
 }
@@ -0,0 +1,137 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "game/timer-wheel.hpp"
+
+#include <algorithm>
+
+using std::vector;
+
+namespace antares {
+
+TimerWheel::TimerWheel() {
+    clear();
+}
+
+void TimerWheel::clear() {
+    reset(0);
+}
+
+void TimerWheel::reset(int64_t now) {
+    _now = now;
+    _sequence = 0;
+    _size = 0;
+    for (int level = 0; level < kLevelCount; ++level) {
+        for (int slot = 0; slot < kSlotCount; ++slot) {
+            _slots[level][slot].clear();
+        }
+    }
+    _late.clear();
+    _due.clear();
+}
+
+void TimerWheel::add(int32_t index, int64_t due) {
+    Entry entry;
+    entry.due = due;
+    entry.sequence = _sequence++;
+    entry.index = index;
+    file(entry);
+    ++_size;
+}
+
+void TimerWheel::advance(int64_t now, vector<int32_t>* fired) {
+    _due.clear();
+    while (_now < now) {
+        ++_now;
+
+        // Re-file the slots which start at this tick.  Each level's slots are a multiple of the
+        // level below's, so once one level isn't at a slot boundary, none above it are either.
+        for (int level = 1; level < kLevelCount; ++level) {
+            const int64_t low_bits = (int64_t(1) << (kSlotBits * level)) - 1;
+            if ((_now & low_bits) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        vector<Entry>& slot = _slots[0][_now & (kSlotCount - 1)];
+        _due.insert(_due.end(), slot.begin(), slot.end());
+        slot.clear();
+    }
+
+    // Entries which were already due when they were added, or which were re-filed on the tick
+    // they are due, were set aside in `_late`.
+    _due.insert(_due.end(), _late.begin(), _late.end());
+    _late.clear();
+    std::sort(_due.begin(), _due.end(), fires_before);
+    for (vector<Entry>::const_iterator it = _due.begin(); it != _due.end(); ++it) {
+        fired->push_back(it->index);
+    }
+    _size -= _due.size();
+}
+
+void TimerWheel::list(vector<int32_t>* indices, vector<int64_t>* due) const {
+    vector<Entry> entries(_late);
+    for (int level = 0; level < kLevelCount; ++level) {
+        for (int slot = 0; slot < kSlotCount; ++slot) {
+            entries.insert(entries.end(), _slots[level][slot].begin(), _slots[level][slot].end());
+        }
+    }
+    std::sort(entries.begin(), entries.end(), fires_before);
+    for (vector<Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+        indices->push_back(it->index);
+        due->push_back(it->due);
+    }
+}
+
+bool TimerWheel::fires_before(const Entry& x, const Entry& y) {
+    if (x.due != y.due) {
+        return x.due < y.due;
+    }
+    return x.sequence > y.sequence;
+}
+
+void TimerWheel::file(const Entry& entry) {
+    if (entry.due <= _now) {
+        _late.push_back(entry);
+        return;
+    }
+
+    // The due time and the current time agree on every group of bits above `level`, and differ
+    // in group `level`, so the slot for the entry is still ahead of the current one at that level.
+    const int64_t differ = entry.due ^ _now;
+    int level = 0;
+    while (((level + 1) < kLevelCount) && ((differ >> (kSlotBits * (level + 1))) != 0)) {
+        ++level;
+    }
+    const int slot = (entry.due >> (kSlotBits * level)) & (kSlotCount - 1);
+    _slots[level][slot].push_back(entry);
+}
+
+void TimerWheel::cascade(int level) {
+    // The current time has just entered this slot, so entries re-filed from it go to lower levels
+    // (or to `_late`), and the slot can't be appended to while we walk it.
+    vector<Entry>& slot = _slots[level][(_now >> (kSlotBits * level)) & (kSlotCount - 1)];
+    for (vector<Entry>::const_iterator it = slot.begin(); it != slot.end(); ++it) {
+        file(*it);
+    }
+    slot.clear();
+}
+
+}  // namespace antares
@@ -0,0 +1,124 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "lang/threads.hpp"
+
+#include <unistd.h>
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+using sfz::Exception;
+using sfz::String;
+using std::max;
+using std::min;
+using std::vector;
+
+namespace utf8 = sfz::utf8;
+
+namespace antares {
+
+namespace {
+
+// The state shared by the threads of ParallelFor().
+struct ParallelWork {
+    void (*fn)(void* arg, size_t index);
+    void* arg;
+    size_t count;
+    size_t next;                // the next index to hand out.
+    pthread_mutex_t mutex;      // guards `next`, `failed`, `out_of_memory`, and `error`.
+    bool failed;
+    bool out_of_memory;
+    String error;
+};
+
+// Records the first exception thrown by a call, so that ParallelFor() can throw it again.
+void record_failure(ParallelWork* work, bool out_of_memory, const char* what) {
+    MutexLock lock(&work->mutex);
+    if (!work->failed) {
+        work->failed = true;
+        work->out_of_memory = out_of_memory;
+        work->error.assign(utf8::decode(what));
+    }
+}
+
+void* parallel_worker(void* work_ptr) {
+    ParallelWork* work = reinterpret_cast<ParallelWork*>(work_ptr);
+    while (true) {
+        size_t index;
+        {
+            MutexLock lock(&work->mutex);
+            if (work->failed || (work->next == work->count)) {
+                return NULL;
+            }
+            index = work->next++;
+        }
+        // An exception must not leave a thread started by pthread_create(), so every kind is
+        // caught here.  Only its message survives the trip back to the calling thread.
+        try {
+            work->fn(work->arg, index);
+        } catch (Exception& e) {
+            record_failure(work, false, e.what());
+        } catch (std::bad_alloc& e) {
+            record_failure(work, true, e.what());
+        } catch (std::exception& e) {
+            record_failure(work, false, e.what());
+        } catch (...) {
+            record_failure(work, false, "unknown exception");
+        }
+    }
+}
+
+}  // namespace
+
+void ParallelFor(size_t count, void (*fn)(void* arg, size_t index), void* arg) {
+    ParallelWork work;
+    work.fn = fn;
+    work.arg = arg;
+    work.count = count;
+    work.next = 0;
+    work.failed = false;
+    work.out_of_memory = false;
+    pthread_mutex_init(&work.mutex, NULL);
+
+    // The calling thread is one of the workers.  If a thread can't be started, the others just
+    // take its share.
+    const size_t threads = min<size_t>(max<long>(sysconf(_SC_NPROCESSORS_ONLN), 1), count);
+    vector<pthread_t> workers;
+    for (size_t i = 1; i < threads; ++i) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, parallel_worker, &work) == 0) {
+            workers.push_back(thread);
+        }
+    }
+    parallel_worker(&work);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        pthread_join(workers[i], NULL);
+    }
+
+    pthread_mutex_destroy(&work.mutex);
+    if (work.out_of_memory) {
+        throw std::bad_alloc();
+    } else if (work.failed) {
+        throw Exception(work.error);
+    }
+}
+
+}  // namespace antares
@@ -22,6 +22,8 @@
 #include <cmath>
 #include <sfz/sfz.hpp>
 
+#include "math/simd.hpp"
+
 using sfz::PrintTarget;
 using sfz::range;
 using std::abs;
@@ -49,4 +51,17 @@ void print_to(PrintTarget out, const PrintableFixed& fixed) {
     });
 }
 
+void MultiplyFixedBatch(const Fixed* a, const Fixed* b, Fixed* out, size_t count) {
+    size_t i = 0;
+#ifdef ANTARES_SIMD_SSE2
+    for ( ; (i + 4) <= count; i += 4) {
+        const __m128i product = simd_mullo_epi32(simd_load(a + i), simd_load(b + i));
+        simd_store(out + i, _mm_srai_epi32(product, 8));
+    }
+#endif
+    for ( ; i < count; ++i) {
+        out[i] = mMultiplyFixed(a[i], b[i]);
+    }
+}
+
 }  // namespace antares
@@ -19,9 +19,6 @@
 
 #include "math/random.hpp"
 
-#include "config/preferences.hpp"
-#include "game/globals.hpp"
-
 namespace antares {
 
 namespace {
@@ -39,6 +36,14 @@ int RandomInit() {
 void RandomCleanup() {
 }
 
+int32_t GetRandomGlobalSeed() {
+    return global_seed;
+}
+
+void SetRandomGlobalSeed(int32_t seed) {
+    global_seed = seed;
+}
+
 int32_t Random() {
     return XRandomSeeded(0x8000, &global_seed);
 }
@@ -23,6 +23,7 @@
 
 #include "data/resource.hpp"
 #include "math/macros.hpp"
+#include "math/simd.hpp"
 
 using sfz::BytesSlice;
 using sfz::Exception;
@@ -30,7 +31,6 @@ using sfz::read;
 
 namespace antares {
 
-const int kRotTableSize = 720;
 int32_t gRotTable[kRotTableSize];
 
 void RotationInit() {
@@ -107,4 +107,74 @@ int32_t GetAngleFromVector(int32_t x, int32_t y) {
     return ( whichBest);
 }
 
+void GetRotPointBatch(const int32_t* rotpos, int32_t* x, int32_t* y, size_t count) {
+    // SSE2 can't gather from the table, so this is the scalar lookup, without the calls.
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t* point = gRotTable + (rotpos[i] * 2);
+        x[i] = point[0];
+        y[i] = point[1];
+    }
+}
+
+void GetAngleFromVectorBatch(const int32_t* x, const int32_t* y, int32_t* out, size_t count) {
+    size_t i = 0;
+#ifdef ANTARES_SIMD_SSE2
+    // GetAngleFromVector() walks from 0 or 45 degrees towards 45 or 90, and stops at the first
+    // angle which doesn't come out at least as well as the best so far.  Here, each lane walks
+    // from its own start, with the table entries for both starts loaded into every lane and the
+    // right one picked for each, and stops when every lane has stopped.
+    for ( ; (i + 4) <= count; i += 4) {
+        const __m128i vx = simd_load(x + i);
+        const __m128i vy = simd_load(y + i);
+        const __m128i a = simd_abs_epi32(vx);
+        const __m128i b = simd_abs_epi32(vy);
+        const __m128i upper = _mm_cmplt_epi32(b, a);  // lanes which start from 45 degrees.
+        const __m128i start = _mm_and_si128(upper, _mm_set1_epi32(ROT_45));
+
+        __m128i best = _mm_setzero_si128();
+        __m128i which_best = _mm_setzero_si128();
+        __m128i walking = _mm_set1_epi32(-1);
+        for (int step = 0; step <= ROT_45; ++step) {
+            const int32_t* low = gRotTable + ((ROT_0 + step) * 2);
+            const int32_t* high = gRotTable + ((ROT_45 + step) * 2);
+            const __m128i h = simd_select(upper, _mm_set1_epi32(high[0]), _mm_set1_epi32(low[0]));
+            const __m128i v = simd_select(upper, _mm_set1_epi32(high[1]), _mm_set1_epi32(low[1]));
+            const __m128i test = simd_abs_epi32(_mm_add_epi32(
+                        simd_mullo_epi32(v, a), simd_mullo_epi32(h, b)));
+
+            // The first step always sets the best; later ones only if they improve on it.
+            __m128i better = _mm_cmplt_epi32(test, best);
+            if (step == 0) {
+                better = _mm_set1_epi32(-1);
+            }
+            better = _mm_and_si128(better, walking);
+            best = simd_select(better, test, best);
+            which_best = simd_select(
+                    better, _mm_add_epi32(start, _mm_set1_epi32(step)), which_best);
+            walking = _mm_and_si128(walking, _mm_cmpeq_epi32(test, best));
+            if (_mm_movemask_epi8(walking) == 0) {
+                break;
+            }
+        }
+
+        // Move the angle into the quadrant of (x, y).
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i x_positive = _mm_cmpgt_epi32(vx, zero);
+        const __m128i y_negative = _mm_cmplt_epi32(vy, zero);
+        const __m128i rot_180 = _mm_set1_epi32(ROT_180);
+        const __m128i rot_pos = _mm_set1_epi32(ROT_POS);
+        const __m128i if_x_positive = simd_select(
+                y_negative, _mm_add_epi32(which_best, rot_180), _mm_sub_epi32(rot_pos, which_best));
+        const __m128i if_x_not_positive = simd_select(
+                y_negative, _mm_sub_epi32(rot_180, which_best), which_best);
+        __m128i angle = simd_select(x_positive, if_x_positive, if_x_not_positive);
+        angle = _mm_andnot_si128(_mm_cmpeq_epi32(angle, rot_pos), angle);
+        simd_store(out + i, angle);
+    }
+#endif
+    for ( ; i < count; ++i) {
+        out[i] = GetAngleFromVector(x[i], y[i]);
+    }
+}
+
 }  // namespace antares
@@ -21,6 +21,8 @@
 
 #include <sfz/sfz.hpp>
 
+#include "math/simd.hpp"
+
 using sfz::ReadSource;
 using sfz::read;
 
@@ -451,4 +453,84 @@ int32_t AngleFromSlope(Fixed slope) {
     return 90;
 }
 
+void lsqrt_batch(const uint32_t* n, uint32_t* out, size_t count) {
+    size_t i = 0;
+#ifdef ANTARES_SIMD_SSE2
+    // The same digit-by-digit method as lsqrt(), but always taking all sixteen steps, so that
+    // every lane goes the same way.  lsqrt()'s shortcuts for small and leading-zero inputs only
+    // skip steps which would change nothing.
+    for ( ; (i + 4) <= count; i += 4) {
+        __m128i residue = simd_load(n + i);
+        __m128i root = _mm_setzero_si128();
+        __m128i bit = _mm_set1_epi32(lsqrt_max4pow);
+        for (int step = 0; step < 16; ++step) {
+            const __m128i trial = _mm_add_epi32(root, bit);
+            const __m128i fits = _mm_andnot_si128(
+                    simd_cmplt_epu32(residue, trial), _mm_set1_epi32(-1));
+            residue = _mm_sub_epi32(residue, _mm_and_si128(fits, trial));
+            root = _mm_add_epi32(_mm_srli_epi32(root, 1), _mm_and_si128(fits, bit));
+            bit = _mm_srli_epi32(bit, 2);
+        }
+        // Round up if (root + 1/2)^2 < n, as lsqrt() does.
+        root = _mm_sub_epi32(root, simd_cmplt_epu32(root, residue));
+        simd_store(out + i, root);
+    }
+#endif
+    for ( ; i < count; ++i) {
+        out[i] = lsqrt(n[i]);
+    }
+}
+
+void MyFixRatioBatch(const int16_t* numer, const int16_t* denom, Fixed* out, size_t count) {
+    size_t i = 0;
+#ifdef ANTARES_SIMD_SSE2
+    // MyFixRatio() is `(numer << 16) / denom`, except when `denom` is zero.  (Its special case
+    // for `numer == denom` gives the same as the division.)  SSE2 has no integer division, but
+    // doubles hold the operands exactly, and the quotient can't be rounded across an integer, so
+    // truncating the double quotient gives the integer one.
+    for ( ; (i + 4) <= count; i += 4) {
+        const __m128i n16 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(numer + i));
+        const __m128i d16 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(denom + i));
+        const __m128i n = _mm_srai_epi32(_mm_unpacklo_epi16(n16, n16), 16);
+        const __m128i d = _mm_srai_epi32(_mm_unpacklo_epi16(d16, d16), 16);
+        const __m128i dividend = _mm_slli_epi32(n, 16);
+
+        const __m128i low = _mm_cvttpd_epi32(_mm_div_pd(
+                    _mm_cvtepi32_pd(dividend), _mm_cvtepi32_pd(d)));
+        const __m128i high = _mm_cvttpd_epi32(_mm_div_pd(
+                    _mm_cvtepi32_pd(_mm_srli_si128(dividend, 8)),
+                    _mm_cvtepi32_pd(_mm_srli_si128(d, 8))));
+        const __m128i quotient = _mm_unpacklo_epi64(low, high);
+
+        // 0x7fffffff, negated if `numer` is negative.
+        const __m128i sign = _mm_srai_epi32(n, 31);
+        const __m128i infinity = _mm_sub_epi32(
+                _mm_xor_si128(_mm_set1_epi32(0x7fffffff), sign), sign);
+        const __m128i zero = _mm_cmpeq_epi32(d, _mm_setzero_si128());
+        simd_store(out + i, simd_select(zero, infinity, quotient));
+    }
+#endif
+    for ( ; i < count; ++i) {
+        out[i] = MyFixRatio(numer[i], denom[i]);
+    }
+}
+
+void AngleFromSlopeBatch(const Fixed* slope, int32_t* out, size_t count) {
+    // A binary search for the last entry whose `min_slope` is at most `slope`, which is the one
+    // AngleFromSlope() finds by scanning.  The first entry's `min_slope` is the least int32_t, so
+    // there always is one.  The search takes the same steps for every slope, and the compiler
+    // can make each step a conditional move rather than a branch.  SSE2 can't gather from the
+    // table, so this isn't vectorized.
+    for (size_t i = 0; i < count; ++i) {
+        const AngleFromSlopeData* base = angle_from_slope_data;
+        int n = angle_from_slope_data_count;
+        while (n > 1) {
+            const int half = n / 2;
+            base = (base[half].min_slope <= slope[i]) ? (base + half) : base;
+            n -= half;
+        }
+        out[i] = base->angle;
+    }
+}
+
 }  // namespace antares
@@ -129,7 +129,7 @@ void Master::init() {
 
     // TODO(sfiera): set gRandomSeed.
 
-    gRealWorld = new ArrayPixMap(world.width(), world.height());
+    gRealWorld = new TrackedPixMap(world.width(), world.height());
     CreateOffscreenWorld();
 
     InitSpriteCursor();
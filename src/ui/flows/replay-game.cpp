@@ -36,9 +36,9 @@ using std::swap;
 ReplayGame::ReplayGame(int16_t replay_id):
         _state(NEW),
         _resource("replays", "NLRP", replay_id),
-        _data(_resource.data()),
-        _random_seed(_data.global_seed),
-        _scenario(GetScenarioPtrFromChapter(_data.chapter_id)),
+        _replay(_resource.data()),
+        _random_seed(_replay.global_seed()),
+        _scenario(GetScenarioPtrFromChapter(_replay.chapter_id())),
         _game_result(NO_GAME) { }
 
 ReplayGame::~ReplayGame() { }
@@ -53,10 +53,10 @@ void ReplayGame::become_front() {
       case FADING_OUT:
         {
             _state = PLAYING;
-            globals()->gInputSource.reset(new ReplayInputSource(&_data));
+            globals()->gInputSource.reset(new ReplayInputSource(_replay));
             swap(_random_seed, gRandomSeed);
             _game_result = NO_GAME;
-            stack()->push(new MainPlay(_scenario, true, &_game_result));
+            stack()->push(new MainPlay(_scenario, true, false, &_game_result));
         }
         break;
 
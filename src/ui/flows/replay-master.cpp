@@ -0,0 +1,112 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "ui/flows/replay-master.hpp"
+
+#include <sfz/sfz.hpp>
+
+#include "config/preferences.hpp"
+#include "drawing/color.hpp"
+#include "drawing/offscreen-gworld.hpp"
+#include "drawing/pix-map.hpp"
+#include "drawing/sprite-handling.hpp"
+#include "drawing/text.hpp"
+#include "game/admiral.hpp"
+#include "game/beam.hpp"
+#include "game/cheat.hpp"
+#include "game/cursor.hpp"
+#include "game/globals.hpp"
+#include "game/input-source.hpp"
+#include "game/instruments.hpp"
+#include "game/labels.hpp"
+#include "game/messages.hpp"
+#include "game/motion.hpp"
+#include "game/scenario-maker.hpp"
+#include "game/space-object.hpp"
+#include "math/random.hpp"
+#include "math/rotation.hpp"
+#include "sound/driver.hpp"
+#include "sound/fx.hpp"
+#include "sound/music.hpp"
+#include "ui/interface-handling.hpp"
+
+using sfz::BytesSlice;
+
+namespace antares {
+
+ReplayMaster::ReplayMaster(BytesSlice data, bool simulate_only, GameResult* game_result):
+        _state(NEW),
+        _replay(data),
+        _random_seed(_replay.global_seed()),
+        _simulate_only(simulate_only),
+        _game_result(game_result) { }
+
+void ReplayMaster::become_front() {
+    switch (_state) {
+      case NEW:
+        _state = REPLAY;
+        init();
+        Randomize(4);  // For the decision to replay intro.
+        *_game_result = NO_GAME;
+        gRandomSeed = _random_seed;
+        globals()->gInputSource.reset(new ReplayInputSource(_replay));
+        stack()->push(new MainPlay(
+                    GetScenarioPtrFromChapter(_replay.chapter_id()), true, _simulate_only,
+                    _game_result));
+        break;
+
+      case REPLAY:
+        stack()->pop(this);
+        break;
+    }
+}
+
+void ReplayMaster::init() {
+    init_globals();
+
+    SoundDriver::driver()->set_global_volume(8);  // Max volume.
+
+    world = Rect(Point(0, 0), Preferences::preferences()->screen_size());
+    play_screen = Rect(
+        world.left + kLeftPanelWidth, world.top,
+        world.right - kRightPanelWidth, world.bottom);
+    viewport = play_screen;
+
+    gRealWorld = new TrackedPixMap(world.width(), world.height());
+    gRealWorld->fill(RgbColor::kBlack);
+    CreateOffscreenWorld();
+    InitSpriteCursor();
+    RotationInit();
+    InterfaceHandlingInit();
+    InitDirectText();
+    ScreenLabelInit();
+    InitMessageScreen();
+    InstrumentInit();
+    SpriteHandlingInit();
+    AresCheatInit();
+    ScenarioMakerInit();
+    SpaceObjectHandlingInit();  // MUST be after ScenarioMakerInit()
+    InitSoundFX();
+    MusicInit();
+    InitMotion();
+    AdmiralInit();
+    InitBeams();
+}
+
+}  // namespace antares
@@ -56,6 +56,15 @@ Stencil::~Stencil() {
     _driver->end_stencil();
 }
 
+PrimitiveBatch::PrimitiveBatch(VideoDriver* driver):
+        _driver(driver) {
+    _driver->begin_batch();
+}
+
+PrimitiveBatch::~PrimitiveBatch() {
+    _driver->end_batch();
+}
+
 Sprite::~Sprite() { }
 
 }  // namespace antares
@@ -0,0 +1,151 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "video/frame-stream.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sfz/sfz.hpp>
+
+#include "video/png-writer.hpp"
+
+using sfz::BytesSlice;
+using sfz::Exception;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::format;
+using std::min;
+
+namespace utf8 = sfz::utf8;
+
+namespace antares {
+
+namespace {
+
+int open_stream(const StringSlice& path) {
+    if (path == "-") {
+        const int fd = dup(1);
+        if (fd < 0) {
+            throw Exception("couldn't open standard output");
+        }
+        return fd;
+    }
+    return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+}
+
+// BT.601 studio-range conversion from 8-bit R'G'B', in 8.8 fixed point.  The chroma constants
+// fold in the +128 offset and rounding, so that the shifted value is never negative.
+inline uint8_t luma(int r, int g, int b) {
+    return ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+}
+
+inline uint8_t blue_chroma(int r, int g, int b) {
+    return (-38 * r - 74 * g + 112 * b + 32896) >> 8;
+}
+
+inline uint8_t red_chroma(int r, int g, int b) {
+    return (112 * r - 94 * g - 18 * b + 32896) >> 8;
+}
+
+}  // namespace
+
+FrameStream::FrameStream(
+        const StringSlice& path, Format stream_format, const Size& size,
+        int frames_per_second_num, int frames_per_second_den)
+        : _fd(open_stream(path)),
+          _format(stream_format),
+          _size(size) {
+    if (_format == Y4M) {
+        String header(format(
+                    "YUV4MPEG2 W{0} H{1} F{2}:{3} Ip A1:1 C420jpeg\n",
+                    size.width, size.height, frames_per_second_num, frames_per_second_den));
+        sfz::write(_fd, utf8::encode(header));
+    }
+}
+
+void FrameStream::write(const PixMap& pix) {
+    if ((pix.size().width != _size.width) || (pix.size().height != _size.height)) {
+        throw Exception("frame size changed during video stream");
+    }
+    switch (_format) {
+      case Y4M:
+        write_y4m(pix);
+        break;
+      case RGBA:
+        write_rgba(pix);
+        break;
+    }
+}
+
+void FrameStream::write_y4m(const PixMap& pix) {
+    static const char kFrameHeader[] = "FRAME\n";
+    const int width = _size.width;
+    const int height = _size.height;
+    const int chroma_width = (width + 1) / 2;
+    const int chroma_height = (height + 1) / 2;
+    const size_t luma_size = width * height;
+    const size_t chroma_size = chroma_width * chroma_height;
+    _frame.resize(luma_size + (2 * chroma_size));
+    uint8_t* y_plane = &_frame[0];
+    uint8_t* cb_plane = y_plane + luma_size;
+    uint8_t* cr_plane = cb_plane + chroma_size;
+
+    for (int y = 0; y < height; ++y) {
+        const RgbColor* row = pix.row(y);
+        for (int x = 0; x < width; ++x) {
+            *(y_plane++) = luma(row[x].red, row[x].green, row[x].blue);
+        }
+    }
+
+    // Each chroma sample covers a 2x2 block of pixels, and is taken from their average; at the
+    // right and bottom edges of an odd-sized frame, the last row or column stands in for the
+    // missing one.
+    for (int cy = 0; cy < chroma_height; ++cy) {
+        const RgbColor* top = pix.row(2 * cy);
+        const RgbColor* bottom = pix.row(min(2 * cy + 1, height - 1));
+        for (int cx = 0; cx < chroma_width; ++cx) {
+            const int left = 2 * cx;
+            const int right = min(left + 1, width - 1);
+            const int r = (top[left].red + top[right].red
+                    + bottom[left].red + bottom[right].red + 2) >> 2;
+            const int g = (top[left].green + top[right].green
+                    + bottom[left].green + bottom[right].green + 2) >> 2;
+            const int b = (top[left].blue + top[right].blue
+                    + bottom[left].blue + bottom[right].blue + 2) >> 2;
+            *(cb_plane++) = blue_chroma(r, g, b);
+            *(cr_plane++) = red_chroma(r, g, b);
+        }
+    }
+
+    sfz::write(_fd, BytesSlice(reinterpret_cast<const uint8_t*>(kFrameHeader),
+                sizeof(kFrameHeader) - 1));
+    sfz::write(_fd, BytesSlice(&_frame[0], _frame.size()));
+}
+
+void FrameStream::write_rgba(const PixMap& pix) {
+    const int width = _size.width;
+    _frame.resize(width * _size.height * 4);
+    for (int y = 0; y < _size.height; ++y) {
+        argb_to_rgba(pix.row(y), &_frame[y * width * 4], width);
+    }
+    sfz::write(_fd, BytesSlice(&_frame[0], _frame.size()));
+}
+
+}  // namespace antares
@@ -21,6 +21,7 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include <vector>
 #include <OpenGL/OpenGL.h>
 #include <OpenGL/gl.h>
 #include <sfz/sfz.hpp>
@@ -34,31 +35,75 @@ using sfz::Exception;
 using sfz::PrintItem;
 using sfz::String;
 using sfz::StringSlice;
+using sfz::scoped_ptr;
 using std::min;
 using std::max;
+using std::vector;
 
 namespace antares {
 
 namespace {
 
-class OpenGlSprite : public Sprite {
-  public:
-    OpenGlSprite(PrintItem name, const PixMap& image)
-            : _name(name),
-              _size(image.size()) {
-        glBindTexture(GL_TEXTURE_RECTANGLE_EXT, _texture.id);
-        glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+GLenum texture_type() {
 #if defined(__LITTLE_ENDIAN__)
-        GLenum type = GL_UNSIGNED_INT_8_8_8_8;
+    return GL_UNSIGNED_INT_8_8_8_8;
 #elif defined(__BIG_ENDIAN__)
-        GLenum type = GL_UNSIGNED_INT_8_8_8_8_REV;
+    return GL_UNSIGNED_INT_8_8_8_8_REV;
 #else
 #error "Couldn't determine endianness of platform"
 #endif
+}
+
+void set_nearest_filter() {
+    glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+// Appends a vertex at (x, y), with texture coordinate (s, t), to `batch`.
+void add_vertex(vector<GLfloat>* batch, GLfloat s, GLfloat t, GLfloat x, GLfloat y) {
+    batch->push_back(s);
+    batch->push_back(t);
+    batch->push_back(x);
+    batch->push_back(y);
+}
+
+}  // namespace
+
+class OpenGlVideoDriver::OpenGlSprite : public Sprite {
+  public:
+    // A sprite with a texture of its own, holding `image`.
+    OpenGlSprite(PrintItem name, const PixMap& image, OpenGlVideoDriver* driver)
+            : _name(name),
+              _size(image.size()),
+              _texture(new Texture),
+              _texture_id(_texture->id),
+              _bounds(image.size().as_rect()),
+              _driver(driver),
+              _packed(false) {
+        glBindTexture(GL_TEXTURE_RECTANGLE_EXT, _texture_id);
+        set_nearest_filter();
         glTexImage2D(
                 GL_TEXTURE_RECTANGLE_EXT, 0, GL_RGBA, _size.width, _size.height,
-                0, GL_BGRA, type, image.bytes());
+                0, GL_BGRA, texture_type(), image.bytes());
+    }
+
+    // A sprite whose texels are at `location` in the atlas page `texture`.
+    OpenGlSprite(
+            PrintItem name, const Size& size, uint32_t texture,
+            const TextureAtlas::Location& location, OpenGlVideoDriver* driver)
+            : _name(name),
+              _size(size),
+              _texture_id(texture),
+              _bounds(location.bounds),
+              _location(location),
+              _driver(driver),
+              _packed(true) { }
+
+    virtual ~OpenGlSprite() {
+        _driver->flush();
+        if (_packed) {
+            _driver->_atlas.release(_location);
+        }
     }
 
     virtual StringSlice name() const {
@@ -72,26 +117,24 @@ class OpenGlSprite : public Sprite {
     }
 
     virtual void draw(const Rect& draw_rect) const {
-        const int32_t w = _size.width;
-        const int32_t h = _size.height;
-        glBindTexture(GL_TEXTURE_RECTANGLE_EXT, _texture.id);
-        glColor4f(1, 1, 1, 1);
-        glBegin(GL_QUADS);
-        glTexCoord2f(0, 0);
-        glVertex2f(draw_rect.left, draw_rect.top);
-        glTexCoord2f(0, h);
-        glVertex2f(draw_rect.left, draw_rect.bottom);
-        glTexCoord2f(w, h);
-        glVertex2f(draw_rect.right, draw_rect.bottom);
-        glTexCoord2f(w, 0);
-        glVertex2f(draw_rect.right, draw_rect.top);
-        glEnd();
+        _driver->batch_quad(_texture_id, _bounds, draw_rect);
     }
 
     virtual const Size& size() const {
         return _size;
     }
 
+    virtual void update(const PixMap& image, const Rect& bounds) {
+        _driver->flush();
+        glBindTexture(GL_TEXTURE_RECTANGLE_EXT, _texture_id);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, image.row_bytes());
+        glTexSubImage2D(
+                GL_TEXTURE_RECTANGLE_EXT, 0, _bounds.left + bounds.left, _bounds.top + bounds.top,
+                bounds.width(), bounds.height(),
+                GL_BGRA, texture_type(), image.row(bounds.top) + bounds.left);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+
   private:
     struct Texture {
         Texture() { glGenTextures(1, &id); }
@@ -102,20 +145,30 @@ class OpenGlSprite : public Sprite {
     };
 
     const String _name;
-    Texture _texture;
     Size _size;
+    scoped_ptr<Texture> _texture;
+    const GLuint _texture_id;
+    const Rect _bounds;
+    TextureAtlas::Location _location;
+    OpenGlVideoDriver* const _driver;
+    const bool _packed;
 
     DISALLOW_COPY_AND_ASSIGN(OpenGlSprite);
 };
 
-}  // namespace
-
 OpenGlVideoDriver::OpenGlVideoDriver(Size screen_size)
         : _screen_size(screen_size),
+          _atlas(Size(kTextureAtlasPageSize, kTextureAtlasPageSize)),
+          _batch_texture(0),
+          _shape_mode(GL_POINTS),
           _transition_fraction(0.0),
           _transition_color(RgbColor::kBlack),
           _stencil_height(0) { }
 
+OpenGlVideoDriver::~OpenGlVideoDriver() {
+    delete_atlas_textures();
+}
+
 void OpenGlVideoDriver::set_game_state(GameState state) {
 }
 
@@ -126,10 +179,107 @@ int OpenGlVideoDriver::get_demo_scenario() {
 void OpenGlVideoDriver::main_loop_iteration_complete(uint32_t) { }
 
 Sprite* OpenGlVideoDriver::new_sprite(PrintItem name, const PixMap& content) {
-    return new OpenGlSprite(name, content);
+    flush();
+    return new OpenGlSprite(name, content, this);
+}
+
+Sprite* OpenGlVideoDriver::new_packed_sprite(PrintItem name, const PixMap& content) {
+    return pack_sprite(name, content, false);
+}
+
+Sprite* OpenGlVideoDriver::new_persistent_sprite(PrintItem name, const PixMap& content) {
+    return pack_sprite(name, content, true);
+}
+
+Sprite* OpenGlVideoDriver::pack_sprite(PrintItem name, const PixMap& content, bool persistent) {
+    TextureAtlas::Location location;
+    if (!_atlas.place(content.size(), persistent, &location)) {
+        return new_sprite(name, content);
+    }
+    flush();
+    while (_atlas_textures.size() <= location.page) {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_RECTANGLE_EXT, texture);
+        set_nearest_filter();
+        glTexImage2D(
+                GL_TEXTURE_RECTANGLE_EXT, 0, GL_RGBA, kTextureAtlasPageSize, kTextureAtlasPageSize,
+                0, GL_BGRA, texture_type(), NULL);
+        _atlas_textures.push_back(texture);
+    }
+    const GLuint texture = _atlas_textures[location.page];
+    glBindTexture(GL_TEXTURE_RECTANGLE_EXT, texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, content.row_bytes());
+    glTexSubImage2D(
+            GL_TEXTURE_RECTANGLE_EXT, 0, location.bounds.left, location.bounds.top,
+            location.bounds.width(), location.bounds.height(),
+            GL_BGRA, texture_type(), content.bytes());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    return new OpenGlSprite(name, content.size(), texture, location, this);
+}
+
+void OpenGlVideoDriver::delete_atlas_textures() {
+    if (!_atlas_textures.empty()) {
+        flush();
+        glDeleteTextures(_atlas_textures.size(), &_atlas_textures[0]);
+        _atlas_textures.clear();
+    }
+}
+
+void OpenGlVideoDriver::batch_quad(uint32_t texture, const Rect& source, const Rect& dest) {
+    if (!_shape_vertices.empty() || (texture != _batch_texture)) {
+        flush();
+        _batch_texture = texture;
+    }
+    add_vertex(&_batch, source.left, source.top, dest.left, dest.top);
+    add_vertex(&_batch, source.left, source.bottom, dest.left, dest.bottom);
+    add_vertex(&_batch, source.right, source.bottom, dest.right, dest.bottom);
+    add_vertex(&_batch, source.right, source.top, dest.right, dest.top);
+}
+
+void OpenGlVideoDriver::batch_vertex(uint32_t mode, float x, float y, const RgbColor& color) {
+    if (!_batch.empty() || (mode != _shape_mode)) {
+        flush();
+        _shape_mode = mode;
+    }
+    _shape_vertices.push_back(x);
+    _shape_vertices.push_back(y);
+    _shape_colors.push_back(color.red);
+    _shape_colors.push_back(color.green);
+    _shape_colors.push_back(color.blue);
+    _shape_colors.push_back(color.alpha);
+}
+
+void OpenGlVideoDriver::flush() {
+    if (!_batch.empty()) {
+        const GLsizei stride = 4 * sizeof(GLfloat);
+        glBindTexture(GL_TEXTURE_RECTANGLE_EXT, _batch_texture);
+        glColor4f(1, 1, 1, 1);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, stride, &_batch[0]);
+        glVertexPointer(2, GL_FLOAT, stride, &_batch[2]);
+        glDrawArrays(GL_QUADS, 0, _batch.size() / 4);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        _batch.clear();
+    }
+    if (!_shape_vertices.empty()) {
+        glBindTexture(GL_TEXTURE_RECTANGLE_EXT, 0);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, &_shape_colors[0]);
+        glVertexPointer(2, GL_FLOAT, 0, &_shape_vertices[0]);
+        glDrawArrays(_shape_mode, 0, _shape_vertices.size() / 2);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_COLOR_ARRAY);
+        _shape_vertices.clear();
+        _shape_colors.clear();
+    }
 }
 
 void OpenGlVideoDriver::fill_rect(const Rect& rect, const RgbColor& color) {
+    flush();
     glBindTexture(GL_TEXTURE_RECTANGLE_EXT, 0);
     glColor4ub(color.red, color.green, color.blue, color.alpha);
     glBegin(GL_QUADS);
@@ -141,19 +291,27 @@ void OpenGlVideoDriver::fill_rect(const Rect& rect, const RgbColor& color) {
 }
 
 void OpenGlVideoDriver::draw_point(const Point& at, const RgbColor& color) {
-    glBindTexture(GL_TEXTURE_RECTANGLE_EXT, 0);
-    glColor4ub(color.red, color.green, color.blue, color.alpha);
-    glBegin(GL_POINTS);
-    glVertex2f(at.h + 0.5, at.v + 0.5);
-    glEnd();
+    batch_point(at, color);
+    flush();
 }
 
 void OpenGlVideoDriver::draw_line(const Point& from, const Point& to, const RgbColor& color) {
-    glBindTexture(GL_TEXTURE_RECTANGLE_EXT, 0);
+    batch_line(from, to, color);
+    flush();
+}
+
+void OpenGlVideoDriver::begin_batch() {
+    flush();
+}
 
+void OpenGlVideoDriver::batch_point(const Point& at, const RgbColor& color) {
+    batch_vertex(GL_POINTS, at.h + 0.5, at.v + 0.5, color);
+}
+
+void OpenGlVideoDriver::batch_line(const Point& from, const Point& to, const RgbColor& color) {
     // Shortcut: when `from` == `to`, we can draw just a point.
     if (from == to) {
-        draw_point(from, color);
+        batch_point(from, color);
         return;
     }
 
@@ -164,7 +322,10 @@ void OpenGlVideoDriver::draw_line(const Point& from, const Point& to, const RgbC
         Rect rect(
                 min(from.h, to.h), min(from.v, to.v),
                 max(from.h, to.h) + 1, max(from.v, to.v) + 1);
-        fill_rect(rect, color);
+        batch_vertex(GL_QUADS, rect.right, rect.top, color);
+        batch_vertex(GL_QUADS, rect.left, rect.top, color);
+        batch_vertex(GL_QUADS, rect.left, rect.bottom, color);
+        batch_vertex(GL_QUADS, rect.right, rect.bottom, color);
         return;
     }
 
@@ -206,11 +367,12 @@ void OpenGlVideoDriver::draw_line(const Point& from, const Point& to, const RgbC
         y2 += 0.5f;
     }
 
-    glColor4ub(color.red, color.green, color.blue, color.alpha);
-    glBegin(GL_LINES);
-    glVertex2f(x1, y1);
-    glVertex2f(x2, y2);
-    glEnd();
+    batch_vertex(GL_LINES, x1, y1, color);
+    batch_vertex(GL_LINES, x2, y2, color);
+}
+
+void OpenGlVideoDriver::end_batch() {
+    flush();
 }
 
 void OpenGlVideoDriver::set_transition_fraction(double fraction) {
@@ -222,6 +384,7 @@ void OpenGlVideoDriver::set_transition_to(const RgbColor& color) {
 }
 
 void OpenGlVideoDriver::start_stencil() {
+    flush();
     glColorMask(0, 0, 0, 0);
     glAlphaFunc(GL_GREATER, 0);
     glStencilFunc(GL_GEQUAL, _stencil_height, 0xff);
@@ -230,6 +393,7 @@ void OpenGlVideoDriver::start_stencil() {
 }
 
 void OpenGlVideoDriver::set_stencil_threshold(uint8_t alpha) {
+    flush();
     glAlphaFunc(GL_GREATER, alpha / 256.0);
 }
 
@@ -243,6 +407,7 @@ void OpenGlVideoDriver::end_stencil() {
 }
 
 void OpenGlVideoDriver::normalize_stencil() {
+    flush();
     glColorMask(0, 0, 0, 0);
     glAlphaFunc(GL_ALWAYS, 0);
     glStencilFunc(GL_LEQUAL, _stencil_height, 0xff);
@@ -277,10 +442,14 @@ OpenGlVideoDriver::MainLoop::Setup::Setup() {
     glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 }
 
-OpenGlVideoDriver::MainLoop::MainLoop(const OpenGlVideoDriver& driver, Card* initial):
+OpenGlVideoDriver::MainLoop::MainLoop(OpenGlVideoDriver& driver, Card* initial):
         _driver(driver),
         _stack(initial) { }
 
+OpenGlVideoDriver::MainLoop::~MainLoop() {
+    _driver.delete_atlas_textures();
+}
+
 bool OpenGlVideoDriver::MainLoop::done() {
     return _stack.empty();
 }
@@ -299,6 +468,7 @@ void OpenGlVideoDriver::MainLoop::draw() {
     glScalef(1.0 / _driver._screen_size.width, 1.0 / _driver._screen_size.height, 1.0);
 
     _stack.top()->draw();
+    _driver.flush();
 
     glPopMatrix();
     glMatrixMode(GL_PROJECTION);
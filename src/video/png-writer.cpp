@@ -0,0 +1,211 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "video/png-writer.hpp"
+
+#include <fcntl.h>
+#include <string.h>
+#include <exception>
+#include <sfz/sfz.hpp>
+
+#include "lang/threads.hpp"
+#include "math/simd.hpp"
+
+using sfz::Exception;
+using sfz::ScopedFd;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::format;
+using sfz::linked_ptr;
+using std::vector;
+
+namespace utf8 = sfz::utf8;
+
+namespace antares {
+
+namespace {
+
+// Rotates a pixel, loaded as a 32-bit word, from A, R, G, B to R, G, B, A byte order.
+inline uint32_t rotate_pixel(uint32_t pixel) {
+#if defined(__LITTLE_ENDIAN__) \
+    || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+    return (pixel >> 8) | (pixel << 24);
+#elif defined(__BIG_ENDIAN__) \
+    || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__))
+    return (pixel << 8) | (pixel >> 24);
+#else
+#error "Couldn't determine endianness of platform"
+#endif
+}
+
+}  // namespace
+
+void argb_to_rgba(const RgbColor* argb, uint8_t* rgba, size_t count) {
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(argb);
+    size_t i = 0;
+#ifdef ANTARES_SIMD_SSE2
+    // Four pixels at a time, rotating each 32-bit lane as rotate_pixel() does.  x86 is
+    // little-endian, so the rotation is always to the right.
+    for ( ; (i + 4) <= count; i += 4) {
+        const __m128i pixels = simd_load(in + (4 * i));
+        simd_store(rgba + (4 * i),
+                _mm_or_si128(_mm_srli_epi32(pixels, 8), _mm_slli_epi32(pixels, 24)));
+    }
+#endif
+    for ( ; i < count; ++i) {
+        uint32_t pixel;
+        memcpy(&pixel, in + (4 * i), 4);
+        pixel = rotate_pixel(pixel);
+        memcpy(rgba + (4 * i), &pixel, 4);
+    }
+}
+
+PngWriter::PngWriter(int buffers)
+        : _started(false),
+          _encoding(0),
+          _stopping(false),
+          _failed(false) {
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_frame_queued, NULL);
+    pthread_cond_init(&_frame_done, NULL);
+    for (int i = 0; i < buffers; ++i) {
+        _frames.push_back(linked_ptr<Frame>(new Frame));
+        _free.push_back(_frames.back().get());
+    }
+    if (pthread_create(&_thread, NULL, thread_main, this) != 0) {
+        stop();
+        throw Exception("couldn't start PNG writer thread");
+    }
+    _started = true;
+}
+
+PngWriter::~PngWriter() {
+    stop();
+}
+
+void PngWriter::stop() {
+    {
+        MutexLock lock(&_mutex);
+        _stopping = true;
+        pthread_cond_broadcast(&_frame_queued);
+    }
+    if (_started) {
+        pthread_join(_thread, NULL);
+    }
+    pthread_cond_destroy(&_frame_done);
+    pthread_cond_destroy(&_frame_queued);
+    pthread_mutex_destroy(&_mutex);
+}
+
+void PngWriter::write(const StringSlice& path, const PixMap& pix) {
+    Frame* frame;
+    {
+        MutexLock lock(&_mutex);
+        while (_free.empty() && !_failed) {
+            pthread_cond_wait(&_frame_done, &_mutex);
+        }
+        check_error();
+        frame = _free.back();
+        _free.pop_back();
+    }
+
+    // The frame belongs to this thread until it is queued, so it can be filled without the lock.
+    const int width = pix.size().width;
+    frame->path.assign(path);
+    frame->size = pix.size();
+    frame->rgba.resize(width * pix.size().height * 4);
+    for (int y = 0; y < pix.size().height; ++y) {
+        argb_to_rgba(pix.row(y), &frame->rgba[y * width * 4], width);
+    }
+
+    MutexLock lock(&_mutex);
+    _queue.push_back(frame);
+    pthread_cond_signal(&_frame_queued);
+}
+
+void PngWriter::finish() {
+    MutexLock lock(&_mutex);
+    while (!_queue.empty() || (_encoding > 0)) {
+        pthread_cond_wait(&_frame_done, &_mutex);
+    }
+    check_error();
+}
+
+void* PngWriter::thread_main(void* writer) {
+    reinterpret_cast<PngWriter*>(writer)->encode_frames();
+    return NULL;
+}
+
+void PngWriter::encode_frame(void* batch, size_t index) {
+    Frame* frame = (*reinterpret_cast<vector<Frame*>*>(batch))[index];
+    try {
+        ScopedFd file(open(frame->path, O_WRONLY | O_CREAT | O_TRUNC, 0644));
+        write_rgba_png(file, frame->size, &frame->rgba[0]);
+    } catch (Exception& e) {
+        throw Exception(format("{0}: {1}", frame->path, e.what()));
+    }
+}
+
+void PngWriter::encode_frames() {
+    vector<Frame*> batch;
+    while (true) {
+        {
+            MutexLock lock(&_mutex);
+            while (_queue.empty() && !_stopping) {
+                pthread_cond_wait(&_frame_queued, &_mutex);
+            }
+            if (_queue.empty()) {
+                return;
+            }
+            batch.assign(_queue.begin(), _queue.end());
+            _queue.clear();
+            _encoding = batch.size();
+        }
+
+        String error;
+        bool failed = false;
+        try {
+            ParallelFor(batch.size(), encode_frame, &batch);
+        } catch (Exception& e) {
+            failed = true;
+            error.assign(utf8::decode(e.what()));
+        } catch (std::exception& e) {
+            failed = true;
+            error.assign(utf8::decode(e.what()));
+        }
+
+        MutexLock lock(&_mutex);
+        _encoding = 0;
+        _free.insert(_free.end(), batch.begin(), batch.end());
+        if (failed && !_failed) {
+            _failed = true;
+            _error.assign(error);
+        }
+        pthread_cond_broadcast(&_frame_done);
+    }
+}
+
+// Must be called with `_mutex` held.
+void PngWriter::check_error() {
+    if (_failed) {
+        throw Exception(_error);
+    }
+}
+
+}  // namespace antares
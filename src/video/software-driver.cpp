@@ -0,0 +1,399 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "video/software-driver.hpp"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <sfz/sfz.hpp>
+
+#include "drawing/color.hpp"
+#include "drawing/pix-map.hpp"
+#include "math/geometry.hpp"
+#include "ui/card.hpp"
+
+using sfz::PrintItem;
+using sfz::String;
+using sfz::StringSlice;
+using sfz::make_linked_ptr;
+using sfz::scoped_ptr;
+using std::max;
+using std::min;
+using std::vector;
+
+namespace antares {
+
+namespace {
+
+// Blends `src` over `dst` as glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA) would into an
+// 8-bit frame buffer with no alpha channel.
+inline void blend(RgbColor* dst, const RgbColor& src) {
+    const uint32_t a = src.alpha;
+    if (a == 0xff) {
+        *dst = RgbColor(src.red, src.green, src.blue);
+    } else if (a != 0x00) {
+        const uint32_t b = 0xff - a;
+        dst->red    = (src.red   * a + dst->red   * b + 0x7f) / 0xff;
+        dst->green  = (src.green * a + dst->green * b + 0x7f) / 0xff;
+        dst->blue   = (src.blue  * a + dst->blue  * b + 0x7f) / 0xff;
+    }
+}
+
+}  // namespace
+
+class SoftwareVideoDriver::SoftwareSprite : public Sprite {
+  public:
+    // A sprite with its own copy of `image`.
+    SoftwareSprite(PrintItem name, const PixMap& image, SoftwareVideoDriver* driver)
+            : _name(name),
+              _image(new ArrayPixMap(image.size().width, image.size().height)),
+              _view(_image.get(), image.size().as_rect()),
+              _driver(driver),
+              _packed(false) {
+        _image->copy(image);
+    }
+
+    // A sprite whose pixels have been copied to `location` in `page` of the driver's atlas.
+    SoftwareSprite(
+            PrintItem name, PixMap* page, const TextureAtlas::Location& location,
+            SoftwareVideoDriver* driver)
+            : _name(name),
+              _view(page, location.bounds),
+              _location(location),
+              _driver(driver),
+              _packed(true) { }
+
+    virtual ~SoftwareSprite() {
+        if (_packed) {
+            _driver->_atlas.release(_location);
+        }
+    }
+
+    virtual StringSlice name() const {
+        return _name;
+    }
+
+    virtual void draw(int32_t x, int32_t y) const {
+        const int32_t w = _view.size().width;
+        const int32_t h = _view.size().height;
+        const int32_t left = max(x, 0);
+        const int32_t right = min(x + w, _driver->_screen_size.width);
+        if (left >= right) {
+            return;
+        }
+        const int32_t top = max(y, 0);
+        const int32_t bottom = min(y + h, _driver->_screen_size.height);
+        for (int32_t v = top; v < bottom; ++v) {
+            const RgbColor* src = _view.row(v - y) + (left - x);
+            _driver->draw_span(left, v, right - left, src, 1);
+        }
+    }
+
+    virtual void draw(const Rect& draw_rect) const {
+        const int32_t w = _view.size().width;
+        const int32_t h = _view.size().height;
+        if ((draw_rect.width() == w) && (draw_rect.height() == h)) {
+            draw(draw_rect.left, draw_rect.top);
+            return;
+        }
+        if ((draw_rect.width() <= 0) || (draw_rect.height() <= 0)) {
+            return;
+        }
+
+        // Scaled drawing: sample the texel under the center of each destination pixel, as
+        // GL_NEAREST does.  Each row is resampled into `_row` and then drawn as one span.
+        Rect clipped(draw_rect);
+        clipped.clip_to(_driver->_screen_size.as_rect());
+        if (clipped.empty()) {
+            return;
+        }
+        const int64_t dw = draw_rect.width();
+        const int64_t dh = draw_rect.height();
+        _row.resize(clipped.width());
+        for (int32_t v = clipped.top; v < clipped.bottom; ++v) {
+            const int32_t ty = ((2 * (v - draw_rect.top) + 1) * h) / (2 * dh);
+            const RgbColor* src = _view.row(ty);
+            for (int32_t x = clipped.left; x < clipped.right; ++x) {
+                const int32_t tx = ((2 * (x - draw_rect.left) + 1) * w) / (2 * dw);
+                _row[x - clipped.left] = src[tx];
+            }
+            _driver->draw_span(clipped.left, v, clipped.width(), &_row[0], 1);
+        }
+    }
+
+    virtual const Size& size() const {
+        return _view.size();
+    }
+
+    virtual void update(const PixMap& image, const Rect& bounds) {
+        RgbColor* out = _view.mutable_region(bounds);
+        for (int32_t y = bounds.top; y < bounds.bottom; ++y) {
+            memcpy(out, image.row(y) + bounds.left, bounds.width() * sizeof(RgbColor));
+            out += _view.row_bytes();
+        }
+    }
+
+  private:
+    const String _name;
+    scoped_ptr<ArrayPixMap> _image;
+    PixMap::View _view;
+    TextureAtlas::Location _location;
+    SoftwareVideoDriver* const _driver;
+    const bool _packed;
+    mutable vector<RgbColor> _row;
+
+    DISALLOW_COPY_AND_ASSIGN(SoftwareSprite);
+};
+
+SoftwareVideoDriver::SoftwareVideoDriver(Size screen_size)
+        : _screen_size(screen_size),
+          _pix(screen_size.width, screen_size.height),
+          _stencil(new uint8_t[screen_size.width * screen_size.height]),
+          _atlas(Size(kTextureAtlasPageSize, kTextureAtlasPageSize)),
+          _transition_fraction(0.0),
+          _transition_color(RgbColor::kBlack),
+          _stencil_writing(false),
+          _stencil_threshold(0),
+          _stencil_height(0) {
+    clear();
+}
+
+void SoftwareVideoDriver::set_game_state(GameState state) {
+}
+
+int SoftwareVideoDriver::get_demo_scenario() {
+    return -1;
+}
+
+void SoftwareVideoDriver::main_loop_iteration_complete(uint32_t) { }
+
+Sprite* SoftwareVideoDriver::new_sprite(PrintItem name, const PixMap& content) {
+    return new SoftwareSprite(name, content, this);
+}
+
+Sprite* SoftwareVideoDriver::new_packed_sprite(PrintItem name, const PixMap& content) {
+    return pack_sprite(name, content, false);
+}
+
+Sprite* SoftwareVideoDriver::new_persistent_sprite(PrintItem name, const PixMap& content) {
+    return pack_sprite(name, content, true);
+}
+
+Sprite* SoftwareVideoDriver::pack_sprite(
+        PrintItem name, const PixMap& content, bool persistent) {
+    TextureAtlas::Location location;
+    if (!_atlas.place(content.size(), persistent, &location)) {
+        return new_sprite(name, content);
+    }
+    while (_atlas_pages.size() <= location.page) {
+        _atlas_pages.push_back(make_linked_ptr(
+                    new ArrayPixMap(kTextureAtlasPageSize, kTextureAtlasPageSize)));
+    }
+    PixMap* page = _atlas_pages[location.page].get();
+    page->view(location.bounds).copy(content);
+    return new SoftwareSprite(name, page, location, this);
+}
+
+void SoftwareVideoDriver::fill_rect(const Rect& rect, const RgbColor& color) {
+    // Like a GL_QUADS quad, the rect covers the pixels whose centers lie within it, regardless of
+    // the order in which its corners were given.
+    Rect r(
+            min(rect.left, rect.right), min(rect.top, rect.bottom),
+            max(rect.left, rect.right), max(rect.top, rect.bottom));
+    r.clip_to(_screen_size.as_rect());
+    if (r.empty()) {
+        return;
+    }
+    for (int32_t y = r.top; y < r.bottom; ++y) {
+        draw_span(r.left, y, r.width(), &color, 0);
+    }
+}
+
+void SoftwareVideoDriver::draw_point(const Point& at, const RgbColor& color) {
+    if (_screen_size.as_rect().contains(at)) {
+        draw_span(at.h, at.v, 1, &color, 0);
+    }
+}
+
+void SoftwareVideoDriver::draw_line(const Point& from, const Point& to, const RgbColor& color) {
+    // Shortcut: when `from` == `to`, we can draw just a point.
+    if (from == to) {
+        draw_point(from, color);
+        return;
+    }
+
+    // Shortcut: horizontal and vertical lines are rects, as in OpenGlVideoDriver.
+    if ((from.h == to.h) || (from.v == to.v)) {
+        Rect rect(
+                min(from.h, to.h), min(from.v, to.v),
+                max(from.h, to.h) + 1, max(from.v, to.v) + 1);
+        fill_rect(rect, color);
+        return;
+    }
+
+    // Otherwise, rasterize the same segment as OpenGlVideoDriver: its end-points are moved to the
+    // far corners of the end pixels, and one pixel is drawn for each column (or row, if the line
+    // is steep) it spans, in the row (or column) which the segment passes through at the center
+    // of that column.  This is the diamond-exit rule, which GL_LINES follows, and since the moved
+    // end-points are whole numbers, no pixel center lies exactly on an end of the segment.
+    Point p1 = from;
+    Point p2 = to;
+    if (p1.h > p2.h) {
+        ++p1.h;
+    } else {
+        ++p2.h;
+    }
+    if (p1.v > p2.v) {
+        ++p1.v;
+    } else {
+        ++p2.v;
+    }
+    const bool steep = abs(p2.v - p1.v) > abs(p2.h - p1.h);
+    if (steep) {
+        std::swap(p1.h, p1.v);
+        std::swap(p2.h, p2.v);
+    }
+    if (p1.h > p2.h) {
+        std::swap(p1, p2);
+    }
+
+    // Along the segment, minor = p1.v + ((major - p1.h) * dv / dh).  At the center of major
+    // column `i`, twice that times dh is exact in integers.
+    const int64_t dh = p2.h - p1.h;
+    const int64_t dv = p2.v - p1.v;
+    const Rect bounds = _screen_size.as_rect();
+    for (int32_t i = p1.h; i < p2.h; ++i) {
+        const int64_t numerator = (2 * dh * p1.v) + (dv * ((2 * (i - p1.h)) + 1));
+        const int64_t denominator = 2 * dh;
+        int64_t minor = numerator / denominator;
+        if ((numerator % denominator) < 0) {
+            --minor;
+        }
+        const Point p = steep ? Point(minor, i) : Point(i, minor);
+        if (bounds.contains(p)) {
+            draw_span(p.h, p.v, 1, &color, 0);
+        }
+    }
+}
+
+void SoftwareVideoDriver::set_transition_fraction(double fraction) {
+    _transition_fraction = fraction;
+}
+
+void SoftwareVideoDriver::set_transition_to(const RgbColor& color) {
+    _transition_color = color;
+}
+
+void SoftwareVideoDriver::start_stencil() {
+    _stencil_writing = true;
+    _stencil_threshold = 0;
+    ++_stencil_height;
+}
+
+void SoftwareVideoDriver::set_stencil_threshold(uint8_t alpha) {
+    _stencil_threshold = alpha;
+}
+
+void SoftwareVideoDriver::apply_stencil() {
+    _stencil_writing = false;
+}
+
+void SoftwareVideoDriver::end_stencil() {
+    --_stencil_height;
+    _stencil_writing = false;
+
+    // Clamp the stencil buffer to [0, _stencil_height], as OpenGlVideoDriver::normalize_stencil()
+    // does.  Values below the height are unchanged, so only values above it need to be touched.
+    const uint8_t height = _stencil_height;
+    uint8_t* s = _stencil.get();
+    uint8_t* const end = s + (_screen_size.width * _screen_size.height);
+    for ( ; s != end; ++s) {
+        if (*s > height) {
+            *s = height;
+        }
+    }
+}
+
+void SoftwareVideoDriver::draw_span(
+        int32_t left, int32_t y, int32_t count, const RgbColor* colors, int step) {
+    const int32_t offset = (y * _screen_size.width) + left;
+    uint8_t* s = _stencil.get() + offset;
+    if (_stencil_writing) {
+        // Pixels which pass the alpha test and are not already above the stencil being drawn are
+        // incremented.  The alpha test is GL_GREATER against `_stencil_threshold / 256.0`.
+        const uint8_t below = _stencil_height;
+        const uint32_t threshold = _stencil_threshold * 0xff;
+        for (int32_t i = 0; i < count; ++i, ++s, colors += step) {
+            if (((colors->alpha * 0x100u) > threshold) && (*s < below)) {
+                ++*s;
+            }
+        }
+        return;
+    }
+
+    RgbColor* p = _pix.mutable_row(y) + left;
+    if (_stencil_height == 0) {
+        // Fast path: nothing is stenciled, so every stencil value is zero and passes.
+        for (int32_t i = 0; i < count; ++i, ++p, colors += step) {
+            blend(p, *colors);
+        }
+    } else {
+        const uint8_t height = _stencil_height;
+        for (int32_t i = 0; i < count; ++i, ++p, ++s, colors += step) {
+            if (*s == height) {
+                blend(p, *colors);
+            }
+        }
+    }
+}
+
+void SoftwareVideoDriver::clear() {
+    _pix.fill(RgbColor::kBlack);
+    memset(_stencil.get(), 0, _screen_size.width * _screen_size.height);
+}
+
+SoftwareVideoDriver::MainLoop::MainLoop(SoftwareVideoDriver& driver, Card* initial):
+        _driver(driver),
+        _stack(initial) { }
+
+bool SoftwareVideoDriver::MainLoop::done() {
+    return _stack.empty();
+}
+
+void SoftwareVideoDriver::MainLoop::draw() {
+    _driver.clear();
+    _stack.top()->draw();
+
+    // As with OpenGlVideoDriver, the alpha is converted to an integer by truncation.
+    const RgbColor& color = _driver._transition_color;
+    const RgbColor transition(
+            0xff * _driver._transition_fraction, color.red, color.green, color.blue);
+    if (transition.alpha != 0) {
+        _driver.fill_rect(_driver._screen_size.as_rect(), transition);
+    }
+}
+
+Card* SoftwareVideoDriver::MainLoop::top() const {
+    return _stack.top();
+}
+
+}  // namespace antares
@@ -0,0 +1,98 @@
+// Copyright (C) 1997, 1999-2001, 2008 Nathan Lamont
+// Copyright (C) 2008-2011 Ares Central
+//
+// This file is part of Antares, a tactical space combat game.
+//
+// Antares is free software: you can redistribute it and/or modify it
+// under the terms of the Lesser GNU General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Antares is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include "video/texture-atlas.hpp"
+
+using std::vector;
+
+namespace antares {
+
+namespace {
+
+const int32_t kGutter = 1;
+
+}  // namespace
+
+TextureAtlas::TextureAtlas(Size page_size)
+        : _page_size(page_size) { }
+
+bool TextureAtlas::place(Size size, bool persistent, Location* location) {
+    const int32_t width = size.width + kGutter;
+    const int32_t height = size.height + kGutter;
+    if (((width * 4) > _page_size.width) || ((height * 4) > _page_size.height)) {
+        return false;
+    }
+
+    // The shortest shelf which fits.
+    Page* best_page = NULL;
+    Shelf* best_shelf = NULL;
+    for (vector<Page>::iterator page = _pages.begin(); page != _pages.end(); ++page) {
+        if (page->persistent != persistent) {
+            continue;
+        }
+        for (vector<Shelf>::iterator shelf = page->shelves.begin();
+                shelf != page->shelves.end(); ++shelf) {
+            if ((shelf->height >= height)
+                    && ((shelf->right + width) <= _page_size.width)
+                    && ((best_shelf == NULL) || (shelf->height < best_shelf->height))) {
+                best_page = &*page;
+                best_shelf = &*shelf;
+            }
+        }
+    }
+
+    // Otherwise, a new shelf on the first page with room for one, or on a new page.
+    if (best_shelf == NULL) {
+        for (vector<Page>::iterator page = _pages.begin(); page != _pages.end(); ++page) {
+            if ((page->persistent == persistent) && ((page->bottom + height) <= _page_size.height)) {
+                best_page = &*page;
+                break;
+            }
+        }
+        if (best_page == NULL) {
+            _pages.push_back(Page(persistent));
+            best_page = &_pages.back();
+        }
+        Shelf shelf;
+        shelf.top = best_page->bottom;
+        shelf.height = height;
+        shelf.right = 0;
+        best_page->shelves.push_back(shelf);
+        best_page->bottom += height;
+        best_shelf = &best_page->shelves.back();
+    }
+
+    location->page = best_page - &_pages[0];
+    location->bounds = Rect(
+            best_shelf->right, best_shelf->top,
+            best_shelf->right + size.width, best_shelf->top + size.height);
+    best_shelf->right += width;
+    ++best_page->live;
+    return true;
+}
+
+void TextureAtlas::release(const Location& location) {
+    Page& page = _pages[location.page];
+    if (--page.live == 0) {
+        page.shelves.clear();
+        page.bottom = 0;
+    }
+}
+
+}  // namespace antares
@@ -2,9 +2,12 @@
 
 from __future__ import with_statement
 import contextlib
+import os
 import shutil
+import struct
 import subprocess
 import tempfile
+import zlib
 from waflib.Utils import to_list
 from waflib.Configure import conf
 
@@ -23,11 +26,21 @@ class AntaresTestCase(object):
     def __init__(self, bld, target, args, srcs, expected):
         self.target = target
         self.args = to_list(args)
-        self.srcs = [bld.path.find_resource(s) for s in to_list(srcs)]
+        self.srcs = [bld.path.find_resource(s) or bld.path.find_dir(s) for s in to_list(srcs)]
         self.binary = bld.path.find_or_declare(self.args[0])
-        self.expected = bld.path.find_dir(expected)
+        self.expected = expected and bld.path.make_node(expected)
 
     def execute(self, tst, log):
+        if not self.expected:
+            # Self-checking tests write nothing, and report failure through their exit status.
+            antares_command = (
+                    [self.binary.abspath()] + self.args[1:] + [s.abspath() for s in self.srcs])
+            tst.to_log(antares_command)
+            antares = subprocess.Popen(antares_command, stdout=log, stderr=log)
+            antares.communicate()
+            assert antares.returncode == 0, "Antares failed"
+            return
+
         with NamedTemporaryDir() as dir:
             antares_command = (
                     [self.binary.abspath()] + self.args[1:] +
@@ -37,15 +50,156 @@ class AntaresTestCase(object):
             antares.communicate()
             assert antares.returncode == 0, "Antares failed"
 
-            diff_command = ["diff", "-ru", self.expected.abspath(), dir]
-            tst.to_log(diff_command)
-            diff = subprocess.Popen(diff_command, stdout=log, stderr=log)
-            diff.communicate()
-            assert diff.returncode == 0, "diff failed"
+            if os.environ.get("ANTARES_UPDATE_EXPECTED"):
+                # Replace the expected output, rather than checking against it.
+                tst.to_log("updating %s" % self.expected.abspath())
+                shutil.rmtree(self.expected.abspath(), ignore_errors=True)
+                shutil.copytree(dir, self.expected.abspath())
+                return
+
+            differences = compare_dirs(self.expected.abspath(), dir)
+            for difference in differences:
+                tst.to_log(difference)
+            assert not differences, "output differs"
+
+
+def compare_dirs(expected, actual):
+    """Lists the differences between two directories of output.
+
+    PNG images are compared by their pixels rather than their bytes, so that images need not be
+    encoded the same way to match.  Any other file must match byte-for-byte.
+    """
+    expected_files = list_files(expected)
+    actual_files = list_files(actual)
+    differences = []
+    for path in sorted(expected_files - actual_files):
+        differences.append("missing: %s" % path)
+    for path in sorted(actual_files - expected_files):
+        differences.append("unexpected: %s" % path)
+    for path in sorted(expected_files & actual_files):
+        with open(os.path.join(expected, path), "rb") as f:
+            a = f.read()
+        with open(os.path.join(actual, path), "rb") as f:
+            b = f.read()
+        if a == b:
+            continue
+        if path.endswith(".png"):
+            try:
+                if png_pixels(a) == png_pixels(b):
+                    continue
+            except ValueError as e:
+                differences.append("unreadable: %s (%s)" % (path, e))
+                continue
+        differences.append("differs: %s" % path)
+    return differences
+
+
+def list_files(root):
+    files = set()
+    for dirpath, dirnames, filenames in os.walk(root):
+        for name in filenames:
+            files.add(os.path.relpath(os.path.join(dirpath, name), root))
+    return files
+
+
+PNG_SIGNATURE = b"\x89PNG\r\n\x1a\n"
+
+
+def png_pixels(data):
+    """Decodes a non-interlaced, 8-bit PNG image.
+
+    Returns its size, and its pixels as RGBA.  Raises ValueError for anything else.
+    """
+    if not data.startswith(PNG_SIGNATURE):
+        raise ValueError("not a PNG image")
+    pos = len(PNG_SIGNATURE)
+    header = None
+    palette = b""
+    transparency = b""
+    idat = []
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            header = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = body
+        elif kind == b"tRNS":
+            transparency = body
+        elif kind == b"IDAT":
+            idat.append(body)
+        elif kind == b"IEND":
+            break
+    if header is None:
+        raise ValueError("no IHDR chunk")
+    width, height, depth, color_type, compression, filter_method, interlace = header
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(color_type)
+    if (depth != 8) or (channels is None) or interlace:
+        raise ValueError("unsupported format")
+
+    raw = bytearray(zlib.decompress(b"".join(idat)))
+    stride = width * channels
+    if len(raw) != (height * (stride + 1)):
+        raise ValueError("truncated image data")
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        row = unfilter(raw[start], raw[start + 1:start + 1 + stride], previous, channels)
+        rows.append(row)
+        previous = row
+
+    pixels = bytearray()
+    for row in rows:
+        for x in range(0, stride, channels):
+            if color_type == 0:
+                pixels.extend((row[x], row[x], row[x], 255))
+            elif color_type == 2:
+                pixels.extend((row[x], row[x + 1], row[x + 2], 255))
+            elif color_type == 3:
+                i = row[x]
+                alpha = bytearray(transparency)[i] if i < len(transparency) else 255
+                pixels.extend(bytearray(palette[i * 3:i * 3 + 3]))
+                pixels.append(alpha)
+            elif color_type == 4:
+                pixels.extend((row[x], row[x], row[x], row[x + 1]))
+            else:
+                pixels.extend(row[x:x + 4])
+    return (width, height, bytes(pixels))
+
+
+def unfilter(kind, row, previous, bpp):
+    out = bytearray(row)
+    for i in range(len(out)):
+        left = out[i - bpp] if i >= bpp else 0
+        up = previous[i]
+        upper_left = previous[i - bpp] if i >= bpp else 0
+        if kind == 0:
+            continue
+        elif kind == 1:
+            predictor = left
+        elif kind == 2:
+            predictor = up
+        elif kind == 3:
+            predictor = (left + up) // 2
+        elif kind == 4:
+            p = left + up - upper_left
+            pa, pb, pc = abs(p - left), abs(p - up), abs(p - upper_left)
+            if (pa <= pb) and (pa <= pc):
+                predictor = left
+            elif pb <= pc:
+                predictor = up
+            else:
+                predictor = upper_left
+        else:
+            raise ValueError("bad filter type %d" % kind)
+        out[i] = (out[i] + predictor) & 0xff
+    return out
 
 
 @conf
-def antares_test(bld, target, rule, expected, srcs=[]):
+def antares_test(bld, target, rule, expected=None, srcs=[]):
     if hasattr(bld, "test_cases"):
         bld.test_cases[target] = AntaresTestCase(bld, target, rule, srcs, expected)
 